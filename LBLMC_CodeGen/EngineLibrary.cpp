@@ -0,0 +1,93 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "EngineLibrary.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <dlfcn.h>
+
+namespace lblmc
+{
+
+EngineLibrary::EngineLibrary(std::string path) :
+	handle(nullptr), path(path)
+{
+	if(path.empty())
+		throw std::invalid_argument("EngineLibrary::constructor(): path cannot be empty or null");
+
+	handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+	if(handle == nullptr)
+	{
+		const char* error = dlerror();
+		throw std::runtime_error("EngineLibrary::constructor(): failed to load " + path + ": " + (error ? error : "unknown error"));
+	}
+}
+
+EngineLibrary::EngineLibrary(EngineLibrary&& base) :
+	handle(base.handle), path(std::move(base.path))
+{
+	base.handle = nullptr;
+}
+
+EngineLibrary& EngineLibrary::operator=(EngineLibrary&& rhs)
+{
+	if(this == &rhs) return *this;
+
+	if(handle != nullptr) dlclose(handle);
+
+	handle = rhs.handle;
+	path = std::move(rhs.path);
+	rhs.handle = nullptr;
+
+	return *this;
+}
+
+EngineLibrary::~EngineLibrary()
+{
+	if(handle != nullptr) dlclose(handle);
+}
+
+void* EngineLibrary::getSymbol(const std::string& name) const
+{
+	if(handle == nullptr)
+		throw std::runtime_error("EngineLibrary::getSymbol(): library has been moved from");
+
+	dlerror();
+	void* symbol = dlsym(handle, name.c_str());
+
+	if(symbol == nullptr)
+		throw std::runtime_error("EngineLibrary::getSymbol(): " + path + " does not export " + name);
+
+	return symbol;
+}
+
+bool EngineLibrary::hasFunction(const std::string& name) const
+{
+	if(handle == nullptr) return false;
+
+	return dlsym(handle, (name + "_symbol").c_str()) != nullptr;
+}
+
+} //namespace lblmc
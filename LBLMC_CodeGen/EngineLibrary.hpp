@@ -0,0 +1,125 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef ENGINELIBRARY_HPP
+#define ENGINELIBRARY_HPP
+
+#include <string>
+
+namespace lblmc
+{
+
+/**
+	\brief handle to a compiled simulation engine loaded as a shared library into the running process
+
+	Engine libraries are built and loaded by SimulationEngineGenerator::compileAndLoad().  Each
+	generated function <name> of the engine is exported from the library through a C linkage
+	pointer <name>_symbol, so the functions are found by name regardless of C++ name mangling and
+	are called through getFunction() with the signature of the function in the engine header:
+
+	<pre>
+	#include "model.hpp" // header exported by generateCFunctionAndExport(); gives real and structs
+
+	lblmc::EngineLibrary engine = model.compileAndLoad();
+	auto step = engine.getFunction<void(real*, real, bool)>("model_simulationEngine");
+	step(x_out, v_in, sw_ctrl);
+	</pre>
+
+	The library is unloaded when its last handle is destroyed; functions taken from it must not be
+	called afterwards.  Loading the same library more than once gives handles to one shared copy
+	of it, so non-reentrant engines loaded from the same build share their static state.
+
+	This class is movable but not copyable.
+
+	\note This class is NOT intended for RTL Synthesis.
+**/
+class EngineLibrary
+{
+
+private:
+
+	void* handle;      ///< handle of the loaded library from dlopen()
+	std::string path;  ///< path of the loaded library file
+
+public:
+
+	EngineLibrary() = delete;
+
+	/**
+		\brief parameter constructor; loads the shared library at the given path
+		\param path path of the shared library file to load
+		\throw std::runtime_error if the library cannot be loaded
+	**/
+	explicit EngineLibrary(std::string path);
+
+	EngineLibrary(const EngineLibrary& base) = delete;
+	EngineLibrary& operator=(const EngineLibrary& rhs) = delete;
+
+	EngineLibrary(EngineLibrary&& base);
+	EngineLibrary& operator=(EngineLibrary&& rhs);
+
+	/**
+		\brief destructor; unloads the library
+	**/
+	~EngineLibrary();
+
+	/**
+		\return path of the loaded library file
+	**/
+	inline const std::string& getPath() const { return path; }
+
+	/**
+		\brief gets the address of a symbol exported by the library
+		\param name name of the symbol
+		\return address of the symbol
+		\throw std::runtime_error if the library does not export the symbol
+	**/
+	void* getSymbol(const std::string& name) const;
+
+	/**
+		\brief checks if the library exports a generated function
+		\param name name of the generated function, such as <model>_simulationEngine
+		\return true if the function is exported; false otherwise
+	**/
+	bool hasFunction(const std::string& name) const;
+
+	/**
+		\brief gets a generated function of the engine as a typed function pointer
+
+		The signature F must match the declaration of the function in the engine header; it is not
+		checked.
+
+		\param name name of the generated function, such as <model>_simulationEngine
+		\return pointer to the function
+		\throw std::runtime_error if the library does not export the function
+	**/
+	template<typename F>
+	F* getFunction(const std::string& name) const
+	{
+		return *static_cast<F**>(getSymbol(name + "_symbol"));
+	}
+
+};
+
+} //namespace lblmc
+
+#endif // ENGINELIBRARY_HPP
@@ -0,0 +1,301 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "FixedPointCode.hpp"
+
+namespace lblmc
+{
+
+const std::string& getFixedPointTypeCode()
+{
+	const static std::string code = R"LBLMC(#ifndef LBLMC_FIXED_HPP
+#define LBLMC_FIXED_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+// largest number of fraction bits kept by intermediate results; operands of deeper products are
+// truncated to fit.  Results with I integer bits are exact for limits up to 128-I
+#ifndef LBLMC_FIXED_FRACTION_LIMIT
+#define LBLMC_FIXED_FRACTION_LIMIT 96
+#endif
+
+typedef __int128 lblmc_fixed_int;
+typedef unsigned __int128 lblmc_fixed_uint;
+
+/**
+	exact intermediate result of fixed point arithmetic with F fraction bits, kept modulo 2^128
+	like the full precision intermediate types of ap_fixed
+**/
+template<int F>
+struct lblmc_fixed_expr
+{
+	lblmc_fixed_uint value;
+
+	explicit lblmc_fixed_expr(lblmc_fixed_uint value) : value(value) {}
+
+	inline double to_double() const { return std::ldexp((double)(lblmc_fixed_int)value, -F); }
+
+	inline explicit operator double() const { return to_double(); }
+};
+
+/// \return v scaled from FROM to TO fraction bits, flooring when bits are removed
+template<int FROM, int TO>
+inline lblmc_fixed_uint lblmc_fixed_align(lblmc_fixed_uint v)
+{
+	return (TO >= FROM) ? (v << (TO >= FROM ? TO-FROM : 0)) : (lblmc_fixed_uint)((lblmc_fixed_int)v >> (TO >= FROM ? 0 : FROM-TO));
+}
+
+/**
+	fixed point number of W bits with I integer bits matching ap_fixed<W, I, AP_RND, AP_WRAP>, or
+	AP_SAT if SAT is set; results are rounded to plus infinity at half an LSB when assigned
+**/
+template<int W, int I, bool SAT = false>
+class lblmc_fixed
+{
+	static_assert(W > 0 && W <= 64 && I <= W, "lblmc_fixed supports words of up to 64 bits");
+
+public:
+
+	static const int F = W - I;
+
+	std::int64_t raw;
+
+	lblmc_fixed() : raw(0) {}
+
+	lblmc_fixed(double value) : raw(fromDouble(value)) {}
+
+	template<typename T>
+	lblmc_fixed(T value, typename std::enable_if<std::is_integral<T>::value>::type* = 0) :
+		raw(quantize<0>((lblmc_fixed_uint)(lblmc_fixed_int)value)) {}
+
+	template<int F2>
+	lblmc_fixed(const lblmc_fixed_expr<F2>& expr) : raw(quantize<F2>(expr.value)) {}
+
+	template<int W2, int I2, bool SAT2>
+	lblmc_fixed(const lblmc_fixed<W2, I2, SAT2>& other) : raw(quantize<W2-I2>((lblmc_fixed_uint)(lblmc_fixed_int)other.raw)) {}
+
+	inline double to_double() const { return std::ldexp((double)raw, -F); }
+
+	inline explicit operator double() const { return to_double(); }
+
+	inline explicit operator float() const { return (float)to_double(); }
+
+	template<typename T>
+	inline lblmc_fixed& operator+=(const T& rhs) { return *this = *this + rhs; }
+
+	template<typename T>
+	inline lblmc_fixed& operator-=(const T& rhs) { return *this = *this - rhs; }
+
+	template<typename T>
+	inline lblmc_fixed& operator*=(const T& rhs) { return *this = *this * rhs; }
+
+	template<typename T>
+	inline lblmc_fixed& operator/=(const T& rhs) { return *this = *this / rhs; }
+
+	inline lblmc_fixed operator<<(int shift) const { return fromRaw(wrap((lblmc_fixed_uint)(lblmc_fixed_int)raw << shift)); }
+
+	inline lblmc_fixed operator>>(int shift) const { return fromRaw(raw >> shift); }
+
+	inline lblmc_fixed& operator<<=(int shift) { return *this = *this << shift; }
+
+	inline lblmc_fixed& operator>>=(int shift) { return *this = *this >> shift; }
+
+	static inline lblmc_fixed fromRaw(std::int64_t raw)
+	{
+		lblmc_fixed x;
+		x.raw = raw;
+		return x;
+	}
+
+private:
+
+	/// \return value v with F2 fraction bits rounded (AP_RND) to F fraction bits and fit to W bits
+	template<int F2>
+	static inline std::int64_t quantize(lblmc_fixed_uint v)
+	{
+		if(F2 > F) v += (lblmc_fixed_uint)1 << (F2 > F ? F2-F-1 : 0);
+		return SAT ? saturate(lblmc_fixed_align<F2, F>(v)) : wrap(lblmc_fixed_align<F2, F>(v));
+	}
+
+	static inline std::int64_t wrap(lblmc_fixed_uint v)
+	{
+		const std::uint64_t mask = (W == 64) ? ~(std::uint64_t)0 : (((std::uint64_t)1 << (W % 64)) - 1);
+		std::uint64_t bits = (std::uint64_t)v & mask;
+		if((bits >> (W-1)) & 1) bits |= ~mask;
+		return (std::int64_t)bits;
+	}
+
+	static inline std::int64_t saturate(lblmc_fixed_uint v)
+	{
+		const lblmc_fixed_int max = ((lblmc_fixed_int)1 << (W-1)) - 1;
+		const lblmc_fixed_int min = -max - 1;
+		const lblmc_fixed_int s = (lblmc_fixed_int)v;
+		return (std::int64_t)((s > max) ? max : (s < min) ? min : s);
+	}
+
+	static inline std::int64_t fromDouble(double value)
+	{
+		if(!std::isfinite(value)) return 0;
+
+		const double scaled = std::ldexp(value, F);
+		const double floor = std::floor(scaled);
+		double rounded = (scaled - floor >= 0.5) ? floor + 1.0 : floor;
+
+		// beyond 2^127 only the wrapped low bits, which are zero, or the saturated limit matter
+		const double limit = std::ldexp(1.0, 126);
+		if(rounded >= limit) return SAT ? saturate((lblmc_fixed_uint)((lblmc_fixed_int)1 << 126)) : 0;
+		if(rounded <= -limit) return SAT ? saturate((lblmc_fixed_uint)(-((lblmc_fixed_int)1 << 126))) : 0;
+
+		return SAT ? saturate((lblmc_fixed_uint)(lblmc_fixed_int)rounded) : wrap((lblmc_fixed_uint)(lblmc_fixed_int)rounded);
+	}
+};
+
+template<typename T>
+struct lblmc_fixed_traits
+{
+	static const bool fixed = false;
+	static const int F = 0;
+};
+
+template<int F_>
+struct lblmc_fixed_traits< lblmc_fixed_expr<F_> >
+{
+	static const bool fixed = true;
+	static const int F = F_;
+	static inline lblmc_fixed_uint value(const lblmc_fixed_expr<F_>& x) { return x.value; }
+};
+
+template<int W, int I, bool SAT>
+struct lblmc_fixed_traits< lblmc_fixed<W, I, SAT> >
+{
+	static const bool fixed = true;
+	static const int F = W - I;
+	static inline lblmc_fixed_uint value(const lblmc_fixed<W, I, SAT>& x) { return (lblmc_fixed_uint)(lblmc_fixed_int)x.raw; }
+};
+
+template<typename A, typename B, typename R>
+struct lblmc_fixed_enable : std::enable_if<lblmc_fixed_traits<A>::fixed && lblmc_fixed_traits<B>::fixed, R> {};
+
+template<typename A, typename B>
+struct lblmc_fixed_sum
+{
+	static const int FA = lblmc_fixed_traits<A>::F;
+	static const int FB = lblmc_fixed_traits<B>::F;
+	static const int F = (FA > FB) ? FA : FB;
+};
+
+template<typename A, typename B>
+struct lblmc_fixed_product
+{
+	static const int FA = lblmc_fixed_traits<A>::F;
+	static const int FB = lblmc_fixed_traits<B>::F;
+	static const int EXCESS = (FA+FB > LBLMC_FIXED_FRACTION_LIMIT) ? FA+FB-LBLMC_FIXED_FRACTION_LIMIT : 0;
+	static const int CUT_A = (FA >= FB) ? ((EXCESS < FA) ? EXCESS : FA) : 0;
+	static const int CUT_B = EXCESS - CUT_A;
+	static const int F = FA + FB - EXCESS;
+};
+
+template<typename A, typename B>
+inline typename lblmc_fixed_enable<A, B, lblmc_fixed_expr<lblmc_fixed_sum<A, B>::F> >::type operator+(const A& a, const B& b)
+{
+	typedef lblmc_fixed_sum<A, B> S;
+	return lblmc_fixed_expr<S::F>(lblmc_fixed_align<S::FA, S::F>(lblmc_fixed_traits<A>::value(a)) + lblmc_fixed_align<S::FB, S::F>(lblmc_fixed_traits<B>::value(b)));
+}
+
+template<typename A, typename B>
+inline typename lblmc_fixed_enable<A, B, lblmc_fixed_expr<lblmc_fixed_sum<A, B>::F> >::type operator-(const A& a, const B& b)
+{
+	typedef lblmc_fixed_sum<A, B> S;
+	return lblmc_fixed_expr<S::F>(lblmc_fixed_align<S::FA, S::F>(lblmc_fixed_traits<A>::value(a)) - lblmc_fixed_align<S::FB, S::F>(lblmc_fixed_traits<B>::value(b)));
+}
+
+template<typename A, typename B>
+inline typename lblmc_fixed_enable<A, B, lblmc_fixed_expr<lblmc_fixed_product<A, B>::F> >::type operator*(const A& a, const B& b)
+{
+	typedef lblmc_fixed_product<A, B> P;
+	return lblmc_fixed_expr<P::F>
+	(
+		lblmc_fixed_align<P::FA, P::FA-P::CUT_A>(lblmc_fixed_traits<A>::value(a)) *
+		lblmc_fixed_align<P::FB, P::FB-P::CUT_B>(lblmc_fixed_traits<B>::value(b))
+	);
+}
+
+// quotient keeps the fraction bits of the dividend and is truncated toward zero, like ap_fixed
+template<typename A, typename B>
+inline typename lblmc_fixed_enable<A, B, lblmc_fixed_expr<lblmc_fixed_traits<A>::F> >::type operator/(const A& a, const B& b)
+{
+	const lblmc_fixed_int divisor = (lblmc_fixed_int)lblmc_fixed_traits<B>::value(b);
+	const lblmc_fixed_int dividend = (lblmc_fixed_int)(lblmc_fixed_traits<A>::value(a) << lblmc_fixed_traits<B>::F);
+	return lblmc_fixed_expr<lblmc_fixed_traits<A>::F>((lblmc_fixed_uint)((divisor == 0) ? 0 : dividend/divisor));
+}
+
+template<typename A>
+inline typename lblmc_fixed_enable<A, A, lblmc_fixed_expr<lblmc_fixed_traits<A>::F> >::type operator-(const A& a)
+{
+	return lblmc_fixed_expr<lblmc_fixed_traits<A>::F>(-lblmc_fixed_traits<A>::value(a));
+}
+
+template<typename A>
+inline typename lblmc_fixed_enable<A, A, const A&>::type operator+(const A& a)
+{
+	return a;
+}
+
+// shifts keep the fraction bits of the intermediate result, like those of ap_fixed; right shifts floor
+template<int F>
+inline lblmc_fixed_expr<F> operator<<(const lblmc_fixed_expr<F>& a, int shift)
+{
+	return lblmc_fixed_expr<F>(a.value << shift);
+}
+
+template<int F>
+inline lblmc_fixed_expr<F> operator>>(const lblmc_fixed_expr<F>& a, int shift)
+{
+	return lblmc_fixed_expr<F>((lblmc_fixed_uint)((lblmc_fixed_int)a.value >> shift));
+}
+
+#define LBLMC_FIXED_COMPARISON(OP) \
+template<typename A, typename B> \
+inline typename lblmc_fixed_enable<A, B, bool>::type operator OP(const A& a, const B& b) \
+{ \
+	typedef lblmc_fixed_sum<A, B> S; \
+	return (lblmc_fixed_int)lblmc_fixed_align<S::FA, S::F>(lblmc_fixed_traits<A>::value(a)) OP \
+	       (lblmc_fixed_int)lblmc_fixed_align<S::FB, S::F>(lblmc_fixed_traits<B>::value(b)); \
+}
+
+LBLMC_FIXED_COMPARISON(==)
+LBLMC_FIXED_COMPARISON(!=)
+LBLMC_FIXED_COMPARISON(<)
+LBLMC_FIXED_COMPARISON(<=)
+LBLMC_FIXED_COMPARISON(>)
+LBLMC_FIXED_COMPARISON(>=)
+
+#undef LBLMC_FIXED_COMPARISON
+
+#endif
+)LBLMC";
+
+	return code;
+}
+
+} //namespace lblmc
@@ -0,0 +1,54 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FIXEDPOINTCODE_HPP
+#define FIXEDPOINTCODE_HPP
+
+#include <string>
+
+namespace lblmc
+{
+
+/**
+	\brief gets the C++ source code of lblmc_fixed<W, I, SAT>, the header-only fixed point type of
+	engines generated with fixed point enabled but without Xilinx HLS
+
+	lblmc_fixed<W, I> is a signed word of W <= 64 bits with I integer bits that follows the
+	semantics of ap_fixed<W, I, AP_RND>, or ap_fixed<W, I, AP_RND, AP_SAT> with SAT set.
+	Arithmetic between fixed point values yields exact intermediate results, as the full precision
+	intermediate types of ap_fixed do, held in 128-bit integers modulo 2^128.  Intermediate
+	results are rounded to plus infinity at half an LSB (AP_RND) and wrapped (AP_WRAP) or
+	saturated (AP_SAT) to W bits only when assigned to a fixed point variable.  Conversion from
+	double rounds the same way; quotients keep the fraction bits of the dividend and are
+	truncated toward zero.
+
+	Intermediate results keep at most LBLMC_FIXED_FRACTION_LIMIT fraction bits, 128-I for the
+	generated engines, which keeps the wrapped results bit exact; operands of deeper products are
+	truncated to the limit.  Saturated results are exact while the intermediate results fit in
+	128 bits.  Operands must be fixed point values, so literals are written as real(value).
+
+	\return C++ source code of the lblmc_fixed type, guarded by LBLMC_FIXED_HPP
+**/
+const std::string& getFixedPointTypeCode();
+
+} //namespace lblmc
+
+#endif // FIXEDPOINTCODE_HPP
@@ -0,0 +1,668 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+#include "HLSEstimator.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+
+namespace lblmc
+{
+
+void HLSEstimate::writeReport(std::ostream& strm) const
+{
+	strm << "HLS estimate at clock period " << clock_period << " s\n";
+
+	strm << "latency: " << latency << " cycles (" << latency*clock_period << " s)";
+	if(latency_max != 0)
+		strm << "; max " << latency_max << " cycles, " << (latency_met ? "met" : "NOT met");
+	strm << "\n";
+
+	strm << "resources: " << dsp << " DSP, " << lut << " LUT, " << bram << " BRAM18\n";
+
+	strm << "operators: " << adders << " adders, " << multipliers << " multipliers, " << dividers << " dividers, "
+	     << comparators << " comparators, " << selects << " multiplexers\n";
+}
+
+static const char* TYPE_WORDS[] =
+{
+	"real", "bool", "double", "float", "int", "unsigned", "signed", "long", "short", "char",
+	"auto", "const", "static", "volatile", "constexpr"
+};
+
+static bool isTypeWord(const std::string& word)
+{
+	for(const char* type : TYPE_WORDS)
+	{
+		if(word == type) return true;
+	}
+
+	return false;
+}
+
+HLSScheduler::HLSScheduler(double clock_period, bool fixed_point, const HLSEstimatorParameters& costs, unsigned int multiplier_limit) :
+	clock_period(clock_period), fixed_point(fixed_point), costs(costs), multiplier_limit(multiplier_limit),
+	constants(), ready(), mul_issues(), finish(0.0), branch_depth(0), counts(), tokens(), pos(0)
+{
+	if(!(clock_period > 0.0))
+		throw std::invalid_argument("HLSScheduler::constructor(): clock_period must be positive nonzero value");
+}
+
+void HLSScheduler::addConstants(const std::vector<std::string>& names)
+{
+	constants.insert(names.begin(), names.end());
+}
+
+const HLSOperatorCost& HLSScheduler::cost(Operator op) const
+{
+	switch(op)
+	{
+		case ADD: return fixed_point ? costs.fixed_add : costs.float_add;
+		case MUL: return fixed_point ? costs.fixed_mul : costs.float_mul;
+		case DIV: return fixed_point ? costs.fixed_div : costs.float_div;
+		case CMP: return fixed_point ? costs.fixed_cmp : costs.float_cmp;
+		case SELECT: return costs.select;
+		default: return costs.logic;
+	}
+}
+
+double HLSScheduler::scheduleOperation(Operator op, double start, bool instance)
+{
+	const HLSOperatorCost& op_cost = cost(op);
+	const double tolerance = 1.0e-6;
+
+	double begin = start;
+	double cycle = std::floor(begin/clock_period + tolerance);
+
+	if(op_cost.delay <= clock_period)
+	{
+		// chain in the cycle the operands are ready in, or start in the next cycle
+		if(begin + op_cost.delay > (cycle+1.0)*clock_period*(1.0+tolerance))
+		{
+			cycle += 1.0;
+			begin = cycle*clock_period;
+		}
+	}
+	else
+	{
+		cycle = std::ceil(begin/clock_period - tolerance);
+		begin = cycle*clock_period;
+	}
+
+	if(op == MUL && multiplier_limit != 0)
+	{
+		while(mul_issues[static_cast<long>(cycle)] >= multiplier_limit)
+		{
+			cycle += 1.0;
+			begin = cycle*clock_period;
+		}
+
+		mul_issues[static_cast<long>(cycle)]++;
+	}
+
+	double end;
+	if(op_cost.delay <= clock_period)
+		end = begin + op_cost.delay;
+	else
+		end = begin + std::ceil(op_cost.delay/clock_period - tolerance)*clock_period;
+
+	if(instance) counts[op]++;
+	finish = std::max(finish, end);
+
+	return end;
+}
+
+double HLSScheduler::getReadyTime(const std::string& name) const
+{
+	auto iter = ready.find(name);
+	return iter == ready.end() ? 0.0 : std::max(0.0, iter->second);
+}
+
+void HLSScheduler::setReadyTime(const std::string& name, double time)
+{
+	ready[name] = time;
+	finish = std::max(finish, time);
+}
+
+unsigned int HLSScheduler::getLatency() const
+{
+	return static_cast<unsigned int>(std::ceil(finish/clock_period - 1.0e-6));
+}
+
+void HLSScheduler::fillEstimate(HLSEstimate& estimate) const
+{
+	estimate.clock_period = clock_period;
+	estimate.latency = getLatency();
+
+	estimate.adders = counts[ADD];
+	estimate.multipliers = multiplier_limit != 0 ? std::min(counts[MUL], multiplier_limit) : counts[MUL];
+	estimate.dividers = counts[DIV];
+	estimate.comparators = counts[CMP];
+	estimate.selects = counts[SELECT];
+
+	estimate.dsp =
+		estimate.adders*cost(ADD).dsp + estimate.multipliers*cost(MUL).dsp + estimate.dividers*cost(DIV).dsp +
+		estimate.comparators*cost(CMP).dsp + estimate.selects*cost(SELECT).dsp + counts[LOGIC]*cost(LOGIC).dsp;
+
+	estimate.lut =
+		estimate.adders*cost(ADD).lut + estimate.multipliers*cost(MUL).lut + estimate.dividers*cost(DIV).lut +
+		estimate.comparators*cost(CMP).lut + estimate.selects*cost(SELECT).lut + counts[LOGIC]*cost(LOGIC).lut;
+}
+
+void HLSScheduler::scheduleCode(const std::string& code)
+{
+	tokenize(code);
+
+	while(pos < tokens.size())
+	{
+		parseStatement(0.0);
+	}
+
+	tokens.clear();
+	pos = 0;
+}
+
+void HLSScheduler::tokenize(const std::string& code)
+{
+	const static char* OPERATORS[] =
+	{
+		"<<=", ">>=", "==", "!=", "<=", ">=", "&&", "||", "<<", ">>", "+=", "-=", "*=", "/=", "%=",
+		"&=", "|=", "^=", "++", "--", "->", "::"
+	};
+
+	tokens.clear();
+	pos = 0;
+
+	std::size_t i = 0;
+	bool line_start = true;
+
+	while(i < code.size())
+	{
+		char c = code[i];
+
+		if(c == '\n') { line_start = true; i++; continue; }
+		if(std::isspace(static_cast<unsigned char>(c))) { i++; continue; }
+
+		// preprocessor directives, such as HLS pragmas, are not scheduled
+		if(c == '#' && line_start)
+		{
+			i = code.find('\n', i);
+			if(i == std::string::npos) i = code.size();
+			continue;
+		}
+
+		line_start = false;
+
+		if(code.compare(i, 2, "//") == 0)
+		{
+			i = code.find('\n', i);
+			if(i == std::string::npos) i = code.size();
+			continue;
+		}
+
+		if(code.compare(i, 2, "/*") == 0)
+		{
+			i = code.find("*/", i+2);
+			i = i == std::string::npos ? code.size() : i+2;
+			continue;
+		}
+
+		std::size_t begin = i;
+
+		if(std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+		{
+			while(i < code.size() && (std::isalnum(static_cast<unsigned char>(code[i])) || code[i] == '_')) i++;
+			tokens.push_back(Token{'i', code.substr(begin, i-begin)});
+			continue;
+		}
+
+		if(std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && i+1 < code.size() && std::isdigit(static_cast<unsigned char>(code[i+1]))))
+		{
+			while(i < code.size())
+			{
+				char d = code[i];
+
+				if(std::isalnum(static_cast<unsigned char>(d)) || d == '.' || d == '_')
+					i++;
+				else if((d == '+' || d == '-') && (code[i-1] == 'e' || code[i-1] == 'E'))
+					i++;
+				else
+					break;
+			}
+
+			tokens.push_back(Token{'n', code.substr(begin, i-begin)});
+			continue;
+		}
+
+		std::string op(1, c);
+		for(const char* candidate : OPERATORS)
+		{
+			if(code.compare(i, std::char_traits<char>::length(candidate), candidate) == 0)
+			{
+				op = candidate;
+				break;
+			}
+		}
+
+		i += op.size();
+		tokens.push_back(Token{'o', op});
+	}
+}
+
+bool HLSScheduler::peek(const char* text) const
+{
+	return pos < tokens.size() && tokens[pos].text == text;
+}
+
+bool HLSScheduler::accept(const char* text)
+{
+	if(!peek(text)) return false;
+
+	pos++;
+	return true;
+}
+
+void HLSScheduler::expect(const char* text)
+{
+	if(!accept(text))
+	{
+		throw std::runtime_error(std::string("HLSScheduler::scheduleCode(): expected ") + text + " but found " +
+		                         (pos < tokens.size() ? tokens[pos].text : std::string("end of code")));
+	}
+}
+
+void HLSScheduler::skipPast(const char* text)
+{
+	int depth = 0;
+
+	while(pos < tokens.size())
+	{
+		const std::string& token = tokens[pos++].text;
+
+		if(depth == 0 && token == text) return;
+
+		if(token == "(" || token == "[" || token == "{") depth++;
+		else if(token == ")" || token == "]" || token == "}") depth--;
+	}
+}
+
+void HLSScheduler::parseStatement(double condition)
+{
+	if(accept(";")) return;
+
+	if(accept("{"))
+	{
+		while(!accept("}"))
+		{
+			if(pos >= tokens.size())
+				throw std::runtime_error("HLSScheduler::scheduleCode(): unterminated block");
+
+			parseStatement(condition);
+		}
+		return;
+	}
+
+	if(accept("if"))
+	{
+		expect("(");
+		Value test = parseExpression();
+		expect(")");
+
+		double branch_condition = std::max(condition, test.time);
+
+		branch_depth++;
+		parseStatement(branch_condition);
+		if(accept("else")) parseStatement(branch_condition);
+		branch_depth--;
+		return;
+	}
+
+	if(accept("for") || accept("while"))
+	{
+		expect("(");
+		skipPast(")");
+		parseStatement(condition);
+		return;
+	}
+
+	if(accept("return") || accept("break") || accept("continue"))
+	{
+		skipPast(";");
+		return;
+	}
+
+	if(pos < tokens.size() && isTypeWord(tokens[pos].text))
+	{
+		parseDeclaration(condition);
+		return;
+	}
+
+	std::string target = parseLValue();
+
+	if(target.empty())
+	{
+		skipPast(";");
+		return;
+	}
+
+	const static char* COMPOUND[][2] = { {"+=", "+"}, {"-=", "-"}, {"*=", "*"}, {"/=", "/"} };
+
+	if(accept("="))
+	{
+		assign(target, parseExpression(), condition);
+	}
+	else if(accept("++") || accept("--"))
+	{
+		assign(target, apply(ADD, lookup(target), Value{0.0, true}), condition);
+	}
+	else
+	{
+		bool compound = false;
+
+		for(const auto& op : COMPOUND)
+		{
+			if(!accept(op[0])) continue;
+
+			Operator kind = op[1][0] == '*' ? MUL : (op[1][0] == '/' ? DIV : ADD);
+			Value rhs = parseExpression();
+			assign(target, apply(kind, lookup(target), rhs), condition);
+			compound = true;
+			break;
+		}
+
+		// calls and other expression statements assign nothing that is scheduled
+		if(!compound)
+		{
+			skipPast(";");
+			return;
+		}
+	}
+
+	expect(";");
+}
+
+void HLSScheduler::parseDeclaration(double condition)
+{
+	while(pos < tokens.size() && isTypeWord(tokens[pos].text)) pos++;
+
+	while(pos < tokens.size())
+	{
+		while(accept("*") || accept("&")) {}
+
+		if(pos >= tokens.size() || tokens[pos].kind != 'i')
+		{
+			// declarations such as references to arrays are not scheduled
+			skipPast(";");
+			return;
+		}
+
+		std::string name = tokens[pos++].text;
+
+		while(accept("["))
+		{
+			skipPast("]");
+		}
+
+		if(accept("=")) assign(name, parseExpression(), condition);
+
+		if(accept(";")) return;
+		expect(",");
+	}
+}
+
+void HLSScheduler::assign(const std::string& target, Value value, double condition)
+{
+	// assignments under a condition select between the new and old values
+	if(branch_depth != 0)
+	{
+		value.time = scheduleOperation(SELECT, std::max(value.time, condition));
+		value.constant = false;
+	}
+
+	ready[target] = value.constant ? -1.0 : value.time;
+}
+
+HLSScheduler::Value HLSScheduler::lookup(const std::string& name) const
+{
+	std::string base = name.substr(0, name.find('['));
+
+	if(constants.count(name) != 0 || constants.count(base) != 0) return Value{0.0, true};
+
+	auto iter = ready.find(name);
+
+	// whole arrays are ready when their last element is
+	if(iter == ready.end() && base == name)
+	{
+		double time = 0.0;
+		for(auto element = ready.lower_bound(base + "["); element != ready.end() && element->first.compare(0, base.size()+1, base + "[") == 0; element++)
+			time = std::max(time, element->second);
+
+		return Value{time, false};
+	}
+
+	if(iter == ready.end()) return Value{0.0, false};
+
+	// constants assigned in this time step are marked by a negative time
+	if(iter->second < 0.0) return Value{0.0, true};
+
+	return Value{iter->second, false};
+}
+
+std::string HLSScheduler::parseLValue()
+{
+	while(accept("*")) {}
+
+	if(pos >= tokens.size() || tokens[pos].kind != 'i') return std::string();
+
+	std::string name = tokens[pos++].text;
+
+	while(true)
+	{
+		if(accept("["))
+		{
+			// constant subscripts name one element; others refer to the whole array
+			if(pos+1 < tokens.size() && tokens[pos].kind == 'n' && tokens[pos+1].text == "]")
+			{
+				name += "[" + tokens[pos].text + "]";
+				pos += 2;
+			}
+			else
+			{
+				parseExpression();
+				expect("]");
+			}
+		}
+		else if(accept("->") || accept("."))
+		{
+			if(pos < tokens.size()) name += "." + tokens[pos++].text;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return name;
+}
+
+HLSScheduler::Value HLSScheduler::parseExpression()
+{
+	Value test = parseBinary(1);
+
+	if(!accept("?")) return test;
+
+	Value if_true = parseExpression();
+	expect(":");
+	Value if_false = parseExpression();
+
+	if(test.constant && if_true.constant && if_false.constant) return Value{0.0, true};
+
+	double start = std::max(test.time, std::max(if_true.time, if_false.time));
+	return Value{scheduleOperation(SELECT, start), false};
+}
+
+static int binaryPrecedence(const std::string& op)
+{
+	if(op == "||") return 1;
+	if(op == "&&") return 2;
+	if(op == "|") return 3;
+	if(op == "^") return 4;
+	if(op == "&") return 5;
+	if(op == "==" || op == "!=") return 6;
+	if(op == "<" || op == ">" || op == "<=" || op == ">=") return 7;
+	if(op == "<<" || op == ">>") return 8;
+	if(op == "+" || op == "-") return 9;
+	if(op == "*" || op == "/" || op == "%") return 10;
+	return 0;
+}
+
+HLSScheduler::Value HLSScheduler::parseBinary(int precedence)
+{
+	Value lhs = parseUnary();
+
+	while(pos < tokens.size() && tokens[pos].kind == 'o')
+	{
+		const std::string op = tokens[pos].text;
+		int op_precedence = binaryPrecedence(op);
+
+		if(op_precedence == 0 || op_precedence < precedence) break;
+
+		pos++;
+		Value rhs = parseBinary(op_precedence+1);
+
+		if(op == "<<" || op == ">>")
+		{
+			// shifts by constants are wiring
+			lhs = Value{std::max(lhs.time, rhs.time), lhs.constant && rhs.constant};
+		}
+		else if(op_precedence <= 5)
+			lhs = apply(LOGIC, lhs, rhs);
+		else if(op_precedence <= 7)
+			lhs = apply(CMP, lhs, rhs);
+		else if(op_precedence == 9)
+			lhs = apply(ADD, lhs, rhs);
+		else if(op == "*")
+			lhs = apply(MUL, lhs, rhs);
+		else
+			lhs = apply(DIV, lhs, rhs);
+	}
+
+	return lhs;
+}
+
+HLSScheduler::Value HLSScheduler::parseUnary()
+{
+	// negation folds into the consuming operator; address and dereference are free
+	if(accept("-") || accept("+") || accept("*") || accept("&")) return parseUnary();
+
+	if(accept("!") || accept("~"))
+	{
+		Value operand = parseUnary();
+		return operand.constant ? operand : Value{scheduleOperation(LOGIC, operand.time), false};
+	}
+
+	return parsePrimary();
+}
+
+HLSScheduler::Value HLSScheduler::parsePrimary()
+{
+	if(pos >= tokens.size())
+		throw std::runtime_error("HLSScheduler::scheduleCode(): unexpected end of code in expression");
+
+	if(tokens[pos].kind == 'n')
+	{
+		pos++;
+		return Value{0.0, true};
+	}
+
+	if(accept("("))
+	{
+		Value inner = parseExpression();
+		expect(")");
+		return inner;
+	}
+
+	if(tokens[pos].kind != 'i')
+		throw std::runtime_error("HLSScheduler::scheduleCode(): unexpected " + tokens[pos].text + " in expression");
+
+	std::string name = tokens[pos].text;
+
+	if(name == "true" || name == "false")
+	{
+		pos++;
+		return Value{0.0, true};
+	}
+
+	if(name == "static_cast" || name == "reinterpret_cast" || name == "const_cast")
+	{
+		pos++;
+		expect("<");
+		skipPast(">");
+		expect("(");
+		Value inner = parseExpression();
+		expect(")");
+		return inner;
+	}
+
+	// function style casts and calls
+	std::size_t call = pos+1;
+	while(call+1 < tokens.size() && tokens[call].text == "::") call += 2;
+
+	if(call < tokens.size() && tokens[call].text == "(")
+	{
+		bool cast = isTypeWord(name) && call == pos+1;
+		pos = call+1;
+
+		Value result{0.0, true};
+
+		if(!accept(")"))
+		{
+			do
+			{
+				Value arg = parseExpression();
+				result.time = std::max(result.time, arg.time);
+				result.constant = result.constant && arg.constant;
+			}
+			while(accept(","));
+
+			expect(")");
+		}
+
+		if(cast || result.constant) return result;
+
+		return Value{scheduleOperation(DIV, result.time), false};
+	}
+
+	return lookup(parseLValue());
+}
+
+HLSScheduler::Value HLSScheduler::apply(Operator op, const Value& lhs, const Value& rhs)
+{
+	if(lhs.constant && rhs.constant) return Value{0.0, true};
+
+	return Value{scheduleOperation(op, std::max(lhs.time, rhs.time)), false};
+}
+
+} //namespace lblmc
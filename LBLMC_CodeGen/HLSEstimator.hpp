@@ -0,0 +1,274 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+#ifndef HLSESTIMATOR_HPP
+#define HLSESTIMATOR_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <ostream>
+
+namespace lblmc
+{
+
+/**
+	\brief delay and resource cost of one instance of an operator in synthesized hardware
+**/
+struct HLSOperatorCost
+{
+	double delay;     ///< combinational delay of the operator in seconds; operators slower than the clock period are pipelined over whole cycles
+	unsigned int dsp; ///< number of DSP slices used by one instance
+	unsigned int lut; ///< number of LUTs used by one instance
+
+	HLSOperatorCost(double delay = 0.0, unsigned int dsp = 0, unsigned int lut = 0) :
+		delay(delay), dsp(dsp), lut(lut)
+	{}
+};
+
+/**
+	\brief operator costs used by the HLS latency and resource estimator
+
+	The defaults roughly model 64 bit fixed point words and IEEE 754 doubles on a Xilinx
+	UltraScale+ device and should be tuned to the target device and word width.
+**/
+struct HLSEstimatorParameters
+{
+	// Fixed Point operators
+	HLSOperatorCost fixed_add; ///< fixed point adder or subtracter; default is 2ns, 0 DSP, 64 LUT
+	HLSOperatorCost fixed_mul; ///< fixed point multiplier; default is 12ns, 16 DSP, 100 LUT
+	HLSOperatorCost fixed_div; ///< fixed point divider; default is 130ns, 0 DSP, 4096 LUT
+	HLSOperatorCost fixed_cmp; ///< fixed point comparator; default is 1.5ns, 0 DSP, 32 LUT
+
+	// Floating Point operators
+	HLSOperatorCost float_add; ///< double adder or subtracter; default is 10ns, 3 DSP, 700 LUT
+	HLSOperatorCost float_mul; ///< double multiplier; default is 12ns, 11 DSP, 300 LUT
+	HLSOperatorCost float_div; ///< double divider; default is 190ns, 0 DSP, 3200 LUT
+	HLSOperatorCost float_cmp; ///< double comparator; default is 2ns, 0 DSP, 70 LUT
+
+	// Other operators
+	HLSOperatorCost select; ///< multiplexer of a conditional assignment or ?: expression; default is 0.5ns, 0 DSP, 64 LUT
+	HLSOperatorCost logic;  ///< boolean logic operator; default is 0.3ns, 0 DSP, 1 LUT
+
+	// Memory settings
+	unsigned int bram_threshold_bits; ///< set smallest ROM bank in bits mapped to block RAM instead of LUTs; default is 1024
+
+	HLSEstimatorParameters() :
+		fixed_add(2.0e-9, 0, 64),
+		fixed_mul(12.0e-9, 16, 100),
+		fixed_div(130.0e-9, 0, 4096),
+		fixed_cmp(1.5e-9, 0, 32),
+		float_add(10.0e-9, 3, 700),
+		float_mul(12.0e-9, 11, 300),
+		float_div(190.0e-9, 0, 3200),
+		float_cmp(2.0e-9, 0, 70),
+		select(0.5e-9, 0, 64),
+		logic(0.3e-9, 0, 1),
+		bram_threshold_bits(1024)
+	{}
+};
+
+/**
+	\brief estimated latency and resource usage of a synthesized simulation engine
+
+	\see SimulationEngineGenerator::estimateHLS()
+**/
+struct HLSEstimate
+{
+	double clock_period;       ///< clock period the engine was scheduled against in seconds
+	unsigned int latency;      ///< estimated clock cycles of one time step
+	unsigned int latency_max;  ///< maximum clock cycles allowed by xilinx_hls_latency_max; 0 if unconstrained
+	bool latency_met;          ///< true if latency is within latency_max or unconstrained
+	unsigned int dsp;          ///< estimated DSP slices
+	unsigned int lut;          ///< estimated LUTs
+	unsigned int bram;         ///< estimated 18Kb block RAMs
+	unsigned int adders;       ///< adder and subtracter instances
+	unsigned int multipliers;  ///< multiplier instances
+	unsigned int dividers;     ///< divider and other function call instances
+	unsigned int comparators;  ///< comparator instances
+	unsigned int selects;      ///< multiplexer instances
+
+	HLSEstimate() :
+		clock_period(0.0), latency(0), latency_max(0), latency_met(true),
+		dsp(0), lut(0), bram(0),
+		adders(0), multipliers(0), dividers(0), comparators(0), selects(0)
+	{}
+
+	/**
+		\brief writes a human readable report of the estimate
+		\param strm the stream that the report is written to
+	**/
+	void writeReport(std::ostream& strm) const;
+};
+
+/**
+	\brief list scheduler of the operations of generated C++ engine code against a clock period
+
+	Statements are scheduled as soon as their operands are ready in an unrolled, inlined design,
+	as Xilinx HLS does for the straight-line engine code.  Operators that fit in the clock period
+	are chained within a cycle while their delays add up to at most a clock period; slower
+	operators are pipelined over whole cycles.  When a multiplier limit is set, at most that many
+	multiplications issue per cycle and the remaining ones are delayed.  Every operation in the
+	code is counted as its own operator instance, except multipliers, which are shared down to the
+	limit.
+
+	The code scanner understands assignments, compound assignments, declarations, if/else,
+	function style casts, and C expressions.  Assignments under a condition wait for the
+	condition and add a multiplexer.  Array elements with constant subscripts are tracked
+	individually.  Named constants and literals are free, and operations on them are folded.
+	Calls of other functions are costed as dividers, and loop bodies are scheduled once.
+
+	\note This class is NOT intended for RTL Synthesis.
+**/
+class HLSScheduler
+{
+
+public:
+
+	/**
+		\brief kinds of operators costed by the scheduler
+	**/
+	enum Operator { ADD, MUL, DIV, CMP, SELECT, LOGIC };
+
+private:
+
+	double clock_period;
+	bool fixed_point;
+	HLSEstimatorParameters costs;
+	unsigned int multiplier_limit;
+	std::set<std::string> constants;         ///< names of constant parameters
+	std::map<std::string, double> ready;     ///< time each assigned variable is ready in seconds
+	std::map<long, unsigned int> mul_issues; ///< multiplications issued per cycle
+	double finish;                           ///< latest time an operation finishes
+	unsigned int branch_depth;               ///< number of conditions enclosing the statement being scanned
+	unsigned int counts[6];                  ///< operation counts by Operator
+
+	struct Value
+	{
+		double time;   ///< time the value is ready in seconds
+		bool constant; ///< true if the value is known at synthesis
+	};
+
+	struct Token
+	{
+		int kind;         ///< 'i' identifier, 'n' number, or 'o' operator
+		std::string text; ///< text of the token
+	};
+
+	std::vector<Token> tokens;
+	std::size_t pos;
+
+	const HLSOperatorCost& cost(Operator op) const;
+
+	void tokenize(const std::string& code);
+	bool peek(const char* text) const;
+	bool accept(const char* text);
+	void expect(const char* text);
+
+	void skipPast(const char* text);
+	void parseStatement(double condition);
+	void parseDeclaration(double condition);
+	void assign(const std::string& target, Value value, double condition);
+	Value lookup(const std::string& name) const;
+	std::string parseLValue();
+	Value parseExpression();
+	Value parseBinary(int precedence);
+	Value parseUnary();
+	Value parsePrimary();
+	Value apply(Operator op, const Value& lhs, const Value& rhs);
+
+public:
+
+	HLSScheduler() = delete;
+
+	/**
+		\brief parameter constructor
+		\param clock_period clock period in seconds that operations are scheduled against
+		\param fixed_point true if real numbers are fixed point; false if doubles
+		\param costs delays and resources of the operators
+		\param multiplier_limit maximum multiplications issued per cycle; 0 for no limit
+		\throw std::invalid_argument if the clock period is not positive
+	**/
+	HLSScheduler(double clock_period, bool fixed_point, const HLSEstimatorParameters& costs, unsigned int multiplier_limit = 0);
+
+	/**
+		\brief marks names as constants known at synthesis, such as component parameters
+		\param names names of the constants
+	**/
+	void addConstants(const std::vector<std::string>& names);
+
+	/**
+		\brief schedules the statements of a block of C++ code after the operations scheduled so far
+		\param code the code to schedule
+		\throw std::runtime_error if the code cannot be scanned
+	**/
+	void scheduleCode(const std::string& code);
+
+	/**
+		\brief schedules one operation
+		\param op kind of the operation
+		\param start time the operands are ready in seconds
+		\param instance if true, the operation is counted as its own operator instance; false for
+		operations of a shared instance that the caller accounts for
+		\return time the result is ready in seconds
+	**/
+	double scheduleOperation(Operator op, double start, bool instance = true);
+
+	/**
+		\return time a variable or array element is ready in seconds; 0 if not assigned yet
+	**/
+	double getReadyTime(const std::string& name) const;
+
+	/**
+		\brief sets the time a variable or array element is ready
+	**/
+	void setReadyTime(const std::string& name, double time);
+
+	/**
+		\return number of operations of a kind scheduled so far
+	**/
+	inline unsigned int getOperationCount(Operator op) const { return counts[op]; }
+
+	/**
+		\return time the last scheduled operation finishes in seconds
+	**/
+	inline double getFinishTime() const { return finish; }
+
+	/**
+		\return number of clock cycles until the last scheduled operation finishes
+	**/
+	unsigned int getLatency() const;
+
+	/**
+		\brief fills the latency, operator counts, and operator resources of an estimate
+
+		The multiplier instances are limited to the multiplier limit, if any.
+	**/
+	void fillEstimate(HLSEstimate& estimate) const;
+
+};
+
+} //namespace lblmc
+
+#endif // HLSESTIMATOR_HPP
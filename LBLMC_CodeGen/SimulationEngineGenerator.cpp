@@ -20,16 +20,46 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 */
 
 #include "SimulationEngineGenerator.hpp"
+#include "FixedPointCode.hpp"
 
 #include <stdexcept>
 #include <sstream>
+#include <cmath>
+#include <cctype>
+#include <memory>
+#include <utility>
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "codegen/ArrayObject.hpp"
 
 namespace lblmc
 {
 
+/// \return 64-bit FNV-1a hash of the given bytes continuing from the given hash
+static std::uint64_t hashBytes(const std::string& bytes, std::uint64_t hash = 14695981039346656037ULL)
+{
+	for(unsigned char c : bytes)
+	{
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+
+	// separator so concatenated fields hash differently when split differently
+	hash ^= 0xFF;
+	hash *= 1099511628211ULL;
+
+	return hash;
+}
+
 SimulationEngineGenerator::SimulationEngineGenerator
 (
 	std::string model_name,
@@ -43,9 +73,12 @@ SimulationEngineGenerator::SimulationEngineGenerator
 	comp_outputs(),
 	comp_outputs_update_bodies(),
 	comp_update_bodies(),
+	comp_update_rates(),
 	conductance_matrix_gen(num_solutions),
 	source_vector_gen(num_solutions),
-	parameters()
+	initial_solutions(),
+	parameters(),
+	cache()
 {
 	if(model_name == "")
 		throw std::runtime_error("SimulationEngineGenerator::constructor(): model_name cannot be null or empty");
@@ -63,9 +96,12 @@ SimulationEngineGenerator::SimulationEngineGenerator(const SimulationEngineGener
 	comp_outputs(base.comp_outputs),
 	comp_outputs_update_bodies(base.comp_outputs_update_bodies),
 	comp_update_bodies(base.comp_update_bodies),
+	comp_update_rates(base.comp_update_rates),
 	conductance_matrix_gen(base.conductance_matrix_gen),
 	source_vector_gen(base.source_vector_gen),
-	parameters(base.parameters)
+	initial_solutions(base.initial_solutions),
+	parameters(base.parameters),
+	cache()
 {}
 
 void SimulationEngineGenerator::reset(std::string model_name, unsigned int num_solutions)
@@ -84,8 +120,11 @@ void SimulationEngineGenerator::reset(std::string model_name, unsigned int num_s
 	this->comp_outputs.clear();
 	this->comp_outputs_update_bodies.clear();
 	this->comp_update_bodies.clear();
+	this->comp_update_rates.clear();
 	this->conductance_matrix_gen = SystemConductanceGenerator(num_solutions);
 	this->source_vector_gen = SystemSourceVectorGenerator(num_solutions);
+	this->initial_solutions.clear();
+	this->cache.clear();
 }
 
 void SimulationEngineGenerator::setModelName(std::string model_name)
@@ -117,216 +156,624 @@ void SimulationEngineGenerator::insertComponentParametersCode(std::string& code)
 	comp_parameters.push_back(code);
 }
 
+void SimulationEngineGenerator::insertComponentParametersCode(std::string&& code)
+{
+	if(code.empty()) return;
+	comp_parameters.push_back(std::move(code));
+}
+
 void SimulationEngineGenerator::insertComponentFieldsCode(std::string& code)
 {
 	if(code.empty()) return;
 	comp_fields.push_back(code);
 }
 
+void SimulationEngineGenerator::insertComponentFieldsCode(std::string&& code)
+{
+	if(code.empty()) return;
+	comp_fields.push_back(std::move(code));
+}
+
+void SimulationEngineGenerator::setInitialSolutions(const std::vector<double>& solutions)
+{
+	if(!solutions.empty() && solutions.size() != num_solutions)
+		throw std::invalid_argument("SimulationEngineGenerator::setInitialSolutions(): number of solutions must equal num_solutions");
+
+	initial_solutions = solutions;
+}
+
 void SimulationEngineGenerator::insertComponentInputsCode(std::string& code)
 {
 	if(code.empty()) return;
 	comp_inputs.push_back(code);
 }
 
+void SimulationEngineGenerator::insertComponentInputsCode(std::string&& code)
+{
+	if(code.empty()) return;
+	comp_inputs.push_back(std::move(code));
+}
+
 void SimulationEngineGenerator::insertComponentOutputsCode(std::string& code)
 {
 	if(code.empty()) return;
 	comp_outputs.push_back(code);
 }
 
+void SimulationEngineGenerator::insertComponentOutputsCode(std::string&& code)
+{
+	if(code.empty()) return;
+	comp_outputs.push_back(std::move(code));
+}
+
 void SimulationEngineGenerator::insertComponentOutputsUpdateBody(std::string& code)
 {
 	if(code.empty()) return;
 	comp_outputs_update_bodies.push_back(code);
 }
 
-void SimulationEngineGenerator::insertComponentUpdateBody(std::string& code)
+void SimulationEngineGenerator::insertComponentOutputsUpdateBody(std::string&& code)
+{
+	if(code.empty()) return;
+	comp_outputs_update_bodies.push_back(std::move(code));
+}
+
+void SimulationEngineGenerator::insertComponentUpdateBody(std::string& code, unsigned int rate)
 {
+	if(rate == 0)
+		throw std::invalid_argument("SimulationEngineGenerator::insertComponentUpdateBody(): rate must be positive nonzero value");
+
 	if(code.empty()) return;
 	comp_update_bodies.push_back(code);
+	comp_update_rates.push_back(rate);
 }
 
-std::string SimulationEngineGenerator::generateCFunctionParameterList() const
+void SimulationEngineGenerator::insertComponentUpdateBody(std::string&& code, unsigned int rate)
 {
-	std::stringstream sstrm;
+	if(rate == 0)
+		throw std::invalid_argument("SimulationEngineGenerator::insertComponentUpdateBody(): rate must be positive nonzero value");
+
+	if(code.empty()) return;
+	comp_update_bodies.push_back(std::move(code));
+	comp_update_rates.push_back(rate);
+}
+
+std::vector<unsigned int> SimulationEngineGenerator::planUpdatePhases() const
+{
+	std::vector<unsigned int> phases(comp_update_bodies.size(), 0);
+
+	if(!multiRateEnabled()) return phases;
+
+	const unsigned int hyperperiod = multiRateHyperperiod();
+
+	// size of the update code run in each step of the schedule; updates run every step load all
+	// steps alike and are left out
+	std::vector<std::size_t> load(hyperperiod, 0);
+
+	std::vector<unsigned int> order;
+	for(unsigned int i = 0; i < comp_update_bodies.size(); i++)
+	{
+		if(comp_update_rates[i] > 1) order.push_back(i);
+	}
+
+	std::stable_sort(order.begin(), order.end(),
+		[this](unsigned int a, unsigned int b) { return comp_update_bodies[a].size() > comp_update_bodies[b].size(); });
+
+	for(unsigned int i : order)
+	{
+		const unsigned int rate = comp_update_rates[i];
+		const std::size_t cost = comp_update_bodies[i].size();
+
+		unsigned int best_phase = 0;
+		std::size_t best_peak = 0;
+
+		for(unsigned int phase = 0; phase < rate; phase++)
+		{
+			std::size_t peak = 0;
+			for(unsigned int step = phase; step < hyperperiod; step += rate) peak = std::max(peak, load[step] + cost);
+
+			if(phase == 0 || peak < best_peak)
+			{
+				best_phase = phase;
+				best_peak = peak;
+			}
+		}
+
+		for(unsigned int step = best_phase; step < hyperperiod; step += rate) load[step] += cost;
+
+		phases[i] = best_phase;
+	}
+
+	return phases;
+}
+
+int SimulationEngineGenerator::computeInvConductanceRescaleExponent(const SystemConductanceGenerator& invg, double zero_bound) const
+{
+	if(!parameters.inv_conduct_matrix_rescale_enable) return 0;
+
+	unsigned int divider = parameters.inv_conduct_matrix_divider;
+
+	if(divider != 0)
+	{
+		if( (divider & (divider-1)) != 0 )
+			throw std::runtime_error("SimulationEngineGenerator::computeInvConductanceRescaleExponent(): inv_conduct_matrix_divider must be 0 or a power of 2");
+
+		int s = 0;
+		while(divider > 1) { divider >>= 1; s++; }
+		return s;
+	}
+
+	double max_abs = 0.0;
+	const MatrixRMXd& mat = invg.asEigen3Matrix();
+	for(unsigned int i = 0; i < mat.size(); i++)
+	{
+		double v = std::fabs(mat.data()[i]);
+		if(v >= zero_bound && v > max_abs) max_abs = v;
+	}
+
+	if(max_abs == 0.0) return 0;
+
+	// max_abs = f*2^e with f in [0.5,1); scaled max lies in [2^(I-2), 2^(I-1))
+	int e;
+	std::frexp(max_abs, &e);
+
+	return e - int(parameters.fixed_point_int_width) + 1;
+}
+
+unsigned int SimulationEngineGenerator::computeSolverInterleave() const
+{
+	if(parameters.xilinx_hls_clock_period <= 0.0) return 1;
+
+	const double adder_delay = parameters.fixed_point_enable ? 2.0e-9 : 10.0e-9;
+	const double cycles = std::ceil(adder_delay / parameters.xilinx_hls_clock_period - 1.0e-9);
+
+	return cycles > 1.0 ? static_cast<unsigned int>(cycles) : 1;
+}
+
+void SimulationEngineGenerator::writeRemappedSourceSlots(std::ostream& strm, const std::string& code, const std::vector<unsigned int>& slot_map)
+{
+	const static std::string SLOT_PREFIX = "b_components[";
+
+	std::string::size_type pos = 0;
+	std::string::size_type found;
+
+	while( (found = code.find(SLOT_PREFIX, pos)) != std::string::npos )
+	{
+		std::string::size_type idx_begin = found + SLOT_PREFIX.size();
+		std::string::size_type idx_end = idx_begin;
+		while(idx_end < code.size() && std::isdigit(code[idx_end])) idx_end++;
+
+		bool is_word = (found == 0) || !(std::isalnum(code[found-1]) || code[found-1] == '_');
+
+		strm.write(code.data()+pos, idx_begin-pos);
+		pos = idx_begin;
+
+		if(!is_word || idx_end == idx_begin || idx_end >= code.size() || code[idx_end] != ']')
+			continue;
+
+		unsigned long slot = std::stoul(code.substr(idx_begin, idx_end-idx_begin));
+		if(slot+1 >= slot_map.size())
+			throw std::runtime_error("SimulationEngineGenerator::writeRemappedSourceSlots(): code refers to b_components slot beyond number of sources");
+
+		strm << slot_map[slot+1]-1;
+		pos = idx_end;
+	}
+
+	strm.write(code.data()+pos, code.size()-pos);
+}
+
+std::vector<unsigned int> SimulationEngineGenerator::parseSourceSlots(const std::string& code)
+{
+	const static std::string SLOT_PREFIX = "b_components[";
+
+	std::vector<unsigned int> slots;
+
+	std::string::size_type found = 0;
+
+	while( (found = code.find(SLOT_PREFIX, found)) != std::string::npos )
+	{
+		std::string::size_type idx_begin = found + SLOT_PREFIX.size();
+		std::string::size_type idx_end = idx_begin;
+		while(idx_end < code.size() && std::isdigit(code[idx_end])) idx_end++;
+
+		bool is_word = (found == 0) || !(std::isalnum(code[found-1]) || code[found-1] == '_');
+
+		found = idx_begin;
+
+		if(!is_word || idx_end == idx_begin || idx_end >= code.size() || code[idx_end] != ']')
+			continue;
+
+		unsigned int slot = std::stoul(code.substr(idx_begin, idx_end-idx_begin));
+
+		if(std::find(slots.begin(), slots.end(), slot) == slots.end()) slots.push_back(slot);
+	}
+
+	return slots;
+}
+
+bool SimulationEngineGenerator::multiRateEnabled() const
+{
+	for(unsigned int rate : comp_update_rates)
+	{
+		if(rate > 1) return true;
+	}
+
+	return false;
+}
+
+unsigned int SimulationEngineGenerator::multiRateHyperperiod() const
+{
+	unsigned long hyperperiod = 1;
+
+	for(unsigned int rate : comp_update_rates)
+	{
+		unsigned long a = hyperperiod, b = rate;
+		while(b != 0) { unsigned long t = a % b; a = b; b = t; }
+
+		hyperperiod = hyperperiod / a * rate;
+
+		if(hyperperiod > 65536)
+			throw std::runtime_error("SimulationEngineGenerator::multiRateHyperperiod(): schedule of the update rates repeats only after more than 65536 steps");
+	}
+
+	return hyperperiod;
+}
+
+std::string SimulationEngineGenerator::multiRateFieldsCode() const
+{
+	if(!multiRateEnabled()) return std::string("");
+
+	// the counter starts before the first step so that step runs every update; it then counts as
+	// step 0 of the schedule
+	std::string code = "static int multirate_step = -1;\n";
+
+	for(unsigned int i = 0; i < comp_update_bodies.size(); i++)
+	{
+		if(comp_update_rates[i] == 1) continue;
+
+		for(unsigned int slot : parseSourceSlots(comp_update_bodies[i]))
+		{
+			code += "static real multirate_hold_" + std::to_string(slot) + " = 0;\n";
+		}
+	}
+
+	return code;
+}
+
+std::vector<std::string> SimulationEngineGenerator::engineFieldsCode() const
+{
+	std::vector<std::string> fields = comp_fields;
+
+	std::string multi_rate = multiRateFieldsCode();
+	if(!multi_rate.empty()) fields.push_back(std::move(multi_rate));
+
+	return fields;
+}
+
+void SimulationEngineGenerator::emitCFunctionParameterList(codegen::CodeEmitter& emitter) const
+{
+	if(parameters.batch_lanes > 1)
+	{
+		emitBatchedCFunctionParameterList(emitter);
+		return;
+	}
+
+	if(parameters.io_struct_abi_enable)
+	{
+		emitter
+		<< "const " << model_name << "_Inputs* in,\n"
+		<< model_name << "_Outputs* out";
+		return;
+	}
 
 	codegen::ArrayObject x_out("real", "x_out", "", {num_solutions});
-	sstrm << x_out.generateArgument();
+	emitter << x_out.generateArgument();
 
 	if( parameters.io_signal_output_enable && !comp_outputs.empty())
 	{
-		sstrm << ",\n";
+		emitter << ",\n";
 
 		auto iter = comp_outputs.begin();
 
-		sstrm << *iter;
+		emitter << *iter;
 
 		for(iter = iter+1; iter != comp_outputs.end(); iter++)
 		{
-            sstrm << ",\n"
-                  << *iter;
+            emitter << ",\n"
+                    << *iter;
 		}
 	}
 
 	if(!comp_inputs.empty())
 	{
-		sstrm << ",\n";
+		emitter << ",\n";
 
 		auto iter = comp_inputs.begin();
 
-		sstrm << *iter;
+		emitter << *iter;
 
 		for(iter = iter+1; iter != comp_inputs.end(); iter++)
 		{
-            sstrm << ",\n"
-                  << *iter;
+            emitter << ",\n"
+                    << *iter;
 		}
 	}
-
-	return sstrm.str();
 }
 
-std::string SimulationEngineGenerator::generateCInlineCode(double zero_bound) const
+std::string SimulationEngineGenerator::generateCFunctionParameterList() const
 {
-	std::stringstream sstrm;
-
-	SystemConductanceGenerator invg_gen(conductance_matrix_gen);
-	invg_gen.invertSelf();
-	const double * invg = invg_gen.asArray();
+	codegen::CodeEmitter emitter;
+	emitCFunctionParameterList(emitter);
+	return emitter.str();
+}
 
+void SimulationEngineGenerator::updateCache(double zero_bound) const
+{
 	unsigned int num_components = source_vector_gen.getNumSources();
 
-	SystemSolverGenerator solver_gen(invg, num_solutions, num_components, zero_bound);
+	if(!cache.invg_gen || cache.conductance_revision != conductance_matrix_gen.getRevision())
+	{
+		cache.solver_gen.reset();
+		cache.invg_gen.reset(new SystemConductanceGenerator(conductance_matrix_gen.invert()));
+		cache.conductance_revision = conductance_matrix_gen.getRevision();
+	}
 
-	std::string buf;
+	const double* invg = static_cast<const SystemConductanceGenerator&>(*cache.invg_gen).asEigen3Matrix().data();
 
-	//codegen xilinx HLS features
-	if(parameters.xilinx_hls_enable)
+	if(!cache.solver_gen || cache.zero_bound != zero_bound)
+	{
+		cache.solver_gen.reset(new SystemSolverGenerator(invg, num_solutions, num_components, zero_bound));
+		cache.zero_bound = zero_bound;
+	}
+	else if(cache.solver_gen->getNumberOfComponents() != num_components)
 	{
-		sstrm << "//clock period=" << parameters.xilinx_hls_clock_period << "\n";
+		cache.solver_gen->reset(invg, num_solutions, num_components, zero_bound);
+	}
 
-		if(parameters.xilinx_hls_inline)
+	if( cache.source_revision != source_vector_gen.getRevision() ||
+	    cache.source_slot_reorder_enable != parameters.source_slot_reorder_enable )
+	{
+		// renumber source slots on a copy so the generator's own source indices stay untouched
+		cache.slot_map.clear();
+		if(parameters.source_slot_reorder_enable)
 		{
-			sstrm << "#pragma HLS inline\n";
+			SystemSourceVectorGenerator ordered_source_gen(source_vector_gen);
+			cache.slot_map = ordered_source_gen.reorderSources();
+			cache.aggregation_code = ordered_source_gen.asCInlineCode();
 		}
-
-		if(parameters.xilinx_hls_latency_enable)
+		else
 		{
-			sstrm << "#pragma HLS latency min="<<parameters.xilinx_hls_latency_min<<
-			         " max="<<parameters.xilinx_hls_latency_max<<"\n";
+			cache.aggregation_code = source_vector_gen.asCInlineCode();
 		}
 
-		sstrm << "\n";
+		cache.source_revision = source_vector_gen.getRevision();
+		cache.source_slot_reorder_enable = parameters.source_slot_reorder_enable;
 	}
+}
 
-	sstrm << "//MODEL PARAMETERS\n\n";
+void SimulationEngineGenerator::emitInvConductanceLiteral(codegen::CodeEmitter& emitter, int rescale_exponent, const char* decl_specifiers) const
+{
+	const SystemConductanceGenerator& invg_gen = *cache.invg_gen;
+
+	if(rescale_exponent != 0)
+	{
+		emitter << "//inv_g rescaled by 2^(" << -rescale_exponent << "); solutions compensated by 2^(" << rescale_exponent << ")\n";
 
-	for(auto i : comp_parameters)
+		SystemConductanceGenerator invg_scaled_gen(num_solutions, invg_gen.asEigen3Matrix() * std::ldexp(1.0, -rescale_exponent));
+		invg_scaled_gen.writeCLiteral(emitter.stream(), "inv_g", decl_specifiers);
+	}
+	else
 	{
-		sstrm << i << "\n";
+		invg_gen.writeCLiteral(emitter.stream(), "inv_g", decl_specifiers);
 	}
-	sstrm << "\n";
+}
 
-	sstrm << "//COMPONENT FIELDS AND STATES\n\n";
+std::vector<SimulationEngineGenerator::FieldDeclaration> SimulationEngineGenerator::parseParameters() const
+{
+	std::vector<FieldDeclaration> params;
 
-	for(auto i : comp_fields)
+	for(const auto& i : comp_parameters)
 	{
-		sstrm << i << "\n";
+		std::vector<FieldDeclaration> comp = parseFieldsCode(i, true);
+		params.insert(params.end(), comp.begin(), comp.end());
 	}
-	sstrm << "\n";
 
-	sstrm << "//MODEL SOLUTIONS\n\n";
+	return params;
+}
 
-	sstrm
-	<< "static real b["<<num_solutions<<"];\n"
-	<< "static real x["<<num_solutions+1<<"];\n"
-	<< "real b_components["<<num_components<<"];\n\n";
+void SimulationEngineGenerator::emitModelParameters(codegen::CodeEmitter& emitter) const
+{
+	if(parameters.runtime_parameters_enable)
+	{
+		for(const auto& param : parseParameters())
+		{
+			emitter << "const " << param.type << "& " << param.name << " = params->" << param.name << ";\n";
+		}
+		emitter << "\n";
+		return;
+	}
+
+	for(const auto& i : comp_parameters)
+	{
+		emitter << i << "\n";
+	}
+	emitter << "\n";
+}
+
+void SimulationEngineGenerator::emitInvConductance(codegen::CodeEmitter& emitter, int rescale_exponent) const
+{
+	if(parameters.runtime_parameters_enable)
+	{
+		emitter << "const real (&inv_g)["<<num_solutions<<"]["<<num_solutions<<"] = params->inv_g;\n";
+		return;
+	}
+
+	if(cache.solver_gen->getFoldingLanes() != 0)
+	{
+		emitter << "//inv_g folded into the coefficient ROMs of the solver\n";
+		return;
+	}
+
+	emitInvConductanceLiteral(emitter, rescale_exponent, "const static real");
+}
+
+void SimulationEngineGenerator::emitParameterDefinitions(codegen::CodeEmitter& emitter, double zero_bound) const
+{
+	updateCache(zero_bound);
+
+	int rescale_exponent = computeInvConductanceRescaleExponent(*cache.invg_gen, zero_bound);
 
-	sstrm << "//INVERTED CONDUCTANCE MATRIX\n\n";
+	std::vector<FieldDeclaration> params = parseParameters();
 
-	buf = invg_gen.asCLiteral("inv_g");
-	sstrm << buf << "\n\n";
+	for(const auto& param : params)
+	{
+		if(!param.extents.empty())
+			throw std::runtime_error("SimulationEngineGenerator::emitParameterDefinitions(): array parameters are not supported as runtime parameters");
+	}
 
-	sstrm << "//COMPONENT SOURCE CONTRIBUTION UPDATES\n\n";
+	emitter << "struct " << model_name << "_Parameters\n{\n";
 
-	for(auto i : comp_update_bodies)
+	for(const auto& param : params)
 	{
-		sstrm << i << "\n";
+		emitter << "\t" << param.type << " " << param.name << ";\n";
 	}
-	sstrm << "\n";
 
-	if(parameters.io_signal_output_enable)
+	emitter
+	<< "\treal inv_g["<<num_solutions<<"]["<<num_solutions<<"];\n"
+	<< "};\n\n";
+
+	emitter
+	<< "inline void " << model_name << "_initParameters(" << model_name << "_Parameters* params)\n"
+	<< "{\n";
+
+	for(const auto& param : params)
 	{
-		sstrm << "//MODEL OUTPUT SIGNAL UPDATES\n\n";
+		emitter << "\tparams->" << param.name << " = " << param.value << ";\n";
+	}
+	emitter << "\n";
 
-		for(auto i : comp_outputs_update_bodies)
-		{
-			sstrm << i << "\n";
-		}
-		sstrm << "\n";
+	emitInvConductanceLiteral(emitter, rescale_exponent, "\tconst static real");
+
+	emitter
+	<< "\n"
+	<< "\tfor(unsigned int r = 0; r < " << num_solutions << "; r++)\n"
+	<< "\t\tfor(unsigned int c = 0; c < " << num_solutions << "; c++)\n"
+	<< "\t\t\tparams->inv_g[r][c] = inv_g[r][c];\n"
+	<< "}\n\n";
+
+	emitter
+	<< "//data holds the " << params.size() << " parameters followed by the unscaled "
+	<< num_solutions << "x" << num_solutions << " inv_g in row-major order\n"
+	<< "inline void " << model_name << "_loadParameters(" << model_name << "_Parameters* params, const double* data)\n"
+	<< "{\n";
+
+	for(unsigned int i = 0; i < params.size(); i++)
+	{
+		emitter << "\tparams->" << params[i].name << " = (" << params[i].type << ")(data[" << i << "]);\n";
 	}
+	emitter << "\n";
 
-	sstrm << "//AGGREGRATE COMPONENT SOURCE CONTRIBUTIONS\n\n";
+	emitter
+	<< "\tfor(unsigned int r = 0; r < " << num_solutions << "; r++)\n"
+	<< "\t\tfor(unsigned int c = 0; c < " << num_solutions << "; c++)\n"
+	<< "\t\t\tparams->inv_g[r][c] = real(data[" << params.size() << " + r*" << num_solutions << " + c]";
 
-	source_vector_gen.asCInlineCode(buf);
-	sstrm << buf << "\n\n";
+	if(rescale_exponent != 0)
+	{
+		std::ios::fmtflags flags = emitter.stream().flags();
+		std::streamsize precision = emitter.stream().precision();
+
+		emitter << std::scientific << std::setprecision(17) << "*" << std::ldexp(1.0, -rescale_exponent);
 
-	sstrm << "//MODEL UPDATE SOLUTIONS\n\n";
+		emitter.stream().flags(flags);
+		emitter.stream().precision(precision);
+	}
 
-	solver_gen.generateCInlineCode(buf, "inv_g");
-	sstrm << buf << "\n\n";
+	emitter
+	<< ");\n"
+	<< "}\n\n";
 
-	return sstrm.str();
+	const unsigned long num_values = params.size() + (unsigned long)num_solutions*num_solutions;
+
+	emitter
+	<< "#ifndef __SYNTHESIS__\n"
+	<< "#include <cstdio>\n"
+	<< "#include <vector>\n\n"
+	<< "inline bool " << model_name << "_loadParametersFile(" << model_name << "_Parameters* params, const char* filename)\n"
+	<< "{\n"
+	<< "\tstd::FILE* file = std::fopen(filename, \"rb\");\n"
+	<< "\tif(file == 0) return false;\n\n"
+	<< "\tstd::vector<double> data(" << num_values << ");\n"
+	<< "\tbool loaded = std::fread(data.data(), sizeof(double), data.size(), file) == data.size() && std::fgetc(file) == EOF;\n"
+	<< "\tstd::fclose(file);\n\n"
+	<< "\tif(loaded) " << model_name << "_loadParameters(params, data.data());\n"
+	<< "\treturn loaded;\n"
+	<< "}\n"
+	<< "#endif\n\n";
 }
 
-std::string SimulationEngineGenerator::generateCFunction(double zero_bound) const
+std::vector<double> SimulationEngineGenerator::generateRuntimeParameters(double zero_bound) const
 {
-	std::stringstream sstrm;
-
-	sstrm
-	<< "void "<<model_name<<"_simulationEngine\n"
-	<< "(\n";
+	updateCache(zero_bound);
 
-	sstrm
-	<< generateCFunctionParameterList()
-	<< "\n)\n"
-	<< "{\n";
+	std::vector<FieldDeclaration> params = parseParameters();
 
-	std::string buf;
-	buf = generateCInlineCode(zero_bound);
-	sstrm << buf;
+	std::vector<double> values;
+	values.reserve(params.size() + num_solutions*num_solutions);
 
-	for(unsigned int i = 0; i < num_solutions; i++)
+	for(const auto& param : params)
 	{
-		sstrm << "x_out["<<i<<"] = x["<<i+1<<"];\n";
+		if(param.value == "true") values.push_back(1.0);
+		else if(param.value == "false") values.push_back(0.0);
+		else
+		{
+			std::size_t parsed = 0;
+			try { values.push_back(std::stod(param.value, &parsed)); }
+			catch(const std::logic_error&) { parsed = 0; }
+
+			if(parsed == 0)
+				throw std::runtime_error("SimulationEngineGenerator::generateRuntimeParameters(): value of parameter " + param.name + " is not a number");
+		}
 	}
 
-	sstrm
-	<< "\n}";
+	const MatrixRMXd& invg = static_cast<const SystemConductanceGenerator&>(*cache.invg_gen).asEigen3Matrix();
+	values.insert(values.end(), invg.data(), invg.data()+invg.size());
 
-	return sstrm.str();
+	return values;
 }
 
-void SimulationEngineGenerator::generateCFunctionAndExport(std::string filename, double zero_bound) const
+void SimulationEngineGenerator::exportRuntimeParameters(std::string filename, double zero_bound) const
 {
 	if(filename == "")
-		throw std::invalid_argument("SimulationEngineGenerator::generateCFunctionAndExport(): filename cannot be null or empty");
+		throw std::invalid_argument("SimulationEngineGenerator::exportRuntimeParameters(): filename cannot be null or empty");
 
-	std::fstream file;
+	std::vector<double> values = generateRuntimeParameters(zero_bound);
 
-	std::string fname = filename;
+	std::ofstream file(filename, std::ios::binary);
 
-	try
-	{
-		file.open(fname.c_str(), std::fstream::out | std::fstream::trunc);
-	}
-	catch(...)
+	if(!file.is_open())
+		throw std::runtime_error("SimulationEngineGenerator::exportRuntimeParameters(): could not open file " + filename);
+
+	file.write(reinterpret_cast<const char*>(values.data()), values.size()*sizeof(double));
+
+	if(!file)
+		throw std::runtime_error("SimulationEngineGenerator::exportRuntimeParameters(): could not write file " + filename);
+}
+
+void SimulationEngineGenerator::emitUpdateBody(codegen::CodeEmitter& emitter, const std::string& code) const
+{
+	if(cache.slot_map.empty())
+		emitter << code << "\n";
+	else
 	{
-		throw std::runtime_error("SimulationEngineGenerator::generateCFunctionAndExport(): failed to open or create source files");
+		writeRemappedSourceSlots(emitter.stream(), code, cache.slot_map);
+		emitter << "\n";
 	}
+}
 
-	file <<
+void SimulationEngineGenerator::emitFileBanner(codegen::CodeEmitter& emitter)
+{
+	emitter <<
 			"/**\n"
 			" *\n"
 			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
@@ -334,43 +781,3622 @@ void SimulationEngineGenerator::generateCFunctionAndExport(std::string filename,
 			" * Auto-generated by SimulationEngineGenerator Object\n"
 			" *\n"
 			" */\n\n";
+}
 
-	file << "#ifndef " << model_name << "_SIMULATIONENGINE_HPP" << "\n";
-	file << "#define " << model_name << "_SIMULATIONENGINE_HPP" << "\n";
+void SimulationEngineGenerator::emitRealTypedef(codegen::CodeEmitter& emitter) const
+{
+	// stream words wider than the default ap_int limit must be enabled before the first ap_int include
+	if(parameters.xilinx_hls_enable && !parameters.xilinx_hls_stream_interface.empty())
+	{
+		unsigned int input_bytes;
+		unsigned int output_bytes;
 
-	file << "\n\n";
+		layoutStreamWord(parseInputs(), false, input_bytes);
+		layoutStreamWord(parseOutputs(), true, output_bytes);
+
+		const unsigned int bits = 8*std::max(input_bytes, output_bytes);
+
+		if(bits > 1024)
+			emitter << "#ifndef AP_INT_MAX_W\n#define AP_INT_MAX_W " << bits << "\n#endif\n\n";
+	}
 
 	if(parameters.fixed_point_enable)
 	{
 		if(parameters.xilinx_hls_enable)
 		{
-			file <<
+			emitter <<
 			"#include <ap_fixed.h>\n" <<
 			"typedef ap_fixed<"<<parameters.fixed_point_word_width<<", "<<
-			parameters.fixed_point_int_width<<", AP_RND> real;\n\n";
+			parameters.fixed_point_int_width<<", AP_RND"<<
+			(parameters.fixed_point_saturation_enable ? ", AP_SAT" : "")<<"> real;\n\n";
 
 		}
 		else
 		{
-			file << "//platform-agnostic fixed point not supported yet. Using double real values\n"<<
-			"typedef double real;\n\n";
+			if(parameters.fixed_point_word_width == 0 || parameters.fixed_point_word_width > 64 ||
+			   parameters.fixed_point_int_width > parameters.fixed_point_word_width)
+				throw std::runtime_error("SimulationEngineGenerator::emitRealTypedef(): platform-agnostic fixed point requires a word width of 1 to 64 bits no smaller than the integral width");
+
+			// intermediate results keep as many fraction bits as stay bit exact for the word's integer bits
+			emitter <<
+			"//platform-agnostic fixed point matching ap_fixed<"<<parameters.fixed_point_word_width<<", "<<
+			parameters.fixed_point_int_width<<", AP_RND"<<(parameters.fixed_point_saturation_enable ? ", AP_SAT" : "")<<">\n\n"<<
+			"#ifndef LBLMC_FIXED_FRACTION_LIMIT\n"<<
+			"#define LBLMC_FIXED_FRACTION_LIMIT "<<128-parameters.fixed_point_int_width<<"\n"<<
+			"#endif\n\n"<<
+			getFixedPointTypeCode()<<"\n\n"<<
+			"typedef lblmc_fixed<"<<parameters.fixed_point_word_width<<", "<<
+			parameters.fixed_point_int_width<<(parameters.fixed_point_saturation_enable ? ", true" : "")<<"> real;\n\n";
 		}
 	}
 	else
 	{
-		file << "typedef double real;\n\n";
+		emitter << "typedef double real;\n\n";
 	}
+}
 
-	file << "inline\n";
+std::vector<SimulationEngineGenerator::FieldDeclaration> SimulationEngineGenerator::parseFieldsCode(const std::string& code, bool constant)
+{
+	const std::string STATIC_PREFIX = constant ? "const static " : "static ";
+	const static char* SPACES = " \t\r";
 
-    std::string buf;
-    buf = generateCFunction(zero_bound);
-    file << buf << "\n\n";
+	auto trim = [](const std::string& str)
+	{
+		std::string::size_type first = str.find_first_not_of(SPACES);
+		if(first == std::string::npos) return std::string();
+		return str.substr(first, str.find_last_not_of(SPACES)-first+1);
+	};
 
-	file << "\n#endif";
+	std::vector<FieldDeclaration> fields;
 
-	file.close();
+	std::string::size_type pos = 0;
+
+	while(pos < code.size())
+	{
+		std::string::size_type eol = code.find('\n', pos);
+		if(eol == std::string::npos) eol = code.size();
+
+		std::string line = trim(code.substr(pos, eol-pos));
+		pos = eol+1;
+
+		if(line.compare(0, STATIC_PREFIX.size(), STATIC_PREFIX) != 0) continue;
+
+		std::string decl = line.substr(STATIC_PREFIX.size());
+		if(!decl.empty() && decl.back() == ';') decl.pop_back();
+
+		FieldDeclaration field;
+
+		std::string::size_type assign = decl.find('=');
+		if(assign != std::string::npos)
+		{
+			field.value = trim(decl.substr(assign+1));
+			decl.erase(assign);
+		}
+
+		std::string::size_type bracket = decl.find('[');
+		if(bracket != std::string::npos)
+		{
+			field.extents = trim(decl.substr(bracket));
+			decl.erase(bracket);
+		}
+
+		decl = trim(decl);
+
+		std::string::size_type name_begin = decl.size();
+		while(name_begin > 0 && (std::isalnum(decl[name_begin-1]) || decl[name_begin-1] == '_')) name_begin--;
+
+		field.name = decl.substr(name_begin);
+		field.type = trim(decl.substr(0, name_begin));
+
+		if(field.name.empty() || field.type.empty())
+			throw std::runtime_error("SimulationEngineGenerator::parseFieldsCode(): field without type or name in component fields code");
+
+		fields.push_back(field);
+	}
+
+	return fields;
+}
+
+void SimulationEngineGenerator::emitFieldsCode(codegen::CodeEmitter& emitter, const std::string& code, bool definition)
+{
+	for(const auto& field : parseFieldsCode(code))
+	{
+		if(definition)
+		{
+			emitter << field.type << " " << field.name << field.extents;
+			if(!field.value.empty()) emitter << " = " << field.value;
+			emitter << ";\n";
+		}
+		else
+		{
+			emitter << "extern " << field.type << " " << field.name << field.extents << ";\n";
+		}
+	}
+}
+
+void SimulationEngineGenerator::emitStateDefinitions(codegen::CodeEmitter& emitter) const
+{
+	std::vector<FieldDeclaration> fields;
+	for(const auto& i : engineFieldsCode())
+	{
+		std::vector<FieldDeclaration> comp = parseFieldsCode(i);
+		fields.insert(fields.end(), comp.begin(), comp.end());
+	}
+
+	if(parameters.batch_lanes > 1)
+	{
+		const unsigned int lanes = parameters.batch_lanes;
+
+		for(const auto& field : fields)
+		{
+			if(!field.extents.empty())
+				throw std::runtime_error("SimulationEngineGenerator::emitStateDefinitions(): array fields are not supported in batched engines");
+		}
+
+		emitter << "struct " << model_name << "_State\n{\n";
+
+		for(const auto& field : fields)
+		{
+			emitter << "\t" << field.type << " " << field.name << "[" << lanes << "];\n";
+		}
+
+		emitter
+		<< "\treal b["<<num_solutions<<"]["<<lanes<<"];\n"
+		<< "\treal x["<<num_solutions+1<<"]["<<lanes<<"];\n"
+		<< "};\n\n";
+
+		emitter
+		<< "struct " << model_name << "_Lane\n{\n"
+		<< "\treal (*data)["<<lanes<<"];\n"
+		<< "\tunsigned int lane;\n\n"
+		<< "\tinline real& operator[](unsigned int i) const { return data[i][lane]; }\n"
+		<< "};\n\n";
+
+		emitter
+		<< "inline void " << model_name << "_initState(" << model_name << "_State* state)\n"
+		<< "{\n";
+
+		if(!initial_solutions.empty())
+			emitter << "\tconst static real initial_x["<<num_solutions+1<<"] = " << initialSolutionsCode() << ";\n\n";
+
+		emitter
+		<< "\tfor(unsigned int lane = 0; lane < " << lanes << "; lane++)\n"
+		<< "\t{\n";
+
+		for(const auto& field : fields)
+		{
+			emitter << "\t\tstate->" << field.name << "[lane] = " << (field.value.empty() ? "0" : field.value) << ";\n";
+		}
+
+		emitter
+		<< "\n"
+		<< "\t\tfor(unsigned int i = 0; i < " << num_solutions << "; i++) state->b[i][lane] = 0;\n"
+		<< "\t\tfor(unsigned int i = 0; i < " << num_solutions+1 << "; i++) state->x[i][lane] = " << (initial_solutions.empty() ? "0" : "initial_x[i]") << ";\n"
+		<< "\t}\n"
+		<< "}\n\n";
+
+		emitter
+		<< "inline void " << model_name << "_resetState(" << model_name << "_State* state)\n"
+		<< "{\n"
+		<< "\t" << model_name << "_initState(state);\n"
+		<< "}\n\n";
+
+		return;
+	}
+
+	emitter << "struct " << model_name << "_State\n{\n";
+
+	for(const auto& field : fields)
+	{
+		emitter << "\t" << field.type << " " << field.name << field.extents << ";\n";
+	}
+
+	emitter
+	<< "\treal b["<<num_solutions<<"];\n"
+	<< "\treal x["<<num_solutions+1<<"];\n"
+	<< "};\n\n";
+
+	emitter
+	<< "inline void " << model_name << "_initState(" << model_name << "_State* state)\n"
+	<< "{\n"
+	<< "\tconst static " << model_name << "_State initial =\n"
+	<< "\t{\n";
+
+	for(const auto& field : fields)
+	{
+		if(!field.value.empty())
+			emitter << "\t\t" << field.value << ",\n";
+		else
+			emitter << "\t\t" << (field.extents.empty() ? "0" : "{0}") << ",\n";
+	}
+
+	emitter
+	<< "\t\t{0},\n"
+	<< "\t\t" << (initial_solutions.empty() ? "{0}" : initialSolutionsCode()) << "\n"
+	<< "\t};\n\n"
+	<< "\t*state = initial;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline void " << model_name << "_resetState(" << model_name << "_State* state)\n"
+	<< "{\n"
+	<< "\t" << model_name << "_initState(state);\n"
+	<< "}\n\n";
+
+	if(!stateStructEnabled())
+	{
+		emitter
+		<< "inline " << model_name << "_State* " << model_name << "_getState()\n"
+		<< "{\n"
+		<< "\tstatic " << model_name << "_State state;\n"
+		<< "\tstatic const bool initialized = (" << model_name << "_initState(&state), true);\n"
+		<< "\t(void)initialized;\n"
+		<< "\treturn &state;\n"
+		<< "}\n\n";
+	}
+}
+
+std::string SimulationEngineGenerator::initialSolutionsCode() const
+{
+	std::stringstream sstrm;
+	sstrm << std::setprecision(16) << std::scientific;
+
+	sstrm << "{" << 0.0;
+
+	for(unsigned int i = 0; i < num_solutions; i++)
+	{
+		sstrm << ", " << (i < initial_solutions.size() ? initial_solutions[i] : 0.0);
+	}
+
+	sstrm << "}";
+
+	return sstrm.str();
+}
+
+void SimulationEngineGenerator::emitCheckpointDefinitions(codegen::CodeEmitter& emitter) const
+{
+	std::vector<FieldDeclaration> fields;
+	for(const auto& i : engineFieldsCode())
+	{
+		std::vector<FieldDeclaration> comp = parseFieldsCode(i);
+		fields.insert(fields.end(), comp.begin(), comp.end());
+	}
+
+	// snapshots of a model with a different state layout or real type are rejected on restore
+	std::ostringstream layout;
+	layout << model_name << " lanes " << parameters.batch_lanes << " real ";
+	if(parameters.fixed_point_enable)
+	{
+		layout << (parameters.xilinx_hls_enable ? "ap_fixed " : "lblmc_fixed ") << parameters.fixed_point_word_width << " "
+		       << parameters.fixed_point_int_width << (parameters.fixed_point_saturation_enable ? " sat" : " wrap");
+	}
+	else
+	{
+		layout << "double";
+	}
+
+	std::uint64_t layout_hash = hashBytes(layout.str());
+
+	std::vector<std::string> members;
+	for(const auto& field : fields)
+	{
+		layout_hash = hashBytes(field.type + " " + field.name + field.extents, layout_hash);
+		members.push_back(field.name);
+	}
+
+	layout_hash = hashBytes("real b[" + std::to_string(num_solutions) + "]", layout_hash);
+	layout_hash = hashBytes("real x[" + std::to_string(num_solutions+1) + "]", layout_hash);
+	members.push_back("b");
+	members.push_back("x");
+
+	const std::string state = model_name + "_State";
+
+	emitter << "//STATE CHECKPOINTS\n\n";
+
+	emitter
+	<< "#ifndef __SYNTHESIS__\n"
+	<< "#include <cstddef>\n"
+	<< "#include <cstdint>\n"
+	<< "#include <cstdio>\n"
+	<< "#include <cstring>\n"
+	<< "#include <vector>\n\n";
+
+	emitter
+	<< "const static std::uint32_t " << model_name << "_checkpoint_version = 1;\n"
+	<< "const static std::uint64_t " << model_name << "_checkpoint_layout = 0x" << std::hex << layout_hash << std::dec << "ULL;\n"
+	<< "const static std::size_t " << model_name << "_checkpoint_size = 24";
+
+	for(const auto& member : members)
+	{
+		emitter << "\n\t+ sizeof(" << state << "::" << member << ")";
+	}
+	emitter << ";\n\n";
+
+	emitter
+	<< "inline std::size_t " << model_name << "_saveState(const " << state << "* state, unsigned char* buffer, std::size_t size)\n"
+	<< "{\n"
+	<< "\tif(size < " << model_name << "_checkpoint_size) return 0;\n\n"
+	<< "\tconst std::uint64_t layout = " << model_name << "_checkpoint_layout;\n"
+	<< "\tconst std::uint64_t payload = " << model_name << "_checkpoint_size - 24;\n\n"
+	<< "\tstd::memcpy(buffer, \"LBCK\", 4);\n"
+	<< "\tstd::memcpy(buffer + 4, &" << model_name << "_checkpoint_version, 4);\n"
+	<< "\tstd::memcpy(buffer + 8, &layout, 8);\n"
+	<< "\tstd::memcpy(buffer + 16, &payload, 8);\n\n"
+	<< "\tunsigned char* data = buffer + 24;\n";
+
+	for(const auto& member : members)
+	{
+		emitter << "\tstd::memcpy(data, &state->" << member << ", sizeof(state->" << member << ")); data += sizeof(state->" << member << ");\n";
+	}
+
+	emitter
+	<< "\n"
+	<< "\treturn " << model_name << "_checkpoint_size;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline bool " << model_name << "_restoreState(" << state << "* state, const unsigned char* buffer, std::size_t size)\n"
+	<< "{\n"
+	<< "\tif(size != " << model_name << "_checkpoint_size || std::memcmp(buffer, \"LBCK\", 4) != 0) return false;\n\n"
+	<< "\tstd::uint32_t version;\n"
+	<< "\tstd::uint64_t layout;\n"
+	<< "\tstd::uint64_t payload;\n"
+	<< "\tstd::memcpy(&version, buffer + 4, 4);\n"
+	<< "\tstd::memcpy(&layout, buffer + 8, 8);\n"
+	<< "\tstd::memcpy(&payload, buffer + 16, 8);\n\n"
+	<< "\tif(version != " << model_name << "_checkpoint_version || layout != " << model_name << "_checkpoint_layout || payload != size - 24) return false;\n\n"
+	<< "\tconst unsigned char* data = buffer + 24;\n";
+
+	for(const auto& member : members)
+	{
+		emitter << "\tstd::memcpy(&state->" << member << ", data, sizeof(state->" << member << ")); data += sizeof(state->" << member << ");\n";
+	}
+
+	emitter
+	<< "\n"
+	<< "\treturn true;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline bool " << model_name << "_saveStateFile(const " << state << "* state, const char* filename)\n"
+	<< "{\n"
+	<< "\tstd::vector<unsigned char> buffer(" << model_name << "_checkpoint_size);\n"
+	<< "\t" << model_name << "_saveState(state, buffer.data(), buffer.size());\n\n"
+	<< "\tstd::FILE* file = std::fopen(filename, \"wb\");\n"
+	<< "\tif(file == 0) return false;\n\n"
+	<< "\tbool saved = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();\n"
+	<< "\tsaved = (std::fclose(file) == 0) && saved;\n"
+	<< "\treturn saved;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline bool " << model_name << "_loadStateFile(" << state << "* state, const char* filename)\n"
+	<< "{\n"
+	<< "\tstd::FILE* file = std::fopen(filename, \"rb\");\n"
+	<< "\tif(file == 0) return false;\n\n"
+	<< "\tstd::vector<unsigned char> buffer(" << model_name << "_checkpoint_size);\n"
+	<< "\tbool loaded = std::fread(buffer.data(), 1, buffer.size(), file) == buffer.size() && std::fgetc(file) == EOF;\n"
+	<< "\tstd::fclose(file);\n\n"
+	<< "\treturn loaded && " << model_name << "_restoreState(state, buffer.data(), buffer.size());\n"
+	<< "}\n"
+	<< "#endif\n\n";
+}
+
+std::vector<SimulationEngineGenerator::ParameterDeclaration> SimulationEngineGenerator::parseParameterList(const std::string& parameter_list)
+{
+	std::vector<ParameterDeclaration> params;
+
+	std::string::size_type begin = 0;
+	int depth = 0;
+
+	for(std::string::size_type i = 0; i <= parameter_list.size(); i++)
+	{
+		char c = (i < parameter_list.size()) ? parameter_list[i] : ',';
+
+		if(c == '<' || c == '(' || c == '[') depth++;
+		else if(c == '>' || c == ')' || c == ']') depth--;
+		else if(c == ',' && depth == 0)
+		{
+			std::string param = parameter_list.substr(begin, i-begin);
+			begin = i+1;
+
+			ParameterDeclaration decl;
+
+			std::string::size_type end = param.find('[');
+			if(end == std::string::npos) end = param.size();
+			else decl.extents = param.substr(end, param.find_last_of(']')-end+1);
+
+			while(end > 0 && std::isspace(param[end-1])) end--;
+
+			std::string::size_type start = end;
+			while(start > 0 && (std::isalnum(param[start-1]) || param[start-1] == '_')) start--;
+
+			if(start == end)
+				throw std::runtime_error("SimulationEngineGenerator::parseParameterList(): parameter without name in parameter list");
+
+			decl.name = param.substr(start, end-start);
+
+			std::string::size_type type_begin = param.find_first_not_of(" \t\r\n");
+			std::string::size_type type_end = start;
+			while(type_end > type_begin && std::isspace(param[type_end-1])) type_end--;
+			decl.type = param.substr(type_begin, type_end-type_begin);
+
+			params.push_back(decl);
+		}
+	}
+
+	return params;
+}
+
+std::vector<std::string> SimulationEngineGenerator::parseParameterNames(const std::string& parameter_list)
+{
+	std::vector<std::string> names;
+
+	for(const auto& param : parseParameterList(parameter_list))
+	{
+		names.push_back(param.name);
+	}
+
+	return names;
+}
+
+std::vector<SimulationEngineGenerator::ParameterDeclaration> SimulationEngineGenerator::parseInputs() const
+{
+	std::vector<ParameterDeclaration> inputs;
+
+	for(const auto& i : comp_inputs)
+	{
+		std::vector<ParameterDeclaration> comp = parseParameterList(i);
+		inputs.insert(inputs.end(), comp.begin(), comp.end());
+	}
+
+	return inputs;
+}
+
+std::vector<SimulationEngineGenerator::ParameterDeclaration> SimulationEngineGenerator::parseOutputs() const
+{
+	std::vector<ParameterDeclaration> outputs;
+
+	if(!parameters.io_signal_output_enable) return outputs;
+
+	for(const auto& i : comp_outputs)
+	{
+		std::vector<ParameterDeclaration> comp = parseParameterList(i);
+		outputs.insert(outputs.end(), comp.begin(), comp.end());
+	}
+
+	return outputs;
+}
+
+std::vector<SimulationEngineGenerator::ParameterDeclaration> SimulationEngineGenerator::parseSignals() const
+{
+	std::vector<ParameterDeclaration> signals = parseOutputs();
+	std::vector<ParameterDeclaration> inputs = parseInputs();
+
+	signals.insert(signals.end(), inputs.begin(), inputs.end());
+
+	return signals;
+}
+
+std::string SimulationEngineGenerator::signalValueType(const ParameterDeclaration& signal)
+{
+	std::string type = signal.type;
+	if(signal.extents.empty()) type.erase(type.find_last_not_of(" \t*&")+1);
+	return type;
+}
+
+unsigned int SimulationEngineGenerator::signalSize(const ParameterDeclaration& signal)
+{
+	unsigned int size = 1;
+
+	for(std::string::size_type open = signal.extents.find('['); open != std::string::npos; open = signal.extents.find('[', open+1))
+	{
+		size *= std::stoul(signal.extents.substr(open+1));
+	}
+
+	return size;
+}
+
+void SimulationEngineGenerator::emitFlatEngineFunction(codegen::CodeEmitter& emitter) const
+{
+	const unsigned int lanes = parameters.batch_lanes;
+	const bool batched = lanes > 1;
+	const bool io_struct = parameters.io_struct_abi_enable;
+
+	std::vector<ParameterDeclaration> inputs = parseInputs();
+	std::vector<ParameterDeclaration> outputs = parseOutputs();
+
+	// pointer inputs have no known size to unpack
+	for(const auto& input : inputs)
+	{
+		if(input.extents.empty() && input.type.back() == '*') return;
+	}
+
+	emitter << "extern \"C\" const char " << model_name << "_signalLayout[] =\n";
+	for(const auto& input : inputs)
+	{
+		emitter << "\"in " << input.name << " " << signalSize(input) << "\\n\"\n";
+	}
+	for(const auto& output : outputs)
+	{
+		emitter << "\"out " << output.name << " " << signalSize(output) << "\\n\"\n";
+	}
+	emitter << "\"\";\n\n";
+
+	if(batched) emitter << "#include <limits>\n\n";
+
+	emitter
+	<< "extern \"C\" void " << model_name << "_simulationEngineFlat(double* x_out, const double* inputs, double* outputs)\n"
+	<< "{\n";
+
+	if(stateStructEnabled())
+	{
+		emitter
+		<< "\tstatic " << model_name << "_State state;\n"
+		<< "\tstatic bool state_initialized = false;\n"
+		<< "\tif(!state_initialized) { " << model_name << "_initState(&state); state_initialized = true; }\n\n";
+	}
+
+	if(parameters.runtime_parameters_enable)
+	{
+		emitter
+		<< "\tstatic " << model_name << "_Parameters params;\n"
+		<< "\tstatic bool params_initialized = false;\n"
+		<< "\tif(!params_initialized) { " << model_name << "_initParameters(&params); params_initialized = true; }\n\n";
+	}
+
+	// the struct I/O blocks persist, as in place solutions live in the output block
+	if(io_struct)
+	{
+		emitter
+		<< "\tstatic " << model_name << "_Inputs in;\n"
+		<< "\tstatic " << model_name << "_Outputs out;\n\n";
+	}
+
+	unsigned int offset = 0;
+	for(const auto& input : inputs)
+	{
+		const std::string type = signalValueType(input);
+
+		// every lane of a batched engine is given the same inputs
+		if(batched)
+		{
+			emitter
+			<< "\t" << type << " " << input.name << "_lanes[" << lanes << "]" << input.extents << ";\n"
+			<< "\tfor(unsigned int lane = 0; lane < " << lanes << "; lane++)\n"
+			<< "\t\tfor(unsigned int i = 0; i < " << signalSize(input) << "; i++) reinterpret_cast<" << type << "*>(&" << input.name << "_lanes[lane])[i] = static_cast<" << type << ">(inputs[" << offset << "+i]);\n";
+		}
+		else if(io_struct)
+		{
+			emitter << "\tfor(unsigned int i = 0; i < " << signalSize(input) << "; i++) reinterpret_cast<" << type << "*>(&in." << input.name << ")[i] = static_cast<" << type << ">(inputs[" << offset << "+i]);\n";
+		}
+		else if(input.extents.empty())
+		{
+			emitter << "\t" << type << " " << input.name << " = static_cast<" << type << ">(inputs[" << offset << "]);\n";
+		}
+		else
+		{
+			emitter
+			<< "\t" << type << " " << input.name << input.extents << ";\n"
+			<< "\tfor(unsigned int i = 0; i < " << signalSize(input) << "; i++) reinterpret_cast<" << type << "*>(&" << input.name << ")[i] = static_cast<" << type << ">(inputs[" << offset << "+i]);\n";
+		}
+
+		offset += signalSize(input);
+	}
+
+	if(!io_struct)
+	{
+		for(const auto& output : outputs)
+		{
+			emitter << "\t" << signalValueType(output) << " " << output.name << (batched ? "_lanes[" + std::to_string(lanes) + "]" : "") << output.extents << ";\n";
+		}
+
+		emitter << "\treal x[" << num_solutions << "]" << (batched ? "[" + std::to_string(lanes) + "]" : "") << ";\n";
+	}
+	emitter << "\n";
+
+	emitter << "\t" << model_name << "_simulationEngine(";
+	if(stateStructEnabled()) emitter << "&state, ";
+	if(parameters.runtime_parameters_enable) emitter << "&params, ";
+
+	if(io_struct)
+	{
+		emitter << "&in, &out";
+	}
+	else
+	{
+		emitter << "x";
+
+		for(const auto& signal : parseSignals())
+		{
+			if(batched)
+				emitter << ", " << signal.name << "_lanes";
+			else
+				emitter << ", " << (signal.extents.empty() && signal.type.back() == '*' ? "&" : "") << signal.name;
+		}
+	}
+	emitter << ");\n\n";
+
+	if(batched)
+	{
+		// lanes given the same inputs must agree; a solution on which they do not is reported as NaN
+		emitter
+		<< "\tfor(unsigned int i = 0; i < " << num_solutions << "; i++)\n"
+		<< "\t{\n"
+		<< "\t\tx_out[i] = static_cast<double>(x[i][0]);\n"
+		<< "\t\tfor(unsigned int lane = 1; lane < " << lanes << "; lane++)\n"
+		<< "\t\t\tif(static_cast<double>(x[i][lane]) != x_out[i]) x_out[i] = std::numeric_limits<double>::quiet_NaN();\n"
+		<< "\t}\n";
+	}
+	else if(io_struct && parameters.io_struct_solutions_in_place)
+	{
+		emitter << "\tfor(unsigned int i = 0; i < " << num_solutions << "; i++) x_out[i] = static_cast<double>(out.x[i+1]);\n";
+	}
+	else
+	{
+		emitter << "\tfor(unsigned int i = 0; i < " << num_solutions << "; i++) x_out[i] = static_cast<double>(" << (io_struct ? "out.x_out" : "x") << "[i]);\n";
+	}
+
+	offset = 0;
+	for(const auto& output : outputs)
+	{
+		const std::string type = signalValueType(output);
+		const std::string signal = batched ? output.name + "_lanes[0]" : (io_struct ? "out." : "") + output.name;
+
+		emitter << "\tfor(unsigned int i = 0; i < " << signalSize(output) << "; i++) outputs[" << offset << "+i] = static_cast<double>(reinterpret_cast<const " << type << "*>(&" << signal << ")[i]);\n";
+
+		offset += signalSize(output);
+	}
+
+	emitter
+	<< "}\n\n"
+	<< "extern \"C\"\n{\n"
+	<< "decltype(&" << model_name << "_simulationEngineFlat) " << model_name << "_simulationEngineFlat_symbol = &" << model_name << "_simulationEngineFlat;\n"
+	<< "}\n";
+}
+
+unsigned int SimulationEngineGenerator::streamElementBytes(const std::string& value_type) const
+{
+	if(value_type == "bool") return 1;
+
+	if(value_type == "real")
+		return parameters.fixed_point_enable ? (parameters.fixed_point_word_width+7)/8 : 8;
+
+	throw std::runtime_error("SimulationEngineGenerator::streamElementBytes(): signals of type " + value_type + " cannot be packed into stream words");
+}
+
+std::vector<SimulationEngineGenerator::StreamField> SimulationEngineGenerator::layoutStreamWord
+(
+	const std::vector<ParameterDeclaration>& signals,
+	bool solutions,
+	unsigned int& word_bytes
+) const
+{
+	std::vector<StreamField> fields;
+
+	word_bytes = 0;
+
+	if(solutions)
+	{
+		fields.push_back(StreamField{"x_out", "real", num_solutions, word_bytes});
+		word_bytes += num_solutions*streamElementBytes("real");
+	}
+
+	for(const auto& signal : signals)
+	{
+		StreamField field{signal.name, signalValueType(signal), signalSize(signal), word_bytes};
+
+		word_bytes += field.size*streamElementBytes(field.value_type);
+		fields.push_back(field);
+	}
+
+	return fields;
+}
+
+void SimulationEngineGenerator::emitStreamLayout(codegen::CodeEmitter& emitter) const
+{
+	std::vector<ParameterDeclaration> inputs = parseInputs();
+
+	for(const auto& input : inputs)
+	{
+		if(input.extents.empty() && input.type.back() == '*')
+			throw std::runtime_error("SimulationEngineGenerator::emitStreamLayout(): pointer input " + input.name + " has no known size to pack into stream words");
+	}
+
+	unsigned int input_bytes;
+	unsigned int output_bytes;
+
+	std::vector<StreamField> input_fields = layoutStreamWord(inputs, false, input_bytes);
+	std::vector<StreamField> output_fields = layoutStreamWord(parseOutputs(), true, output_bytes);
+
+	emitter
+	<< "#ifndef " << model_name << "_STREAMLAYOUT_HPP\n"
+	<< "#define " << model_name << "_STREAMLAYOUT_HPP\n\n";
+
+	emitter << "//STREAM WORD LAYOUT\n\n";
+
+	emitter
+	<< "const static unsigned int " << model_name << "_real_bytes = " << streamElementBytes("real") << ";\n"
+	<< "const static bool " << model_name << "_real_fixed_point = " << (parameters.fixed_point_enable ? "true" : "false") << ";\n"
+	<< "const static unsigned int " << model_name << "_real_fraction_bits = "
+	<< (parameters.fixed_point_enable ? parameters.fixed_point_word_width-parameters.fixed_point_int_width : 0) << ";\n\n";
+
+	auto emit_word = [&](const char* word, const std::vector<StreamField>& fields, unsigned int bytes)
+	{
+		emitter << "const static unsigned int " << model_name << "_" << word << "_bytes = " << bytes << ";\n";
+
+		for(const auto& field : fields)
+		{
+			emitter
+			<< "const static unsigned int " << model_name << "_" << word << "_" << field.name << "_offset = " << field.offset << ";\n"
+			<< "const static unsigned int " << model_name << "_" << word << "_" << field.name << "_size = " << field.size << ";\n";
+		}
+
+		emitter << "\n";
+	};
+
+	emit_word("InputWord", input_fields, input_bytes);
+	emit_word("OutputWord", output_fields, output_bytes);
+
+	emitter << "#endif // " << model_name << "_STREAMLAYOUT_HPP\n";
+}
+
+void SimulationEngineGenerator::emitStreamEngineFunction(codegen::CodeEmitter& emitter) const
+{
+	const bool axis = parameters.xilinx_hls_stream_interface == "axis";
+	const unsigned int real_bits = 8*streamElementBytes("real");
+
+	std::vector<ParameterDeclaration> inputs = parseInputs();
+	std::vector<ParameterDeclaration> outputs = parseOutputs();
+
+	unsigned int input_bytes;
+	unsigned int output_bytes;
+
+	std::vector<StreamField> input_fields = layoutStreamWord(inputs, false, input_bytes);
+	std::vector<StreamField> output_fields = layoutStreamWord(outputs, true, output_bytes);
+
+	// a word of zero bytes is not a valid stream element
+	input_bytes = std::max(1u, input_bytes);
+
+	emitStreamLayout(emitter);
+	emitter << "\n";
+
+	emitter << "#include <ap_int.h>\n#include <hls_stream.h>\n";
+	if(axis) emitter << "#include <ap_axi_sdata.h>\n";
+	emitter << "\n";
+
+	if(axis)
+	{
+		emitter
+		<< "typedef ap_axiu<" << 8*input_bytes << ",0,0,0> " << model_name << "_InputWord;\n"
+		<< "typedef ap_axiu<" << 8*output_bytes << ",0,0,0> " << model_name << "_OutputWord;\n\n";
+	}
+	else
+	{
+		emitter
+		<< "typedef ap_uint<" << 8*input_bytes << "> " << model_name << "_InputWord;\n"
+		<< "typedef ap_uint<" << 8*output_bytes << "> " << model_name << "_OutputWord;\n\n";
+	}
+
+	// conversions between real and its stream word bits
+	emitter << "inline real " << model_name << "_streamToReal(ap_uint<" << real_bits << "> bits)\n{\n";
+	if(parameters.fixed_point_enable)
+	{
+		const unsigned int w = parameters.fixed_point_word_width;
+
+		emitter
+		<< "\treal value;\n"
+		<< "\tvalue.range(" << w-1 << ", 0) = bits(" << w-1 << ", 0);\n"
+		<< "\treturn value;\n";
+	}
+	else
+	{
+		emitter
+		<< "\tunion { unsigned long long i; double d; } word;\n"
+		<< "\tword.i = bits.to_uint64();\n"
+		<< "\treturn word.d;\n";
+	}
+	emitter << "}\n\n";
+
+	emitter << "inline ap_uint<" << real_bits << "> " << model_name << "_realToStream(real value)\n{\n";
+	if(parameters.fixed_point_enable)
+	{
+		const unsigned int w = parameters.fixed_point_word_width;
+
+		emitter
+		<< "\tap_int<" << w << "> raw = value.range(" << w-1 << ", 0);\n"
+		<< "\tap_int<" << real_bits << "> extended = raw;\n"
+		<< "\treturn ap_uint<" << real_bits << ">(extended);\n";
+	}
+	else
+	{
+		emitter
+		<< "\tunion { unsigned long long i; double d; } word;\n"
+		<< "\tword.d = value;\n"
+		<< "\treturn ap_uint<" << real_bits << ">(word.i);\n";
+	}
+	emitter << "}\n\n";
+
+	emitter
+	<< "void " << model_name << "_simulationEngineStream\n"
+	<< "(\n";
+
+	if(parameters.runtime_parameters_enable) emitter << "const " << model_name << "_Parameters* params,\n";
+
+	emitter
+	<< "hls::stream<" << model_name << "_InputWord>& in_stream,\n"
+	<< "hls::stream<" << model_name << "_OutputWord>& out_stream\n"
+	<< ")\n"
+	<< "{\n"
+	<< "#pragma HLS INTERFACE " << parameters.xilinx_hls_stream_interface << " port=in_stream\n"
+	<< "#pragma HLS INTERFACE " << parameters.xilinx_hls_stream_interface << " port=out_stream\n\n";
+
+	if(stateStructEnabled())
+	{
+		emitter
+		<< "static " << model_name << "_State state;\n"
+		<< "static bool state_initialized = false;\n"
+		<< "if(!state_initialized) { " << model_name << "_initState(&state); state_initialized = true; }\n\n";
+	}
+
+	emitter
+	<< "const ap_uint<" << 8*input_bytes << "> in_data = in_stream.read()" << (axis ? ".data" : "") << ";\n"
+	<< "ap_uint<" << 8*output_bytes << "> out_data = 0;\n\n";
+
+	// element i of a signal, subscripted in row-major order
+	auto element = [](const ParameterDeclaration& signal, unsigned int i)
+	{
+		std::vector<unsigned int> extents;
+		for(std::string::size_type open = signal.extents.find('['); open != std::string::npos; open = signal.extents.find('[', open+1))
+			extents.push_back(std::stoul(signal.extents.substr(open+1)));
+
+		std::string subscripts;
+		for(auto extent = extents.rbegin(); extent != extents.rend(); extent++)
+		{
+			subscripts = "[" + std::to_string(i % *extent) + "]" + subscripts;
+			i /= *extent;
+		}
+
+		return signal.name + subscripts;
+	};
+
+	auto bit_range = [](unsigned int byte_offset, unsigned int bytes)
+	{
+		return "(" + std::to_string(8*(byte_offset+bytes)-1) + ", " + std::to_string(8*byte_offset) + ")";
+	};
+
+	emitter << "//UNPACK INPUT WORD\n\n";
+
+	for(unsigned int k = 0; k < inputs.size(); k++)
+	{
+		const StreamField& field = input_fields[k];
+		const unsigned int bytes = streamElementBytes(field.value_type);
+
+		emitter << field.value_type << " " << inputs[k].name << inputs[k].extents << ";\n";
+
+		for(unsigned int i = 0; i < field.size; i++)
+		{
+			const std::string bits = "in_data" + bit_range(field.offset + i*bytes, bytes);
+
+			if(field.value_type == "bool")
+				emitter << element(inputs[k], i) << " = " << bits << " != 0;\n";
+			else
+				emitter << element(inputs[k], i) << " = " << model_name << "_streamToReal(" << bits << ");\n";
+		}
+	}
+	emitter << "\n";
+
+	for(const auto& output : outputs)
+	{
+		emitter << signalValueType(output) << " " << output.name << output.extents << ";\n";
+	}
+	emitter << "real x_out[" << num_solutions << "];\n\n";
+
+	emitter << model_name << "_simulationEngine(";
+	if(stateStructEnabled()) emitter << "&state, ";
+	if(parameters.runtime_parameters_enable) emitter << "params, ";
+	emitter << "x_out";
+
+	for(const auto& signal : parseSignals())
+	{
+		emitter << ", " << (signal.extents.empty() && signal.type.back() == '*' ? "&" : "") << signal.name;
+	}
+	emitter << ");\n\n";
+
+	emitter << "//PACK OUTPUT WORD\n\n";
+
+	for(unsigned int k = 0; k < output_fields.size(); k++)
+	{
+		const StreamField& field = output_fields[k];
+		const unsigned int bytes = streamElementBytes(field.value_type);
+
+		ParameterDeclaration signal = k == 0 ? ParameterDeclaration{"real", "x_out", "[" + std::to_string(num_solutions) + "]"} : outputs[k-1];
+
+		for(unsigned int i = 0; i < field.size; i++)
+		{
+			const std::string bits = "out_data" + bit_range(field.offset + i*bytes, bytes);
+
+			if(field.value_type == "bool")
+				emitter << bits << " = " << element(signal, i) << " ? 1 : 0;\n";
+			else
+				emitter << bits << " = " << model_name << "_realToStream(" << element(signal, i) << ");\n";
+		}
+	}
+	emitter << "\n";
+
+	if(axis)
+	{
+		emitter
+		<< model_name << "_OutputWord out_word;\n"
+		<< "out_word.data = out_data;\n"
+		<< "out_word.keep = -1;\n"
+		<< "out_word.strb = -1;\n"
+		<< "out_word.last = 1;\n"
+		<< "out_stream.write(out_word);\n";
+	}
+	else
+	{
+		emitter << "out_stream.write(out_data);\n";
+	}
+
+	emitter << "}\n";
+}
+
+void SimulationEngineGenerator::generateStreamLayoutAndExport(std::string filename) const
+{
+	if(filename == "")
+		throw std::invalid_argument("SimulationEngineGenerator::generateStreamLayoutAndExport(): filename cannot be null or empty");
+
+	codegen::CodeEmitter file(filename);
+
+	emitFileBanner(file);
+	emitStreamLayout(file);
+
+	file.close();
+}
+
+void SimulationEngineGenerator::emitBatchedCFunctionParameterList(codegen::CodeEmitter& emitter) const
+{
+	const unsigned int lanes = parameters.batch_lanes;
+
+	emitter << "real x_out["<<num_solutions<<"]["<<lanes<<"]";
+
+	for(const auto& signal : parseSignals())
+	{
+		char kind = signal.type.back();
+
+		emitter << ",\n";
+
+		if(!signal.extents.empty())
+			emitter << signal.type << " " << signal.name << "_lanes[" << lanes << "]" << signal.extents;
+		else if(kind == '*' || kind == '&')
+			emitter << signalValueType(signal) << " " << signal.name << "_lanes[" << lanes << "]";
+		else
+			emitter << "const " << signal.type << " " << signal.name << "_lanes[" << lanes << "]";
+	}
+}
+
+void SimulationEngineGenerator::emitLaneLoopBegin(codegen::CodeEmitter& emitter, bool bind_components) const
+{
+	emitter
+	<< "#pragma omp simd\n"
+	<< "for(unsigned int lane = 0; lane < " << parameters.batch_lanes << "; lane++)\n"
+	<< "{\n"
+	<< "const " << model_name << "_Lane b = { state->b, lane };\n"
+	<< "const " << model_name << "_Lane x = { state->x, lane };\n"
+	<< "const " << model_name << "_Lane b_components = { b_components_lanes, lane };\n";
+
+	if(!bind_components) return;
+
+	for(const auto& i : engineFieldsCode())
+	{
+		for(const auto& field : parseFieldsCode(i))
+		{
+			emitter << field.type << "& " << field.name << " = state->" << field.name << "[lane];\n";
+		}
+	}
+
+	for(const auto& signal : parseSignals())
+	{
+		char kind = signal.type.back();
+
+		if(!signal.extents.empty())
+			emitter << signal.type << " (&" << signal.name << ")" << signal.extents << " = " << signal.name << "_lanes[lane];\n";
+		else if(kind == '*')
+			emitter << signal.type << " " << signal.name << " = &" << signal.name << "_lanes[lane];\n";
+		else if(kind == '&')
+			emitter << signal.type << " " << signal.name << " = " << signal.name << "_lanes[lane];\n";
+		else
+			emitter << "const " << signal.type << " " << signal.name << " = " << signal.name << "_lanes[lane];\n";
+	}
+}
+
+void SimulationEngineGenerator::emitBatchedCInlineCode(codegen::CodeEmitter& emitter, double zero_bound) const
+{
+	updateCache(zero_bound);
+
+	SystemSolverGenerator& solver_gen = *cache.solver_gen;
+
+	unsigned int num_components = source_vector_gen.getNumSources();
+
+	int rescale_exponent = computeInvConductanceRescaleExponent(*cache.invg_gen, zero_bound);
+	solver_gen.setRescale(rescale_exponent, parameters.fixed_point_enable);
+	solver_gen.setFolding(0);
+
+	emitter << "//MODEL PARAMETERS\n\n";
+
+	emitModelParameters(emitter);
+
+	emitter << "//MODEL SOLUTIONS\n\n";
+
+	emitter << "real b_components_lanes["<<num_components<<"]["<<parameters.batch_lanes<<"];\n\n";
+
+	emitter << "//INVERTED CONDUCTANCE MATRIX\n\n";
+
+	emitInvConductance(emitter, rescale_exponent);
+	emitter << "\n\n";
+
+	emitter << "//COMPONENT SOURCE CONTRIBUTION UPDATES\n\n";
+
+	emitLaneLoopBegin(emitter, true);
+	emitter << "\n";
+
+	emitTimedUpdateBodies(emitter, comp_update_bodies, "components", "component_updates", true);
+
+	if(parameters.io_signal_output_enable)
+	{
+		emitter << "\n//MODEL OUTPUT SIGNAL UPDATES\n\n";
+
+		for(const auto& i : comp_outputs_update_bodies)
+		{
+			emitUpdateBody(emitter, i);
+		}
+	}
+	emitter << "}\n\n";
+
+	emitter << "//AGGREGRATE COMPONENT SOURCE CONTRIBUTIONS\n\n";
+
+	emitLaneLoopBegin(emitter, false);
+	emitter << "\n" << cache.aggregation_code << "\n}\n\n";
+
+	emitter << "//MODEL UPDATE SOLUTIONS\n\n";
+
+	emitLaneLoopBegin(emitter, false);
+	emitter << "\n";
+	solver_gen.writeCInlineCode(emitter.stream(), "inv_g");
+	emitter << "}\n\n";
+}
+
+void SimulationEngineGenerator::checkParameters() const
+{
+	if(parameters.io_struct_abi_enable && parameters.batch_lanes > 1)
+		throw std::runtime_error("SimulationEngineGenerator::checkParameters(): struct I/O ABI is not supported by batched engines");
+
+	if(parameters.multi_step_enable && (parameters.batch_lanes > 1 || parameters.io_struct_abi_enable))
+		throw std::runtime_error("SimulationEngineGenerator::checkParameters(): multi-step engines are not supported by batched engines or the struct I/O ABI");
+
+	if(parameters.multi_step_enable && parameters.multi_step_output_decimation == 0)
+		throw std::runtime_error("SimulationEngineGenerator::checkParameters(): multi_step_output_decimation must be positive nonzero value");
+
+	if(parameters.io_struct_abi_enable && parameters.io_struct_solutions_in_place && stateBindingEnabled())
+		throw std::runtime_error("SimulationEngineGenerator::checkParameters(): in place solutions are not supported by reentrant or checkpointed engines; the solutions are in the engine state");
+
+	if(!initial_solutions.empty() && parameters.io_struct_abi_enable && parameters.io_struct_solutions_in_place)
+		throw std::runtime_error("SimulationEngineGenerator::checkParameters(): initial solutions are not supported by in place solutions; the solutions are owned by the caller");
+
+	if(globalStateEnabled() && parameters.xilinx_hls_enable)
+		throw std::runtime_error("SimulationEngineGenerator::checkParameters(): checkpointed and multi-step Xilinx HLS engines must be reentrant; the global state of non-reentrant engines is not synthesizable");
+
+	if(!parameters.xilinx_hls_stream_interface.empty())
+	{
+		if(parameters.xilinx_hls_stream_interface != "axis" && parameters.xilinx_hls_stream_interface != "ap_fifo")
+			throw std::runtime_error("SimulationEngineGenerator::checkParameters(): xilinx_hls_stream_interface must be axis, ap_fifo, or empty");
+
+		if(!parameters.xilinx_hls_enable || parameters.batch_lanes > 1 || parameters.io_struct_abi_enable)
+			throw std::runtime_error("SimulationEngineGenerator::checkParameters(): stream interfaces require Xilinx HLS and are not supported by batched engines or the struct I/O ABI");
+	}
+
+	if(parameters.xilinx_hls_solver_lanes != 0 && parameters.runtime_parameters_enable)
+		throw std::runtime_error("SimulationEngineGenerator::checkParameters(): folded solvers are not supported by runtime parameterized engines; the coefficient ROMs are literals");
+
+	if(parameters.instrumentation_enable)
+	{
+		if(parameters.instrumentation_clock != "clock_gettime" && parameters.instrumentation_clock != "tsc")
+			throw std::runtime_error("SimulationEngineGenerator::checkParameters(): instrumentation_clock must be clock_gettime or tsc");
+
+		if(parameters.instrumentation_histogram_buckets == 0 || parameters.instrumentation_histogram_buckets > 64)
+			throw std::runtime_error("SimulationEngineGenerator::checkParameters(): instrumentation_histogram_buckets must be from 1 to 64");
+
+		if(parameters.xilinx_hls_enable || parameters.batch_lanes > 1)
+			throw std::runtime_error("SimulationEngineGenerator::checkParameters(): instrumentation is not supported by Xilinx HLS or batched engines");
+	}
+}
+
+void SimulationEngineGenerator::emitIODefinitions(codegen::CodeEmitter& emitter) const
+{
+	std::vector<ParameterDeclaration> inputs = parseInputs();
+
+	std::vector<ParameterDeclaration> outputs = parseOutputs();
+
+	std::string alignment;
+	if(parameters.io_struct_alignment != 0)
+		alignment = "alignas(" + std::to_string(parameters.io_struct_alignment) + ") ";
+
+	emitter << "#include <cstddef>\n\n";
+
+	emitter << "struct " << alignment << model_name << "_Inputs\n{\n";
+
+	for(const auto& input : inputs)
+	{
+		emitter << "\t" << input.type << " " << input.name << input.extents << ";\n";
+	}
+
+	emitter << "};\n\n";
+
+	emitter << "struct " << alignment << model_name << "_Outputs\n{\n";
+
+	if(parameters.io_struct_solutions_in_place)
+		emitter << "\treal x["<<num_solutions+1<<"];\n";
+	else
+		emitter << "\treal x_out["<<num_solutions<<"];\n";
+
+	for(const auto& output : outputs)
+	{
+		emitter << "\t" << signalValueType(output) << " " << output.name << output.extents << ";\n";
+	}
+
+	emitter << "};\n\n";
+
+	emitter << "//I/O BLOCK LAYOUT\n\n";
+
+	const std::string in_block = model_name + "_Inputs";
+	const std::string out_block = model_name + "_Outputs";
+
+	emitter << "const static unsigned int " << in_block << "_size = sizeof(" << in_block << ");\n";
+
+	for(const auto& input : inputs)
+	{
+		emitter << "const static unsigned int " << in_block << "_" << input.name << "_offset = offsetof(" << in_block << ", " << input.name << ");\n";
+	}
+
+	emitter << "\nconst static unsigned int " << out_block << "_size = sizeof(" << out_block << ");\n";
+
+	const char* solutions = parameters.io_struct_solutions_in_place ? "x" : "x_out";
+	emitter << "const static unsigned int " << out_block << "_" << solutions << "_offset = offsetof(" << out_block << ", " << solutions << ");\n";
+
+	for(const auto& output : outputs)
+	{
+		emitter << "const static unsigned int " << out_block << "_" << output.name << "_offset = offsetof(" << out_block << ", " << output.name << ");\n";
+	}
+
+	emitter << "\n";
+}
+
+void SimulationEngineGenerator::emitIOBindings(codegen::CodeEmitter& emitter) const
+{
+	for(const auto& i : comp_inputs)
+	{
+		for(const auto& input : parseParameterList(i))
+		{
+			if(!input.extents.empty())
+				emitter << "const " << input.type << " (&" << input.name << ")" << input.extents << " = in->" << input.name << ";\n";
+			else
+				emitter << "const " << input.type << " " << input.name << " = in->" << input.name << ";\n";
+		}
+	}
+
+	if(!parameters.io_signal_output_enable) return;
+
+	for(const auto& i : comp_outputs)
+	{
+		for(const auto& output : parseParameterList(i))
+		{
+			char kind = output.type.back();
+
+			if(!output.extents.empty())
+				emitter << output.type << " (&" << output.name << ")" << output.extents << " = out->" << output.name << ";\n";
+			else if(kind == '*')
+				emitter << output.type << " " << output.name << " = &out->" << output.name << ";\n";
+			else
+				emitter << output.type << " " << output.name << " = out->" << output.name << ";\n";
+		}
+	}
+}
+
+void SimulationEngineGenerator::emitTimingDefinitions(codegen::CodeEmitter& emitter) const
+{
+	const std::string section = model_name + "_SectionTiming";
+	const std::string timing = model_name + "_Timing";
+	const unsigned int buckets = parameters.instrumentation_histogram_buckets;
+	const bool tsc = (parameters.instrumentation_clock == "tsc");
+
+	const unsigned int num_updates = parameters.instrumentation_per_component ? comp_update_bodies.size() : 0;
+	const unsigned int num_output_updates = (parameters.instrumentation_per_component && parameters.io_signal_output_enable) ? comp_outputs_update_bodies.size() : 0;
+
+	emitter << "//SECTION TIMING INSTRUMENTATION\n\n";
+
+	emitter << "#include <atomic>\n";
+	emitter << "#include <cstdio>\n";
+	emitter << (tsc ? "#include <x86intrin.h>\n\n" : "#include <time.h>\n\n");
+
+	emitter
+	<< "struct " << section << "\n"
+	<< "{\n"
+	<< "\tunsigned long long samples;\n"
+	<< "\tunsigned long long min;\n"
+	<< "\tunsigned long long max;\n"
+	<< "\tunsigned long long total;\n"
+	<< "\tunsigned long long histogram[" << buckets << "];\n"
+	<< "};\n\n";
+
+	emitter
+	<< "struct " << timing << "\n"
+	<< "{\n"
+	<< "\t" << section << " step;\n"
+	<< "\t" << section << " components;\n"
+	<< "\t" << section << " outputs;\n"
+	<< "\t" << section << " aggregation;\n"
+	<< "\t" << section << " solve;\n";
+
+	if(num_updates != 0) emitter << "\t" << section << " component_updates[" << num_updates << "];\n";
+	if(num_output_updates != 0) emitter << "\t" << section << " component_output_updates[" << num_output_updates << "];\n";
+
+	emitter << "};\n\n";
+
+	emitter
+	<< "const static unsigned int " << timing << "_histogram_buckets = " << buckets << ";\n"
+	<< "const static char* const " << timing << "_unit = \"" << (tsc ? "ticks" : "ns") << "\";\n\n";
+
+	// reentrant engines may run on several threads at once, so each thread records its own counters
+	emitter
+	<< "inline " << timing << "& " << model_name << "_getTiming()\n"
+	<< "{\n"
+	<< "\tstatic " << (parameters.reentrant_engine_enable ? "thread_local " : "") << timing << " timing = " << timing << "();\n"
+	<< "\treturn timing;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline void " << model_name << "_resetTiming()\n"
+	<< "{\n"
+	<< "\t" << model_name << "_getTiming() = " << timing << "();\n"
+	<< "}\n\n";
+
+	// the signal fences keep the compiler from moving the timed code across the probe
+	emitter
+	<< "inline unsigned long long " << model_name << "_timingNow()\n"
+	<< "{\n"
+	<< "\tstd::atomic_signal_fence(std::memory_order_seq_cst);\n";
+
+	if(tsc)
+	{
+		emitter << "\tconst unsigned long long now = __rdtsc();\n";
+	}
+	else
+	{
+		emitter
+		<< "\ttimespec time;\n"
+		<< "\tclock_gettime(CLOCK_MONOTONIC, &time);\n"
+		<< "\tconst unsigned long long now = (unsigned long long)time.tv_sec*1000000000ULL + time.tv_nsec;\n";
+	}
+
+	emitter
+	<< "\tstd::atomic_signal_fence(std::memory_order_seq_cst);\n"
+	<< "\treturn now;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline void " << model_name << "_timingRecord(" << section << "& section, unsigned long long start)\n"
+	<< "{\n"
+	<< "\tconst unsigned long long elapsed = " << model_name << "_timingNow() - start;\n\n"
+	<< "\tif(section.samples == 0 || elapsed < section.min) section.min = elapsed;\n"
+	<< "\tif(elapsed > section.max) section.max = elapsed;\n"
+	<< "\tsection.total += elapsed;\n"
+	<< "\tsection.samples++;\n\n"
+	<< "\tunsigned int bucket = 0;\n"
+	<< "\twhile(bucket+1 < " << buckets << " && (elapsed >> (bucket+1)) != 0) bucket++;\n"
+	<< "\tsection.histogram[bucket]++;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline double " << model_name << "_timingMean(const " << section << "& section)\n"
+	<< "{\n"
+	<< "\treturn (section.samples == 0) ? 0.0 : (double)section.total/section.samples;\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline void " << model_name << "_writeSectionTiming(std::FILE* file, const char* name, const " << section << "& section)\n"
+	<< "{\n"
+	<< "\tstd::fprintf(file, \"%-32s %12llu %12llu %12llu %14.3f\\n\", name, section.samples, section.min, section.max, " << model_name << "_timingMean(section));\n\n"
+	<< "\tfor(unsigned int k = 0; k < " << buckets << "; k++)\n"
+	<< "\t{\n"
+	<< "\t\tif(section.histogram[k] != 0) std::fprintf(file, \"    >= 2^%-2u %12llu\\n\", k, section.histogram[k]);\n"
+	<< "\t}\n"
+	<< "}\n\n";
+
+	emitter
+	<< "inline void " << model_name << "_writeTiming(std::FILE* file)\n"
+	<< "{\n"
+	<< "\tconst " << timing << "& timing = " << model_name << "_getTiming();\n\n"
+	<< "\tstd::fprintf(file, \"%-32s %12s %12s %12s %14s  (%s)\\n\", \"section\", \"samples\", \"min\", \"max\", \"mean\", " << timing << "_unit);\n"
+	<< "\t" << model_name << "_writeSectionTiming(file, \"step\", timing.step);\n"
+	<< "\t" << model_name << "_writeSectionTiming(file, \"components\", timing.components);\n"
+	<< "\t" << model_name << "_writeSectionTiming(file, \"outputs\", timing.outputs);\n"
+	<< "\t" << model_name << "_writeSectionTiming(file, \"aggregation\", timing.aggregation);\n"
+	<< "\t" << model_name << "_writeSectionTiming(file, \"solve\", timing.solve);\n";
+
+	if(num_updates != 0 || num_output_updates != 0) emitter << "\n\tchar name[64];\n";
+
+	if(num_updates != 0)
+	{
+		emitter
+		<< "\n\tfor(unsigned int i = 0; i < " << num_updates << "; i++)\n"
+		<< "\t{\n"
+		<< "\t\tstd::snprintf(name, sizeof(name), \"component_updates[%u]\", i);\n"
+		<< "\t\t" << model_name << "_writeSectionTiming(file, name, timing.component_updates[i]);\n"
+		<< "\t}\n";
+	}
+
+	if(num_output_updates != 0)
+	{
+		emitter
+		<< "\n\tfor(unsigned int i = 0; i < " << num_output_updates << "; i++)\n"
+		<< "\t{\n"
+		<< "\t\tstd::snprintf(name, sizeof(name), \"component_output_updates[%u]\", i);\n"
+		<< "\t\t" << model_name << "_writeSectionTiming(file, name, timing.component_output_updates[i]);\n"
+		<< "\t}\n";
+	}
+
+	emitter << "}\n\n";
+}
+
+void SimulationEngineGenerator::emitTimingBegin(codegen::CodeEmitter& emitter, const std::string& probe) const
+{
+	if(!parameters.instrumentation_enable) return;
+
+	emitter << "const unsigned long long " << probe << " = " << model_name << "_timingNow();\n";
+}
+
+void SimulationEngineGenerator::emitTimingEnd(codegen::CodeEmitter& emitter, const std::string& probe, const std::string& counter) const
+{
+	if(!parameters.instrumentation_enable) return;
+
+	emitter << model_name << "_timingRecord(" << model_name << "_getTiming()." << counter << ", " << probe << ");\n";
+}
+
+void SimulationEngineGenerator::emitTimedUpdateBodies
+(
+	codegen::CodeEmitter& emitter,
+	const std::vector<std::string>& bodies,
+	const std::string& section,
+	const std::string& component_counter,
+	bool scheduled
+) const
+{
+	const bool per_component = parameters.instrumentation_enable && parameters.instrumentation_per_component;
+	const bool multi_rate = scheduled && multiRateEnabled();
+
+	std::vector<unsigned int> phases;
+	if(multi_rate) phases = planUpdatePhases();
+
+	emitTimingBegin(emitter, "timing_" + section);
+
+	for(unsigned int i = 0; i < bodies.size(); i++)
+	{
+		const std::string index = std::to_string(i);
+		const unsigned int rate = multi_rate ? comp_update_rates[i] : 1;
+
+		if(rate > 1)
+			emitter << "if(multirate_step < 0 || multirate_step % " << rate << " == " << phases[i] << ")\n{\n";
+
+		if(per_component) emitTimingBegin(emitter, "timing_" + component_counter + "_" + index);
+
+		emitUpdateBody(emitter, bodies[i]);
+
+		if(per_component) emitTimingEnd(emitter, "timing_" + component_counter + "_" + index, component_counter + "[" + index + "]");
+
+		if(rate > 1)
+		{
+			std::string hold;
+			std::string restore;
+
+			for(unsigned int slot : parseSourceSlots(bodies[i]))
+			{
+				const std::string k = std::to_string(slot);
+				hold += "multirate_hold_" + k + " = b_components[" + k + "];\n";
+				restore += "b_components[" + k + "] = multirate_hold_" + k + ";\n";
+			}
+
+			emitUpdateBody(emitter, hold);
+			emitter << "}\nelse\n{\n";
+			emitUpdateBody(emitter, restore);
+			emitter << "}\n";
+		}
+	}
+
+	if(multi_rate)
+		emitter << "multirate_step = (multirate_step < 0) ? 1 : (multirate_step + 1) % " << multiRateHyperperiod() << ";\n";
+
+	emitTimingEnd(emitter, "timing_" + section, section);
+}
+
+void SimulationEngineGenerator::emitCInlineCode(codegen::CodeEmitter& emitter, double zero_bound) const
+{
+	checkParameters();
+
+	if(parameters.batch_lanes > 1)
+	{
+		emitBatchedCInlineCode(emitter, zero_bound);
+		return;
+	}
+
+	updateCache(zero_bound);
+
+	const SystemConductanceGenerator& invg_gen = *cache.invg_gen;
+	SystemSolverGenerator& solver_gen = *cache.solver_gen;
+
+	unsigned int num_components = source_vector_gen.getNumSources();
+
+	// the solver prunes against the unscaled inv_g, so only the emitted literal is rescaled
+	int rescale_exponent = computeInvConductanceRescaleExponent(invg_gen, zero_bound);
+	solver_gen.setRescale(rescale_exponent, parameters.fixed_point_enable);
+	solver_gen.setFolding(parameters.xilinx_hls_solver_lanes, parameters.xilinx_hls_enable && parameters.xilinx_hls_directives_enable, computeSolverInterleave());
+
+	bool hls_directives = parameters.xilinx_hls_enable && parameters.xilinx_hls_directives_enable;
+
+	HLSDirectivePlan hls_plan;
+	if(hls_directives)
+	{
+		hls_plan = planHLSDirectives(zero_bound);
+		solver_gen.setFoldingMultiplier(hls_plan.multiplier_op, hls_plan.multiplier_impl, hls_plan.multiplier_latency);
+	}
+
+	//codegen xilinx HLS features
+	if(parameters.xilinx_hls_enable)
+	{
+		emitter << "//clock period=" << parameters.xilinx_hls_clock_period << "\n";
+
+		if(parameters.xilinx_hls_inline)
+		{
+			emitter << "#pragma HLS inline\n";
+		}
+
+		if(parameters.xilinx_hls_latency_enable)
+		{
+			emitter << "#pragma HLS latency min="<<parameters.xilinx_hls_latency_min<<
+			           " max="<<parameters.xilinx_hls_latency_max<<"\n";
+		}
+
+		if(hls_directives) emitHLSFunctionDirectives(emitter, hls_plan);
+
+		emitter << "\n";
+	}
+
+	emitter << "//MODEL PARAMETERS\n\n";
+
+	emitModelParameters(emitter);
+
+	if(parameters.io_struct_abi_enable)
+	{
+		emitter << "//MODEL INPUTS AND OUTPUTS\n\n";
+
+		emitIOBindings(emitter);
+		emitter << "\n";
+	}
+
+	emitter << "//COMPONENT FIELDS AND STATES\n\n";
+
+	if(globalStateEnabled())
+		emitter << model_name << "_State* const state = " << model_name << "_getState();\n\n";
+
+	for(const auto& i : engineFieldsCode())
+	{
+		if(stateBindingEnabled())
+		{
+			for(const auto& field : parseFieldsCode(i))
+			{
+				if(field.extents.empty())
+					emitter << field.type << "& " << field.name << " = state->" << field.name << ";\n";
+				else
+					emitter << field.type << " (&" << field.name << ")" << field.extents << " = state->" << field.name << ";\n";
+			}
+		}
+		else
+		{
+			emitter << i << "\n";
+		}
+	}
+	emitter << "\n";
+
+	emitter << "//MODEL SOLUTIONS\n\n";
+
+	if(stateBindingEnabled())
+	{
+		emitter
+		<< "real (&b)["<<num_solutions<<"] = state->b;\n"
+		<< "real (&x)["<<num_solutions+1<<"] = state->x;\n";
+	}
+	else if(parameters.io_struct_abi_enable && parameters.io_struct_solutions_in_place)
+	{
+		emitter
+		<< "static real b["<<num_solutions<<"];\n"
+		<< "real (&x)["<<num_solutions+1<<"] = out->x;\n";
+	}
+	else
+	{
+		emitter
+		<< "static real b["<<num_solutions<<"];\n"
+		<< "static real x["<<num_solutions+1<<"]" << (initial_solutions.empty() ? "" : " = " + initialSolutionsCode()) << ";\n";
+	}
+	emitter << "real b_components["<<num_components<<"];\n\n";
+
+	emitter << "//INVERTED CONDUCTANCE MATRIX\n\n";
+
+	emitInvConductance(emitter, rescale_exponent);
+	emitter << "\n\n";
+
+	if(hls_directives)
+	{
+		emitter << "//HLS DIRECTIVES\n\n";
+
+		emitHLSArrayDirectives(emitter, hls_plan);
+		emitter << "\n";
+	}
+
+	emitter << "//COMPONENT SOURCE CONTRIBUTION UPDATES\n\n";
+
+	emitTimingBegin(emitter, "timing_step");
+	emitTimedUpdateBodies(emitter, comp_update_bodies, "components", "component_updates", true);
+	emitter << "\n";
+
+	if(parameters.io_signal_output_enable)
+	{
+		emitter << "//MODEL OUTPUT SIGNAL UPDATES\n\n";
+
+		emitTimedUpdateBodies(emitter, comp_outputs_update_bodies, "outputs", "component_output_updates");
+		emitter << "\n";
+	}
+
+	emitter << "//AGGREGRATE COMPONENT SOURCE CONTRIBUTIONS\n\n";
+
+	emitTimingBegin(emitter, "timing_aggregation");
+	emitter << cache.aggregation_code << "\n";
+	emitTimingEnd(emitter, "timing_aggregation", "aggregation");
+	emitter << "\n";
+
+	emitter << "//MODEL UPDATE SOLUTIONS\n\n";
+
+	emitTimingBegin(emitter, "timing_solve");
+	solver_gen.writeCInlineCode(emitter.stream(), "inv_g");
+	emitter << "\n";
+	emitTimingEnd(emitter, "timing_solve", "solve");
+	emitTimingEnd(emitter, "timing_step", "step");
+	emitter << "\n";
+}
+
+HLSDirectivePlan SimulationEngineGenerator::planHLSDirectives(double zero_bound) const
+{
+	if(parameters.xilinx_hls_clock_period <= 0.0)
+		throw std::invalid_argument("SimulationEngineGenerator::planHLSDirectives(): xilinx_hls_clock_period must be positive nonzero value");
+
+	updateCache(zero_bound);
+
+	const SystemSolverGenerator& solver_gen = *cache.solver_gen;
+
+	HLSDirectivePlan plan;
+
+	plan.solver_terms = solver_gen.getNumberOfTerms();
+	for(unsigned int r = 0; r < num_solutions; r++)
+		plan.solver_depth = std::max(plan.solver_depth, solver_gen.getNumberOfTerms(r, r+1));
+
+	if(parameters.xilinx_hls_step_period > 0.0)
+	{
+		double cycles = std::floor(parameters.xilinx_hls_step_period / parameters.xilinx_hls_clock_period + 1.0e-9);
+		plan.cycle_budget = std::max(1u, static_cast<unsigned int>(cycles));
+	}
+
+	if(parameters.xilinx_hls_latency_enable && parameters.xilinx_hls_latency_max != 0)
+	{
+		if(plan.cycle_budget == 0 || parameters.xilinx_hls_latency_max < plan.cycle_budget)
+			plan.cycle_budget = parameters.xilinx_hls_latency_max;
+	}
+
+	// estimated combinational delay of one multiplier, split into stages that meet the clock period
+	double multiplier_delay;
+	if(parameters.fixed_point_enable)
+	{
+		multiplier_delay = 3.0e-9 * ((parameters.fixed_point_word_width + 16) / 17);
+		plan.multiplier_op = "mul";
+	}
+	else
+	{
+		multiplier_delay = 12.0e-9;
+		plan.multiplier_op = "dmul";
+	}
+
+	double stages = std::ceil(multiplier_delay / parameters.xilinx_hls_clock_period - 1.0e-9);
+	plan.multiplier_latency = stages > 1.0 ? static_cast<unsigned int>(stages) - 1 : 0;
+
+	unsigned int adder_depth = 0;
+	while((1u << adder_depth) < plan.solver_depth) adder_depth++;
+
+	plan.solver_lanes = parameters.xilinx_hls_solver_lanes;
+
+	if(plan.solver_lanes != 0)
+	{
+		// only the lanes of a folded solver compute their products into a variable that can be bound
+		plan.multiplier_impl = parameters.fixed_point_enable ? "dsp" : "fulldsp";
+
+		// the schedule of the folded solver as it is emitted
+		SystemSolverGenerator folded(solver_gen);
+		folded.setFolding(plan.solver_lanes, false, computeSolverInterleave());
+
+		plan.solver_interleave = folded.getFoldingInterleave();
+		plan.solver_cycles = folded.getNumberOfCycles();
+		plan.solver_latency = plan.solver_cycles + plan.multiplier_latency + plan.solver_interleave;
+	}
+	else
+	{
+		plan.solver_cycles = 1;
+		plan.solver_latency = plan.solver_cycles + plan.multiplier_latency + adder_depth;
+	}
+
+	if(parameters.xilinx_hls_multiplier_limit != 0)
+	{
+		plan.multiplier_limit = parameters.xilinx_hls_multiplier_limit;
+	}
+	else if(plan.solver_lanes != 0)
+	{
+		plan.multiplier_limit = plan.solver_lanes;
+	}
+	else if(plan.cycle_budget != 0 && plan.solver_terms != 0)
+	{
+		unsigned int overhead = plan.multiplier_latency + adder_depth;
+		unsigned int issue_cycles = plan.cycle_budget > overhead ? plan.cycle_budget - overhead : 1;
+
+		plan.multiplier_limit = (plan.solver_terms + issue_cycles - 1) / issue_cycles;
+	}
+
+	if(!parameters.xilinx_hls_inline) plan.pipeline_ii = plan.cycle_budget;
+
+	if(plan.multiplier_limit != 0)
+		plan.partition_factor = std::max(1u, (plan.multiplier_limit + 1) / 2);
+	else
+		plan.partition_factor = std::max(1u, parameters.xilinx_hls_partition_limit);
+
+	return plan;
+}
+
+HLSEstimate SimulationEngineGenerator::estimateHLS(const HLSEstimatorParameters& costs, double zero_bound) const
+{
+	checkParameters();
+
+	if(parameters.batch_lanes > 1)
+		throw std::runtime_error("SimulationEngineGenerator::estimateHLS(): batched engines cannot be synthesized with HLS");
+
+	HLSDirectivePlan plan = planHLSDirectives(zero_bound);
+
+	const SystemSolverGenerator& solver_gen = *cache.solver_gen;
+
+	const double clock_period = parameters.xilinx_hls_clock_period;
+	const bool fixed_point = parameters.fixed_point_enable;
+	const unsigned int lanes = parameters.xilinx_hls_solver_lanes;
+
+	const unsigned int multiplier_limit = parameters.xilinx_hls_directives_enable ? plan.multiplier_limit : 0;
+
+	HLSScheduler scheduler(clock_period, fixed_point, costs, multiplier_limit);
+
+	std::vector<std::string> constants;
+	for(const auto& param : parseParameters())
+	{
+		constants.push_back(param.name);
+	}
+	scheduler.addConstants(constants);
+
+	for(const auto& i : comp_update_bodies)
+	{
+		codegen::CodeEmitter body;
+		emitUpdateBody(body, i);
+		scheduler.scheduleCode(body.str());
+	}
+
+	if(parameters.io_signal_output_enable)
+	{
+		for(const auto& i : comp_outputs_update_bodies)
+		{
+			codegen::CodeEmitter body;
+			emitUpdateBody(body, i);
+			scheduler.scheduleCode(body.str());
+		}
+	}
+
+	scheduler.scheduleCode(cache.aggregation_code);
+
+	// SOLVER
+
+	double solver_start = 0.0;
+	for(unsigned int r = 0; r < num_solutions; r++)
+	{
+		solver_start = std::max(solver_start, scheduler.getReadyTime("b[" + std::to_string(r) + "]"));
+	}
+
+	int rescale_exponent = computeInvConductanceRescaleExponent(*cache.invg_gen, zero_bound);
+	bool rescale_multiply = rescale_exponent != 0 && !fixed_point;
+
+	if(lanes == 0)
+	{
+		for(unsigned int r = 0; r < num_solutions; r++)
+		{
+			std::vector<double> sums;
+
+			for(unsigned int k = 0; k < solver_gen.getNumberOfTerms(r, r+1); k++)
+			{
+				sums.push_back(scheduler.scheduleOperation(HLSScheduler::MUL, solver_start));
+			}
+
+			if(fixed_point)
+			{
+				while(sums.size() > 1)
+				{
+					std::vector<double> level;
+					for(std::size_t k = 0; k+1 < sums.size(); k += 2)
+					{
+						level.push_back(scheduler.scheduleOperation(HLSScheduler::ADD, std::max(sums[k], sums[k+1])));
+					}
+					if(sums.size() % 2 != 0) level.push_back(sums.back());
+
+					sums.swap(level);
+				}
+			}
+			else
+			{
+				for(std::size_t k = 1; k < sums.size(); k++)
+				{
+					sums[0] = scheduler.scheduleOperation(HLSScheduler::ADD, std::max(sums[0], sums[k]));
+				}
+			}
+
+			double time = sums.empty() ? solver_start : sums[0];
+
+			if(rescale_multiply && !sums.empty()) time = scheduler.scheduleOperation(HLSScheduler::MUL, time);
+
+			scheduler.setReadyTime("x[" + std::to_string(r+1) + "]", time);
+		}
+	}
+	else
+	{
+		// one shared multiplier and adder per lane; stream q issues its terms on lane q%lanes in
+		// cycles q/lanes, q/lanes + interleave, ..., each accumulation waiting for the previous one
+		const double issue = std::ceil(solver_start/clock_period - 1.0e-6)*clock_period;
+
+		SystemSolverGenerator folded(solver_gen);
+		folded.setFolding(lanes, false, computeSolverInterleave());
+
+		const std::vector<std::vector<unsigned int>> streams = folded.getFoldingStreams();
+		const unsigned int interleave = folded.getFoldingInterleave();
+
+		for(unsigned int q = 0; q < streams.size(); q++)
+		{
+			unsigned int t = q / lanes;
+			double sum = issue;
+
+			for(unsigned int r : streams[q])
+			{
+				for(unsigned int j = 0; j < solver_gen.getNumberOfTerms(r, r+1); j++, t += interleave)
+				{
+					double product = scheduler.scheduleOperation(HLSScheduler::MUL, issue + t*clock_period, false);
+					sum = scheduler.scheduleOperation(HLSScheduler::ADD, std::max(sum, product), false);
+				}
+
+				scheduler.setReadyTime("x[" + std::to_string(r+1) + "]", sum);
+			}
+		}
+
+		if(rescale_multiply)
+		{
+			double rescale_start = scheduler.getFinishTime();
+			for(unsigned int r = 0; r < num_solutions; r++)
+			{
+				scheduler.scheduleOperation(HLSScheduler::MUL, rescale_start, false);
+			}
+		}
+	}
+
+	HLSEstimate estimate;
+	scheduler.fillEstimate(estimate);
+
+	if(lanes != 0)
+	{
+		const HLSOperatorCost& mul = fixed_point ? costs.fixed_mul : costs.float_mul;
+		const HLSOperatorCost& add = fixed_point ? costs.fixed_add : costs.float_add;
+		// the lane multipliers count against the function wide multiplier limit
+		unsigned int multipliers = estimate.multipliers + lanes + (rescale_multiply ? 1 : 0);
+		if(multiplier_limit != 0) multipliers = std::min(multipliers, std::max(multiplier_limit, lanes));
+		multipliers -= estimate.multipliers;
+
+		estimate.multipliers += multipliers;
+		estimate.adders += lanes;
+		estimate.dsp += multipliers*mul.dsp + lanes*add.dsp;
+		estimate.lut += multipliers*mul.lut + lanes*add.lut;
+
+		// row, column, and coefficient ROM banks of each lane
+		const unsigned int cycles = plan.solver_cycles;
+		const unsigned int real_bits = fixed_point ? parameters.fixed_point_word_width : 64;
+		const unsigned int widths[] = { 32, 32, real_bits };
+
+		for(unsigned int width : widths)
+		{
+			const unsigned int bits = cycles*width;
+
+			if(bits >= costs.bram_threshold_bits)
+				estimate.bram += lanes*((bits + 18431)/18432);
+			else
+				estimate.lut += lanes*((cycles + 63)/64)*width;
+		}
+	}
+
+	if(parameters.xilinx_hls_latency_enable && parameters.xilinx_hls_latency_max != 0)
+	{
+		estimate.latency_max = parameters.xilinx_hls_latency_max;
+		estimate.latency_met = estimate.latency <= estimate.latency_max;
+	}
+
+	return estimate;
+}
+
+void SimulationEngineGenerator::emitHLSFunctionDirectives(codegen::CodeEmitter& emitter, const HLSDirectivePlan& plan) const
+{
+	if(plan.pipeline_ii != 0)
+	{
+		emitter << "#pragma HLS PIPELINE II=" << plan.pipeline_ii << "\n";
+	}
+
+	if(plan.multiplier_limit != 0)
+	{
+		emitter << "#pragma HLS ALLOCATION operation instances=" << plan.multiplier_op <<
+		           " limit=" << plan.multiplier_limit << "\n";
+	}
+}
+
+void SimulationEngineGenerator::emitHLSArrayDirectives(codegen::CodeEmitter& emitter, const HLSDirectivePlan& plan) const
+{
+	emitter << "//solver terms=" << plan.solver_terms << ", cycle budget=" << plan.cycle_budget <<
+	           ", multiplier latency=" << plan.multiplier_latency << "\n";
+	emitter << "//solver lanes=" << plan.solver_lanes << ", interleave=" << plan.solver_interleave << ", cycles=" << plan.solver_cycles <<
+	           ", latency=" << plan.solver_latency << " cycles (" <<
+	           plan.solver_latency*parameters.xilinx_hls_clock_period << " s)\n";
+
+	auto partition = [&](const char* name, unsigned int size)
+	{
+		bool complete = size <= parameters.xilinx_hls_partition_limit || plan.partition_factor >= size;
+
+		// a single bank already has the two ports that one or two multipliers need
+		if(size == 0 || (!complete && plan.partition_factor < 2)) return;
+
+		emitter << "#pragma HLS ARRAY_PARTITION variable=" << name;
+
+		if(complete)
+			emitter << " complete dim=1\n";
+		else
+			emitter << " cyclic factor=" << plan.partition_factor << " dim=1\n";
+	};
+
+	// the solutions of reentrant engines are members of the state, which the caller partitions
+	if(!parameters.reentrant_engine_enable)
+	{
+		partition("b", num_solutions);
+		if(!(parameters.io_struct_abi_enable && parameters.io_struct_solutions_in_place))
+			partition("x", num_solutions+1);
+	}
+
+	partition("b_components", source_vector_gen.getNumSources());
+
+	// a solver row reads across the columns of inv_g, so large matrices are banked by column
+	if(!parameters.runtime_parameters_enable && plan.solver_lanes == 0)
+	{
+		if(num_solutions*num_solutions <= parameters.xilinx_hls_partition_limit || plan.partition_factor >= num_solutions)
+			emitter << "#pragma HLS ARRAY_PARTITION variable=inv_g complete dim=0\n";
+		else if(plan.partition_factor >= 2)
+			emitter << "#pragma HLS ARRAY_PARTITION variable=inv_g cyclic factor=" << plan.partition_factor << " dim=2\n";
+	}
+}
+
+std::string SimulationEngineGenerator::generateCInlineCode(double zero_bound) const
+{
+	codegen::CodeEmitter emitter;
+	emitCInlineCode(emitter, zero_bound);
+	return emitter.str();
+}
+
+void SimulationEngineGenerator::emitCFunction(codegen::CodeEmitter& emitter, double zero_bound) const
+{
+	if(parameters.io_struct_abi_enable) emitIODefinitions(emitter);
+	if(parameters.runtime_parameters_enable) emitParameterDefinitions(emitter, zero_bound);
+	if(stateDefinitionsEnabled()) emitStateDefinitions(emitter);
+	if(parameters.checkpoint_enable) emitCheckpointDefinitions(emitter);
+	if(parameters.instrumentation_enable) emitTimingDefinitions(emitter);
+
+	emitEngineFunction(emitter, zero_bound);
+
+	if(parameters.multi_step_enable)
+	{
+		emitter << "\n\n";
+		emitMultiStepFunction(emitter, zero_bound);
+	}
+
+	if(!parameters.xilinx_hls_stream_interface.empty())
+	{
+		emitter << "\n\n";
+		emitStreamEngineFunction(emitter);
+	}
+}
+
+void SimulationEngineGenerator::emitEngineFunction(codegen::CodeEmitter& emitter, double zero_bound) const
+{
+	if(parameters.batch_lanes > 1 && !parameters.batch_simd_isa.empty())
+		emitter << "__attribute__((target(\"" << parameters.batch_simd_isa << "\")))\n";
+
+	emitter
+	<< "void "<<model_name<<"_simulationEngine\n"
+	<< "(\n";
+
+	if(stateStructEnabled()) emitter << model_name << "_State* state,\n";
+	if(parameters.runtime_parameters_enable) emitter << "const " << model_name << "_Parameters* params,\n";
+
+	emitCFunctionParameterList(emitter);
+
+	emitter
+	<< "\n)\n"
+	<< "{\n";
+
+	emitCInlineCode(emitter, zero_bound);
+
+	if(parameters.batch_lanes > 1)
+	{
+		emitter
+		<< "#pragma omp simd\n"
+		<< "for(unsigned int lane = 0; lane < " << parameters.batch_lanes << "; lane++)\n"
+		<< "{\n";
+
+		for(unsigned int i = 0; i < num_solutions; i++)
+		{
+			emitter << "x_out["<<i<<"][lane] = state->x["<<i+1<<"][lane];\n";
+		}
+
+		emitter << "}\n";
+	}
+	else if(parameters.io_struct_abi_enable)
+	{
+		if(!parameters.io_struct_solutions_in_place)
+		{
+			for(unsigned int i = 0; i < num_solutions; i++)
+			{
+				emitter << "out->x_out["<<i<<"] = x["<<i+1<<"];\n";
+			}
+		}
+	}
+	else
+	{
+		for(unsigned int i = 0; i < num_solutions; i++)
+		{
+			emitter << "x_out["<<i<<"] = x["<<i+1<<"];\n";
+		}
+	}
+
+	emitter
+	<< "\n}";
+}
+
+void SimulationEngineGenerator::emitMultiStepFunction(codegen::CodeEmitter& emitter, double zero_bound) const
+{
+	checkParameters();
+	updateCache(zero_bound);
+
+	SystemSolverGenerator& solver_gen = *cache.solver_gen;
+
+	unsigned int num_components = source_vector_gen.getNumSources();
+	const unsigned int decimation = parameters.multi_step_output_decimation;
+
+	int rescale_exponent = computeInvConductanceRescaleExponent(*cache.invg_gen, zero_bound);
+	solver_gen.setRescale(rescale_exponent, parameters.fixed_point_enable);
+	solver_gen.setFolding(parameters.xilinx_hls_solver_lanes, parameters.xilinx_hls_enable && parameters.xilinx_hls_directives_enable, computeSolverInterleave());
+
+	std::vector<ParameterDeclaration> inputs = parseInputs();
+
+	std::vector<ParameterDeclaration> outputs = parseOutputs();
+
+	std::vector<FieldDeclaration> fields;
+	for(const auto& i : engineFieldsCode())
+	{
+		std::vector<FieldDeclaration> comp = parseFieldsCode(i);
+		fields.insert(fields.end(), comp.begin(), comp.end());
+	}
+
+	emitter
+	<< "void "<<model_name<<"_simulationEngineSteps\n"
+	<< "(\n";
+
+	if(stateStructEnabled()) emitter << model_name << "_State* state,\n";
+	if(parameters.runtime_parameters_enable) emitter << "const " << model_name << "_Parameters* params,\n";
+
+	emitter
+	<< "unsigned int num_steps,\n"
+	<< "real x_out[]["<<num_solutions<<"]";
+
+	for(const auto& output : outputs)
+	{
+		emitter << ",\n" << signalValueType(output) << " " << output.name << "_steps[]" << output.extents;
+	}
+
+	for(const auto& input : inputs)
+	{
+		emitter << ",\nconst " << input.type << " " << input.name << "_steps[]" << input.extents;
+	}
+
+	emitter
+	<< "\n)\n"
+	<< "{\n";
+
+	emitter << "//MODEL PARAMETERS\n\n";
+
+	emitModelParameters(emitter);
+
+	emitter << "//COMPONENT FIELDS AND STATES\n\n";
+
+	if(globalStateEnabled())
+		emitter << model_name << "_State* const state = " << model_name << "_getState();\n\n";
+
+	// scalars are copied into locals for the step loop, array fields stay bound to the state
+	for(const auto& field : fields)
+	{
+		if(field.extents.empty())
+			emitter << field.type << " " << field.name << " = state->" << field.name << ";\n";
+		else
+			emitter << field.type << " (&" << field.name << ")" << field.extents << " = state->" << field.name << ";\n";
+	}
+	emitter << "\n";
+
+	emitter << "//MODEL SOLUTIONS\n\n";
+
+	emitter
+	<< "real (&b)["<<num_solutions<<"] = state->b;\n"
+	<< "real x["<<num_solutions+1<<"];\n"
+	<< "for(unsigned int i = 0; i < "<<num_solutions+1<<"; i++) x[i] = state->x[i];\n"
+	<< "real b_components["<<num_components<<"];\n\n";
+
+	emitter << "//INVERTED CONDUCTANCE MATRIX\n\n";
+
+	emitInvConductance(emitter, rescale_exponent);
+	emitter << "\n\n";
+
+	emitter
+	<< "for(unsigned int step = 0; step < num_steps; step++)\n"
+	<< "{\n";
+
+	emitter << "//MODEL INPUTS\n\n";
+
+	for(const auto& input : inputs)
+	{
+		if(!input.extents.empty())
+			emitter << "const " << input.type << " (&" << input.name << ")" << input.extents << " = " << input.name << "_steps[step];\n";
+		else
+			emitter << "const " << input.type << " " << input.name << " = " << input.name << "_steps[step];\n";
+	}
+	emitter << "\n";
+
+	emitter << "//COMPONENT SOURCE CONTRIBUTION UPDATES\n\n";
+
+	emitTimingBegin(emitter, "timing_step");
+	emitTimedUpdateBodies(emitter, comp_update_bodies, "components", "component_updates", true);
+	emitter << "\n";
+
+	emitter << "//MODEL OUTPUT SIGNAL UPDATES\n\n";
+
+	emitter
+	<< "if( (step+1) % " << decimation << " == 0 )\n"
+	<< "{\n"
+	<< "const unsigned int record = step/" << decimation << ";\n\n";
+
+	for(const auto& output : outputs)
+	{
+		char kind = output.type.back();
+
+		if(!output.extents.empty())
+			emitter << output.type << " (&" << output.name << ")" << output.extents << " = " << output.name << "_steps[record];\n";
+		else if(kind == '*')
+			emitter << output.type << " " << output.name << " = &" << output.name << "_steps[record];\n";
+		else
+			emitter << output.type << " " << output.name << " = " << output.name << "_steps[record];\n";
+	}
+	emitter << "\n";
+
+	if(parameters.io_signal_output_enable)
+	{
+		emitTimedUpdateBodies(emitter, comp_outputs_update_bodies, "outputs", "component_output_updates");
+		emitter << "\n";
+	}
+
+	emitter << "}\n\n";
+
+	emitter << "//AGGREGRATE COMPONENT SOURCE CONTRIBUTIONS\n\n";
+
+	emitTimingBegin(emitter, "timing_aggregation");
+	emitter << cache.aggregation_code << "\n";
+	emitTimingEnd(emitter, "timing_aggregation", "aggregation");
+	emitter << "\n";
+
+	emitter << "//MODEL UPDATE SOLUTIONS\n\n";
+
+	emitTimingBegin(emitter, "timing_solve");
+	solver_gen.writeCInlineCode(emitter.stream(), "inv_g");
+	emitter << "\n";
+	emitTimingEnd(emitter, "timing_solve", "solve");
+	emitTimingEnd(emitter, "timing_step", "step");
+	emitter << "\n";
+
+	emitter
+	<< "if( (step+1) % " << decimation << " == 0 )\n"
+	<< "{\n";
+
+	for(unsigned int i = 0; i < num_solutions; i++)
+	{
+		emitter << "x_out[step/" << decimation << "]["<<i<<"] = x["<<i+1<<"];\n";
+	}
+
+	emitter << "}\n";
+
+	emitter << "}\n\n";
+
+	emitter << "//STORE COMPONENT FIELDS AND STATES\n\n";
+
+	for(const auto& field : fields)
+	{
+		if(field.extents.empty())
+			emitter << "state->" << field.name << " = " << field.name << ";\n";
+	}
+
+	emitter << "for(unsigned int i = 0; i < "<<num_solutions+1<<"; i++) state->x[i] = x[i];\n";
+
+	emitter << "\n}";
+}
+
+std::string SimulationEngineGenerator::generateCFunction(double zero_bound) const
+{
+	codegen::CodeEmitter emitter;
+	emitCFunction(emitter, zero_bound);
+	return emitter.str();
+}
+
+void SimulationEngineGenerator::generateCFunctionAndExport(std::string filename, double zero_bound) const
+{
+	if(filename == "")
+		throw std::invalid_argument("SimulationEngineGenerator::generateCFunctionAndExport(): filename cannot be null or empty");
+
+	codegen::CodeEmitter file(filename);
+
+	emitCFunctionHeader(file, zero_bound);
+
+	file.close();
+
+}
+
+void SimulationEngineGenerator::emitCFunctionHeader(codegen::CodeEmitter& file, double zero_bound) const
+{
+	emitFileBanner(file);
+
+	file << "#ifndef " << model_name << "_SIMULATIONENGINE_HPP" << "\n";
+	file << "#define " << model_name << "_SIMULATIONENGINE_HPP" << "\n";
+
+	file << "\n\n";
+
+	emitRealTypedef(file);
+
+	if(parameters.io_struct_abi_enable) emitIODefinitions(file);
+	if(parameters.runtime_parameters_enable) emitParameterDefinitions(file, zero_bound);
+	if(stateDefinitionsEnabled()) emitStateDefinitions(file);
+	if(parameters.checkpoint_enable) emitCheckpointDefinitions(file);
+	if(parameters.instrumentation_enable) emitTimingDefinitions(file);
+
+	file << "inline\n";
+
+	emitEngineFunction(file, zero_bound);
+	file << "\n\n";
+
+	if(parameters.multi_step_enable)
+	{
+		file << "inline\n";
+
+		emitMultiStepFunction(file, zero_bound);
+		file << "\n\n";
+	}
+
+	if(!parameters.xilinx_hls_stream_interface.empty())
+	{
+		emitStreamEngineFunction(file);
+		file << "\n\n";
+	}
+
+	file << "\n#endif";
+}
+
+void SimulationEngineGenerator::generateDriverAndExport
+(
+	std::string filename,
+	std::string engine_header,
+	std::vector<std::string> recorded_outputs
+) const
+{
+	if(filename == "" || engine_header == "")
+		throw std::invalid_argument("SimulationEngineGenerator::generateDriverAndExport(): filename and engine_header cannot be null or empty");
+
+	if(parameters.batch_lanes > 1 || parameters.io_struct_abi_enable)
+		throw std::runtime_error("SimulationEngineGenerator::generateDriverAndExport(): drivers are not supported for batched or struct I/O ABI engines");
+
+	std::vector<ParameterDeclaration> inputs = parseInputs();
+	std::vector<ParameterDeclaration> outputs = parseOutputs();
+
+	bool record_solutions = recorded_outputs.empty();
+	std::vector<ParameterDeclaration> records;
+
+	if(recorded_outputs.empty())
+	{
+		records = outputs;
+	}
+	else
+	{
+		for(const auto& name : recorded_outputs)
+		{
+			if(name == "x_out")
+			{
+				record_solutions = true;
+				continue;
+			}
+
+			auto output = std::find_if(outputs.begin(), outputs.end(), [&name](const ParameterDeclaration& o) { return o.name == name; });
+
+			if(output == outputs.end())
+				throw std::invalid_argument("SimulationEngineGenerator::generateDriverAndExport(): " + name + " is not an output of the engine");
+
+			records.push_back(*output);
+		}
+	}
+
+	for(const auto& input : inputs)
+	{
+		if(input.extents.empty() && input.type.back() == '*')
+			throw std::runtime_error("SimulationEngineGenerator::generateDriverAndExport(): pointer input signal " + input.name + " is not supported by drivers");
+	}
+
+	codegen::CodeEmitter file(filename);
+
+	file <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Simulation Engine Host Driver for " << model_name << "\n"
+			" *\n"
+			" * Auto-generated by SimulationEngineGenerator Object\n"
+			" *\n"
+			" */\n\n";
+
+	file << "#include \"" << engine_header << "\"\n\n";
+
+	file <<
+	"#include <cstdio>\n"
+	"#include <cstdlib>\n"
+	"#include <cstring>\n"
+	"#include <string>\n"
+	"#include <vector>\n"
+	"#include <future>\n"
+	"#include <chrono>\n\n"
+	"#include <fcntl.h>\n"
+	"#include <unistd.h>\n"
+	"#include <sys/mman.h>\n"
+	"#include <sys/stat.h>\n\n";
+
+	file << "static const unsigned int NUM_INPUTS = " << inputs.size() << ";\n\n";
+
+	file << "static const char* INPUT_NAMES[] = { ";
+	for(const auto& input : inputs) file << "\"" << input.name << "\", ";
+	file << "0 };\n\n";
+
+	file << "static const std::size_t INPUT_STEP_SIZES[] = { ";
+	for(const auto& input : inputs) file << "sizeof(" << signalValueType(input) << input.extents << "), ";
+	file << "0 };\n\n";
+
+	file << "static const std::size_t BLOCK_RECORDS = 4096;\n\n";
+
+	file <<
+	"static const unsigned char* mapInput(const char* filename, std::size_t min_size)\n"
+	"{\n"
+	"\tint fd = open(filename, O_RDONLY);\n"
+	"\tif(fd < 0) { std::perror(filename); return 0; }\n\n"
+	"\tstruct stat st;\n"
+	"\tif(fstat(fd, &st) != 0 || (std::size_t)st.st_size < min_size || st.st_size == 0)\n"
+	"\t{\n"
+	"\t\tstd::fprintf(stderr, \"%s: file is shorter than the number of steps\\n\", filename);\n"
+	"\t\tclose(fd);\n"
+	"\t\treturn 0;\n"
+	"\t}\n\n"
+	"\tvoid* data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);\n"
+	"\tclose(fd);\n\n"
+	"\tif(data == MAP_FAILED) { std::perror(filename); return 0; }\n\n"
+	"\tmadvise(data, st.st_size, MADV_SEQUENTIAL);\n"
+	"\treturn (const unsigned char*)data;\n"
+	"}\n\n";
+
+	file <<
+	"static void writeBlock(std::FILE* file, const std::vector<double>* block)\n"
+	"{\n"
+	"\tstd::fwrite(block->data(), sizeof(double), block->size(), file);\n"
+	"}\n\n";
+
+	file <<
+	"template<typename T>\n"
+	"static inline void recordValues(std::vector<double>& block, const T* values, std::size_t count)\n"
+	"{\n"
+	"\tfor(std::size_t i = 0; i < count; i++) block.push_back((double)values[i]);\n"
+	"}\n\n";
+
+	file <<
+	"static void writeColumns(std::FILE* file, const char* name, std::size_t count)\n"
+	"{\n"
+	"\tif(count == 1) std::fprintf(file, \"%s\\n\", name);\n"
+	"\telse for(std::size_t i = 0; i < count; i++) std::fprintf(file, \"%s[%zu]\\n\", name, i);\n"
+	"}\n\n";
+
+	const unsigned int num_args = 4 + inputs.size();
+
+	file <<
+	"int main(int argc, char** argv)\n"
+	"{\n";
+
+	file << "\tif(argc != " << num_args;
+	if(parameters.runtime_parameters_enable) file << " && argc != " << num_args+1;
+	file << ")\n";
+
+	file <<
+	"\t{\n"
+	"\t\tstd::fprintf(stderr, \"usage: %s num_steps decimation output_file";
+	for(const auto& input : inputs) file << " " << input.name << "_file";
+	if(parameters.runtime_parameters_enable) file << " [parameters_file]";
+	file << "\\n\", argv[0]);\n"
+	"\t\treturn 1;\n"
+	"\t}\n\n";
+
+	file <<
+	"\tconst unsigned long num_steps = std::strtoul(argv[1], 0, 10);\n"
+	"\tconst unsigned long decimation = std::strtoul(argv[2], 0, 10);\n\n"
+	"\tif(num_steps == 0 || decimation == 0)\n"
+	"\t{\n"
+	"\t\tstd::fprintf(stderr, \"num_steps and decimation must be positive\\n\");\n"
+	"\t\treturn 1;\n"
+	"\t}\n\n";
+
+	file <<
+	"\tconst unsigned char* input_data[NUM_INPUTS+1];\n"
+	"\tfor(unsigned int i = 0; i < NUM_INPUTS; i++)\n"
+	"\t{\n"
+	"\t\tinput_data[i] = mapInput(argv[4+i], num_steps*INPUT_STEP_SIZES[i]);\n"
+	"\t\tif(input_data[i] == 0) { std::fprintf(stderr, \"could not load input %s\\n\", INPUT_NAMES[i]); return 1; }\n"
+	"\t}\n\n";
+
+	if(stateStructEnabled())
+	{
+		file
+		<< "\tstatic " << model_name << "_State state;\n"
+		<< "\t" << model_name << "_initState(&state);\n\n";
+	}
+
+	if(parameters.runtime_parameters_enable)
+	{
+		file
+		<< "\tstatic " << model_name << "_Parameters params;\n"
+		<< "\t" << model_name << "_initParameters(&params);\n\n"
+		<< "\tif(argc == " << num_args+1 << " && !" << model_name << "_loadParametersFile(&params, argv[" << num_args << "]))\n"
+		<< "\t{\n"
+		<< "\t\tstd::fprintf(stderr, \"could not load parameters from %s\\n\", argv[" << num_args << "]);\n"
+		<< "\t\treturn 1;\n"
+		<< "\t}\n\n";
+	}
+
+	file << "\treal x_out[" << num_solutions << "];\n";
+
+	for(const auto& output : outputs)
+	{
+		file << "\t" << signalValueType(output) << " " << output.name << output.extents << ";\n";
+	}
+
+	for(const auto& input : inputs)
+	{
+		file << "\t" << signalValueType(input) << " " << input.name << input.extents << ";\n";
+	}
+	file << "\n";
+
+	file << "\tconst std::size_t num_columns = 0";
+	if(record_solutions) file << " + " << num_solutions;
+	for(const auto& record : records)
+	{
+		file << "\n\t\t+ sizeof(" << record.name << ")/sizeof(" << signalValueType(record) << ")";
+	}
+	file << ";\n\n";
+
+	file <<
+	"\tstd::FILE* output = std::fopen(argv[3], \"wb\");\n"
+	"\tstd::FILE* columns = std::fopen((std::string(argv[3]) + \".columns\").c_str(), \"w\");\n\n"
+	"\tif(output == 0 || columns == 0) { std::perror(argv[3]); return 1; }\n\n";
+
+	if(record_solutions) file << "\twriteColumns(columns, \"x_out\", " << num_solutions << ");\n";
+	for(const auto& record : records)
+	{
+		file << "\twriteColumns(columns, \"" << record.name << "\", sizeof(" << record.name << ")/sizeof(" << signalValueType(record) << "));\n";
+	}
+	file << "\tstd::fclose(columns);\n\n";
+
+	file <<
+	"\tstd::vector<double> blocks[2];\n"
+	"\tblocks[0].reserve(BLOCK_RECORDS*num_columns);\n"
+	"\tblocks[1].reserve(BLOCK_RECORDS*num_columns);\n"
+	"\tunsigned int active = 0;\n"
+	"\tstd::future<void> pending;\n\n";
+
+	file <<
+	"\tconst std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();\n\n"
+	"\tfor(unsigned long step = 0; step < num_steps; step++)\n"
+	"\t{\n";
+
+	for(unsigned int i = 0; i < inputs.size(); i++)
+	{
+		file << "\t\tstd::memcpy(&" << inputs[i].name << ", input_data[" << i << "] + step*INPUT_STEP_SIZES[" << i << "], INPUT_STEP_SIZES[" << i << "]);\n";
+	}
+	file << "\n";
+
+	file << "\t\t" << model_name << "_simulationEngine(";
+	if(stateStructEnabled()) file << "&state, ";
+	if(parameters.runtime_parameters_enable) file << "&params, ";
+	file << "x_out";
+
+	for(const auto& signal : parseSignals())
+	{
+		file << ", " << (signal.extents.empty() && signal.type.back() == '*' ? "&" : "") << signal.name;
+	}
+	file << ");\n\n";
+
+	file <<
+	"\t\tif( (step+1) % decimation != 0 ) continue;\n\n"
+	"\t\tstd::vector<double>& block = blocks[active];\n";
+
+	if(record_solutions) file << "\t\trecordValues(block, x_out, " << num_solutions << ");\n";
+	for(const auto& record : records)
+	{
+		file << "\t\trecordValues(block, (const " << signalValueType(record) << "*)&" << record.name << ", sizeof(" << record.name << ")/sizeof(" << signalValueType(record) << "));\n";
+	}
+
+	file <<
+	"\n"
+	"\t\tif(block.size() >= BLOCK_RECORDS*num_columns)\n"
+	"\t\t{\n"
+	"\t\t\tif(pending.valid()) pending.get();\n"
+	"\t\t\tpending = std::async(std::launch::async, writeBlock, output, &block);\n"
+	"\t\t\tactive ^= 1;\n"
+	"\t\t\tblocks[active].clear();\n"
+	"\t\t}\n"
+	"\t}\n\n";
+
+	file <<
+	"\tconst std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();\n\n"
+	"\tif(pending.valid()) pending.get();\n"
+	"\twriteBlock(output, &blocks[active]);\n"
+	"\tstd::fclose(output);\n\n"
+	"\tconst double seconds = std::chrono::duration<double>(stop-start).count();\n"
+	"\tstd::fprintf(stderr, \"%lu steps in %.6f s; %.3f ns per step\\n\", num_steps, seconds, 1.0e9*seconds/num_steps);\n\n";
+
+	if(parameters.instrumentation_enable) file << "\t" << model_name << "_writeTiming(stderr);\n\n";
+
+	file <<
+	"\treturn 0;\n"
+	"}\n";
+
+	file.close();
+}
+
+double SimulationEngineGenerator::getModelTimeStep() const
+{
+	std::vector<double> steps;
+
+	for(const auto& param : parseParameters())
+	{
+		if(param.name != "DT" && param.name.compare(0, 3, "DT_") != 0) continue;
+
+		double value = std::strtod(param.value.c_str(), nullptr);
+
+		if(value <= 0.0)
+			throw std::runtime_error("SimulationEngineGenerator::getModelTimeStep(): parameter " + param.name + " is not a positive time step");
+
+		steps.push_back(value);
+	}
+
+	if(steps.empty())
+		throw std::runtime_error("SimulationEngineGenerator::getModelTimeStep(): no component of the model has a time step DT");
+
+	// slow components of multi-rate models step by multiples of the base time step
+	const bool multi_rate = multiRateEnabled();
+	const double dt = multi_rate ? *std::min_element(steps.begin(), steps.end()) : steps.front();
+
+	for(double value : steps)
+	{
+		const double multiple = multi_rate ? std::round(value/dt) : 1.0;
+
+		if(std::abs(value - multiple*dt) > 1.0e-9*value)
+			throw std::runtime_error("SimulationEngineGenerator::getModelTimeStep(): components of the model have different time steps DT");
+	}
+
+	return dt;
+}
+
+void SimulationEngineGenerator::generateRealTimeRunnerAndExport(std::string filename, std::string engine_header) const
+{
+	if(filename == "" || engine_header == "")
+		throw std::invalid_argument("SimulationEngineGenerator::generateRealTimeRunnerAndExport(): filename and engine_header cannot be null or empty");
+
+	if(parameters.batch_lanes > 1 || parameters.io_struct_abi_enable)
+		throw std::runtime_error("SimulationEngineGenerator::generateRealTimeRunnerAndExport(): runners are not supported for batched or struct I/O ABI engines");
+
+	if(parameters.realtime_pacing != "nanosleep" && parameters.realtime_pacing != "busy_wait")
+		throw std::runtime_error("SimulationEngineGenerator::generateRealTimeRunnerAndExport(): realtime_pacing must be nanosleep or busy_wait");
+
+	if(parameters.realtime_histogram_bins == 0 || parameters.realtime_histogram_resolution <= 0.0)
+		throw std::runtime_error("SimulationEngineGenerator::generateRealTimeRunnerAndExport(): realtime histograms must have positive nonzero bins and resolution");
+
+	if(parameters.realtime_fifo_priority > 99)
+		throw std::runtime_error("SimulationEngineGenerator::generateRealTimeRunnerAndExport(): realtime_fifo_priority must be from 0 to 99");
+
+	const double period = (parameters.realtime_step_period > 0.0) ? parameters.realtime_step_period : getModelTimeStep();
+	const long long period_ns = std::llround(period*1.0e9);
+	const long long resolution_ns = std::max(1LL, (long long)std::llround(parameters.realtime_histogram_resolution*1.0e9));
+	const unsigned int bins = parameters.realtime_histogram_bins;
+
+	if(period_ns <= 0)
+		throw std::runtime_error("SimulationEngineGenerator::generateRealTimeRunnerAndExport(): step period must be at least 1 ns");
+
+	const std::string signals = model_name + "_RealTimeSignals";
+	const std::string stats = model_name + "_RealTimeStats";
+
+	codegen::CodeEmitter file(filename);
+
+	file <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Simulation Engine Real-Time Runner for " << model_name << "\n"
+			" *\n"
+			" * Auto-generated by SimulationEngineGenerator Object\n"
+			" *\n"
+			" */\n\n";
+
+	file << "#ifndef " << model_name << "_REALTIME_HPP\n";
+	file << "#define " << model_name << "_REALTIME_HPP\n\n";
+
+	file << "#include \"" << engine_header << "\"\n\n";
+
+	file <<
+	"#include <cstdio>\n"
+	"#include <cstring>\n"
+	"#include <cerrno>\n\n"
+	"#include <time.h>\n"
+	"#include <sched.h>\n"
+	"#include <sys/mman.h>\n\n";
+
+	file
+	<< "const static long long " << model_name << "_realtime_period_ns = " << period_ns << ";\n"
+	<< "const static long long " << model_name << "_realtime_resolution_ns = " << resolution_ns << ";\n"
+	<< "const static unsigned int " << model_name << "_realtime_histogram_bins = " << bins << ";\n\n";
+
+	file << "struct " << signals << "\n{\n";
+
+	if(stateStructEnabled()) file << "\t" << model_name << "_State state;\n";
+	if(parameters.runtime_parameters_enable) file << "\tconst " << model_name << "_Parameters* params;\n";
+
+	file << "\treal x_out[" << num_solutions << "];\n";
+
+	for(const auto& signal : parseSignals())
+	{
+		file << "\t" << signalValueType(signal) << " " << signal.name << signal.extents << ";\n";
+	}
+
+	file << "};\n\n";
+
+	file <<
+	"struct " << stats << "\n"
+	"{\n"
+	"\tunsigned long steps;\n"
+	"\tunsigned long overruns;\n"
+	"\tunsigned long skipped_periods;\n"
+	"\tlong long max_lateness_ns;\n"
+	"\tlong long total_lateness_ns;\n"
+	"\tlong long max_execution_ns;\n"
+	"\tlong long total_execution_ns;\n"
+	"\tunsigned long long lateness_histogram[" << bins << "];\n"
+	"\tunsigned long long execution_histogram[" << bins << "];\n"
+	"};\n\n";
+
+	file <<
+	"struct " << model_name << "_NoExchange\n"
+	"{\n"
+	"\tinline void operator()(unsigned long, " << signals << "&) const {}\n"
+	"};\n\n";
+
+	file <<
+	"inline void " << model_name << "_initRealTimeSignals(" << signals << "* signals)\n"
+	"{\n"
+	"\tstd::memset(signals, 0, sizeof(" << signals << "));\n";
+
+	if(stateStructEnabled()) file << "\t" << model_name << "_initState(&signals->state);\n";
+
+	file << "}\n\n";
+
+	file <<
+	"inline int " << model_name << "_setupRealTime()\n"
+	"{\n";
+
+	if(parameters.realtime_pinning_enable)
+	{
+		file <<
+		"\tcpu_set_t cpus;\n"
+		"\tCPU_ZERO(&cpus);\n"
+		"\tCPU_SET(" << parameters.realtime_cpu << ", &cpus);\n"
+		"\tif(sched_setaffinity(0, sizeof(cpus), &cpus) != 0) return errno;\n\n";
+	}
+
+	file <<
+	"\tif(mlockall(MCL_CURRENT | MCL_FUTURE) != 0) return errno;\n\n"
+	"\tvolatile unsigned char stack[1 << 16];\n"
+	"\tfor(unsigned int i = 0; i < sizeof(stack); i += 4096) stack[i] = 0;\n";
+
+	if(parameters.realtime_fifo_priority != 0)
+	{
+		file <<
+		"\n"
+		"\tsched_param param;\n"
+		"\tstd::memset(&param, 0, sizeof(param));\n"
+		"\tparam.sched_priority = " << parameters.realtime_fifo_priority << ";\n"
+		"\tif(sched_setscheduler(0, SCHED_FIFO, &param) != 0) return errno;\n";
+	}
+
+	file <<
+	"\n"
+	"\treturn 0;\n"
+	"}\n\n";
+
+	file <<
+	"inline long long " << model_name << "_realTimeNow()\n"
+	"{\n"
+	"\ttimespec now;\n"
+	"\tclock_gettime(CLOCK_MONOTONIC, &now);\n"
+	"\treturn (long long)now.tv_sec*1000000000LL + now.tv_nsec;\n"
+	"}\n\n";
+
+	file <<
+	"inline void " << model_name << "_realTimeRecord(unsigned long long histogram[], long long& max, long long& total, long long time)\n"
+	"{\n"
+	"\tif(time > max) max = time;\n"
+	"\ttotal += time;\n\n"
+	"\tconst long long bin = time/" << model_name << "_realtime_resolution_ns;\n"
+	"\thistogram[(bin < " << bins-1 << ") ? bin : " << bins-1 << "]++;\n"
+	"}\n\n";
+
+	file <<
+	"template<typename Exchange>\n"
+	"inline " << stats << " " << model_name << "_runRealTime(" << signals << "& signals, unsigned long num_steps, Exchange exchange)\n"
+	"{\n"
+	"\t" << stats << " stats;\n"
+	"\tstd::memset(&stats, 0, sizeof(stats));\n\n"
+	"\tlong long deadline = " << model_name << "_realTimeNow() + " << model_name << "_realtime_period_ns;\n\n"
+	"\tfor(unsigned long step = 0; step < num_steps; step++, deadline += " << model_name << "_realtime_period_ns)\n"
+	"\t{\n";
+
+	if(parameters.realtime_pacing == "busy_wait")
+	{
+		file << "\t\twhile(" << model_name << "_realTimeNow() < deadline) {}\n\n";
+	}
+	else
+	{
+		file <<
+		"\t\ttimespec wake;\n"
+		"\t\twake.tv_sec = deadline/1000000000LL;\n"
+		"\t\twake.tv_nsec = deadline%1000000000LL;\n"
+		"\t\twhile(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, 0) == EINTR) {}\n\n";
+	}
+
+	file <<
+	"\t\tconst long long start = " << model_name << "_realTimeNow();\n\n"
+	"\t\texchange(step, signals);\n\n";
+
+	file << "\t\t" << model_name << "_simulationEngine(";
+	if(stateStructEnabled()) file << "&signals.state, ";
+	if(parameters.runtime_parameters_enable) file << "signals.params, ";
+	file << "signals.x_out";
+
+	for(const auto& signal : parseSignals())
+	{
+		file << ", " << (signal.extents.empty() && signal.type.back() == '*' ? "&" : "") << "signals." << signal.name;
+	}
+	file << ");\n\n";
+
+	file <<
+	"\t\tconst long long stop = " << model_name << "_realTimeNow();\n\n"
+	"\t\t" << model_name << "_realTimeRecord(stats.lateness_histogram, stats.max_lateness_ns, stats.total_lateness_ns, (start > deadline) ? start-deadline : 0);\n"
+	"\t\t" << model_name << "_realTimeRecord(stats.execution_histogram, stats.max_execution_ns, stats.total_execution_ns, stop-start);\n\n"
+	"\t\t// skip the deadlines an overrun has missed, so one stall does not make every later step late\n"
+	"\t\tif(stop > deadline + " << model_name << "_realtime_period_ns)\n"
+	"\t\t{\n"
+	"\t\t\tconst long long missed = (stop - deadline)/" << model_name << "_realtime_period_ns;\n"
+	"\t\t\tdeadline += missed*" << model_name << "_realtime_period_ns;\n"
+	"\t\t\tstats.skipped_periods += missed;\n"
+	"\t\t\tstats.overruns++;\n"
+	"\t\t}\n\n"
+	"\t\tstats.steps++;\n"
+	"\t}\n\n"
+	"\treturn stats;\n"
+	"}\n\n";
+
+	file <<
+	"inline " << stats << " " << model_name << "_runRealTime(" << signals << "& signals, unsigned long num_steps)\n"
+	"{\n"
+	"\treturn " << model_name << "_runRealTime(signals, num_steps, " << model_name << "_NoExchange());\n"
+	"}\n\n";
+
+	file <<
+	"inline void " << model_name << "_writeRealTimeStats(std::FILE* file, const " << stats << "& stats)\n"
+	"{\n"
+	"\tconst unsigned long steps = (stats.steps != 0) ? stats.steps : 1;\n\n"
+	"\tstd::fprintf(file, \"%lu steps every %lld ns; %lu overruns, %lu periods skipped\\n\", stats.steps, " << model_name << "_realtime_period_ns, stats.overruns, stats.skipped_periods);\n"
+	"\tstd::fprintf(file, \"lateness:  max %lld ns, mean %.1f ns\\n\", stats.max_lateness_ns, (double)stats.total_lateness_ns/steps);\n"
+	"\tstd::fprintf(file, \"execution: max %lld ns, mean %.1f ns\\n\", stats.max_execution_ns, (double)stats.total_execution_ns/steps);\n"
+	"\tstd::fprintf(file, \"%12s %14s %14s\\n\", \"bin (ns)\", \"lateness\", \"execution\");\n\n"
+	"\tfor(unsigned int k = 0; k < " << bins << "; k++)\n"
+	"\t{\n"
+	"\t\tif(stats.lateness_histogram[k] == 0 && stats.execution_histogram[k] == 0) continue;\n"
+	"\t\tstd::fprintf(file, \"%11lld%c %14llu %14llu\\n\", k*" << model_name << "_realtime_resolution_ns, (k+1 < " << bins << ") ? ' ' : '+', stats.lateness_histogram[k], stats.execution_histogram[k]);\n"
+	"\t}\n"
+	"}\n\n";
+
+	file << "#endif";
+
+	file.close();
+}
+
+/// \brief creates a directory and its missing parents; \return true if the directory exists afterwards
+static bool makeDirectories(const std::string& path)
+{
+	for(std::string::size_type slash = path.find('/', 1); ; slash = path.find('/', slash+1))
+	{
+		std::string dir = path.substr(0, slash);
+
+		if(!dir.empty() && mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) return false;
+
+		if(slash == std::string::npos) break;
+	}
+
+	struct stat st;
+	return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/// \return the given string quoted for use as one word in a POSIX shell command
+static std::string shellQuote(const std::string& word)
+{
+	std::string quoted = "'";
+
+	for(char c : word)
+	{
+		if(c == '\'') quoted += "'\\''";
+		else quoted += c;
+	}
+
+	return quoted + "'";
+}
+
+EngineLibrary SimulationEngineGenerator::compileAndLoad(double zero_bound) const
+{
+	if(parameters.jit_compiler.empty())
+		throw std::invalid_argument("SimulationEngineGenerator::compileAndLoad(): jit_compiler cannot be empty");
+
+	codegen::CodeEmitter source;
+
+	emitCFunctionHeader(source, zero_bound);
+
+	std::vector<std::string> functions;
+	functions.push_back(model_name + "_simulationEngine");
+	if(parameters.multi_step_enable) functions.push_back(model_name + "_simulationEngineSteps");
+	if(stateDefinitionsEnabled())
+	{
+		functions.push_back(model_name + "_initState");
+		functions.push_back(model_name + "_resetState");
+	}
+	if(globalStateEnabled()) functions.push_back(model_name + "_getState");
+	if(parameters.instrumentation_enable)
+	{
+		functions.push_back(model_name + "_getTiming");
+		functions.push_back(model_name + "_resetTiming");
+		functions.push_back(model_name + "_writeTiming");
+	}
+	if(parameters.checkpoint_enable)
+	{
+		functions.push_back(model_name + "_saveState");
+		functions.push_back(model_name + "_restoreState");
+		functions.push_back(model_name + "_saveStateFile");
+		functions.push_back(model_name + "_loadStateFile");
+	}
+	if(parameters.runtime_parameters_enable)
+	{
+		functions.push_back(model_name + "_initParameters");
+		functions.push_back(model_name + "_loadParameters");
+		functions.push_back(model_name + "_loadParametersFile");
+	}
+
+	// only the exports are visible; GCC makes the statics of visible inline functions unique
+	// across the process, so engines of one model loaded together would share their state
+	source << "\n\n#pragma GCC visibility push(default)\n\n";
+
+	source << "extern \"C\"\n{\n";
+	for(const auto& function : functions)
+	{
+		source << "decltype(&" << function << ") " << function << "_symbol = &" << function << ";\n";
+	}
+	source << "}\n";
+
+	source << "\n";
+	emitFlatEngineFunction(source);
+
+	source << "\n#pragma GCC visibility pop\n";
+
+	const std::string code = source.str();
+
+	std::uint64_t hash = hashBytes(parameters.jit_compiler);
+	hash = hashBytes(parameters.jit_compiler_flags, hash);
+	hash = hashBytes(code, hash);
+
+	std::string directory = parameters.jit_cache_directory;
+	if(directory.empty())
+	{
+		const char* tmpdir = std::getenv("TMPDIR");
+		directory = std::string(tmpdir && *tmpdir ? tmpdir : "/tmp") + "/lblmc_jit";
+	}
+
+	if(!makeDirectories(directory))
+		throw std::runtime_error("SimulationEngineGenerator::compileAndLoad(): failed to create cache directory " + directory);
+
+	std::ostringstream stem;
+	stem << directory << "/" << model_name << "_" << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+	const std::string library = stem.str() + ".so";
+
+	if(access(library.c_str(), R_OK) == 0) return EngineLibrary(library);
+
+	const std::string source_file = stem.str() + ".cpp";
+	const std::string log_file = stem.str() + ".log";
+	const std::string partial_library = stem.str() + ".so." + std::to_string(getpid());
+
+	{
+		codegen::CodeEmitter file(source_file);
+		file << code;
+		file.close();
+	}
+
+	const std::string command =
+		parameters.jit_compiler + " " + parameters.jit_compiler_flags + " -shared -fPIC -fvisibility=hidden -o " +
+		shellQuote(partial_library) + " " + shellQuote(source_file) + " > " + shellQuote(log_file) + " 2>&1";
+
+	if(std::system(command.c_str()) != 0)
+	{
+		std::ifstream log(log_file);
+		std::ostringstream output;
+		output << log.rdbuf();
+
+		std::remove(partial_library.c_str());
+
+		throw std::runtime_error("SimulationEngineGenerator::compileAndLoad(): failed to compile " + source_file + ":\n" + output.str());
+	}
+
+	// the library only appears under its final name once complete, for concurrent builds of one model
+	if(std::rename(partial_library.c_str(), library.c_str()) != 0)
+	{
+		std::remove(partial_library.c_str());
+		throw std::runtime_error("SimulationEngineGenerator::compileAndLoad(): failed to store " + library);
+	}
+
+	return EngineLibrary(library);
+}
+
+void SimulationEngineGenerator::emitThreadPool(codegen::CodeEmitter& emitter, const std::string& ns) const
+{
+	emitter << "#include <atomic>\n#include <thread>\n#include <vector>\n";
+	if(parameters.thread_pinning_enable) emitter << "\n#include <pthread.h>\n#include <sched.h>\n";
+	emitter << "\n";
+
+	emitter << "namespace " << ns << "\n{\n\n";
+
+	emitter <<
+	"//spins briefly, then yields the CPU in case threads outnumber the available cores\n"
+	"static inline void cpuRelax(unsigned int& spins)\n"
+	"{\n"
+	"\tif(++spins > 4096)\n"
+	"\t{\n"
+	"\t\tstd::this_thread::yield();\n"
+	"\t\treturn;\n"
+	"\t}\n\n"
+	"#if defined(__x86_64__) || defined(__i386__)\n"
+	"\t__builtin_ia32_pause();\n"
+	"#elif defined(__aarch64__)\n"
+	"\tasm volatile(\"yield\");\n"
+	"#endif\n"
+	"}\n\n";
+
+	emitter <<
+	"//spinning barrier; the last thread to arrive releases the others by advancing the generation\n"
+	"class SpinBarrier\n"
+	"{\n"
+	"private:\n"
+	"\talignas(64) std::atomic<unsigned int> count;\n"
+	"\talignas(64) std::atomic<unsigned int> generation;\n"
+	"\tconst unsigned int num_threads;\n\n"
+	"public:\n"
+	"\texplicit SpinBarrier(unsigned int num_threads) : count(0), generation(0), num_threads(num_threads) {}\n\n"
+	"\tinline void wait()\n"
+	"\t{\n"
+	"\t\tconst unsigned int gen = generation.load(std::memory_order_relaxed);\n\n"
+	"\t\tif(count.fetch_add(1, std::memory_order_acq_rel) == num_threads-1)\n"
+	"\t\t{\n"
+	"\t\t\tcount.store(0, std::memory_order_relaxed);\n"
+	"\t\t\tgeneration.fetch_add(1, std::memory_order_release);\n"
+	"\t\t}\n"
+	"\t\telse\n"
+	"\t\t{\n"
+	"\t\t\tunsigned int spins = 0;\n"
+	"\t\t\twhile(generation.load(std::memory_order_acquire) == gen) cpuRelax(spins);\n"
+	"\t\t}\n"
+	"\t}\n"
+	"};\n\n";
+
+	emitter <<
+	"//persistent workers 1.." << parameters.thread_count-1 << " that spin for the next time step; the calling thread is thread 0\n"
+	"class ThreadPool\n"
+	"{\n"
+	"private:\n"
+	"\talignas(64) std::atomic<unsigned long> job_generation;\n"
+	"\tstd::atomic<bool> stop;\n";
+
+	if(parameters.thread_pinning_enable)
+	{
+		emitter <<
+		"\tstd::atomic<unsigned int> num_started;\n"
+		"\tstd::atomic<int> pinning_error;\n";
+	}
+
+	emitter <<
+	"\tvoid (*job)(void*, unsigned int);\n"
+	"\tvoid* job_context;\n"
+	"\tstd::vector<std::thread> workers;\n\n"
+	"\ttemplate<typename F>\n"
+	"\tstatic void invoke(void* f, unsigned int thread) { (*static_cast<F*>(f))(thread); }\n\n"
+	"\tvoid work(unsigned int thread)\n"
+	"\t{\n";
+
+	if(parameters.thread_pinning_enable)
+	{
+		emitter <<
+		"\t\tcpu_set_t cpus;\n"
+		"\t\tCPU_ZERO(&cpus);\n"
+		"\t\tCPU_SET(" << parameters.thread_cpu_offset << "+thread, &cpus);\n"
+		"\t\tconst int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);\n"
+		"\t\tint no_error = 0;\n"
+		"\t\tif(error != 0) pinning_error.compare_exchange_strong(no_error, error);\n"
+		"\t\tnum_started.fetch_add(1, std::memory_order_release);\n\n";
+	}
+
+	emitter <<
+	"\t\tunsigned long seen = 0;\n\n"
+	"\t\tfor(;;)\n"
+	"\t\t{\n"
+	"\t\t\tunsigned int spins = 0;\n"
+	"\t\t\twhile(job_generation.load(std::memory_order_acquire) == seen)\n"
+	"\t\t\t{\n"
+	"\t\t\t\tif(stop.load(std::memory_order_relaxed)) return;\n"
+	"\t\t\t\tcpuRelax(spins);\n"
+	"\t\t\t}\n\n"
+	"\t\t\tseen++;\n"
+	"\t\t\tjob(job_context, thread);\n"
+	"\t\t}\n"
+	"\t}\n\n"
+	"public:\n"
+	"\tSpinBarrier barrier;\n\n"
+	"\tThreadPool() : job_generation(0), stop(false), " << (parameters.thread_pinning_enable ? "num_started(0), pinning_error(0), " : "") <<
+	"job(0), job_context(0), workers(), barrier(" << parameters.thread_count << ")\n"
+	"\t{\n"
+	"\t\tfor(unsigned int thread = 1; thread < " << parameters.thread_count << "; thread++)\n"
+	"\t\t\tworkers.push_back(std::thread(&ThreadPool::work, this, thread));\n";
+
+	if(parameters.thread_pinning_enable)
+	{
+		emitter <<
+		"\n"
+		"\t\t//wait for the workers to be pinned, so their errors are known\n"
+		"\t\tunsigned int spins = 0;\n"
+		"\t\twhile(num_started.load(std::memory_order_acquire) != " << parameters.thread_count-1 << ") cpuRelax(spins);\n";
+	}
+
+	emitter <<
+	"\t}\n\n"
+	"\t~ThreadPool()\n"
+	"\t{\n"
+	"\t\tstop.store(true);\n"
+	"\t\tfor(auto& worker : workers) worker.join();\n"
+	"\t}\n\n"
+	"\t//runs f(thread) on all threads; f must end with barrier.wait() so all threads finish before returning\n"
+	"\ttemplate<typename F>\n"
+	"\tvoid run(F& f)\n"
+	"\t{\n"
+	"\t\tjob = &invoke<F>;\n"
+	"\t\tjob_context = &f;\n"
+	"\t\tjob_generation.fetch_add(1, std::memory_order_release);\n"
+	"\t\tf(0);\n"
+	"\t}\n";
+
+	if(parameters.thread_pinning_enable)
+	{
+		emitter <<
+		"\n"
+		"\t//0, or the error number of the first worker that could not be pinned and runs unpinned\n"
+		"\tinline int getPinningError() const { return pinning_error.load(); }\n";
+	}
+
+	emitter <<
+	"};\n\n"
+	"//the workers start on first use\n"
+	"inline ThreadPool& getThreadPool()\n"
+	"{\n"
+	"\tstatic ThreadPool pool;\n"
+	"\treturn pool;\n"
+	"}\n\n";
+
+	emitter << "} //namespace " << ns << "\n\n";
+}
+
+std::vector<std::string> SimulationEngineGenerator::generateCFunctionAndExportMultiUnit
+(
+	std::string basename,
+	unsigned int num_component_units,
+	unsigned int num_solver_units,
+	double zero_bound
+) const
+{
+	if(basename == "")
+		throw std::invalid_argument("SimulationEngineGenerator::generateCFunctionAndExportMultiUnit(): basename cannot be null or empty");
+
+	if(num_component_units == 0 || num_solver_units == 0)
+		throw std::invalid_argument("SimulationEngineGenerator::generateCFunctionAndExportMultiUnit(): number of units must be positive nonzero value");
+
+	if(stateStructEnabled() || parameters.runtime_parameters_enable || parameters.io_struct_abi_enable)
+		throw std::runtime_error("SimulationEngineGenerator::generateCFunctionAndExportMultiUnit(): reentrant, batched, runtime parameterized, and struct I/O ABI engines are not supported by multi unit export");
+
+	if(parameters.instrumentation_enable || parameters.checkpoint_enable)
+		throw std::runtime_error("SimulationEngineGenerator::generateCFunctionAndExportMultiUnit(): instrumented and checkpointed engines are not supported by multi unit export");
+
+	if(multiRateEnabled())
+		throw std::runtime_error("SimulationEngineGenerator::generateCFunctionAndExportMultiUnit(): multi-rate engines are not supported by multi unit export");
+
+	if(parameters.thread_count == 0)
+		throw std::invalid_argument("SimulationEngineGenerator::generateCFunctionAndExportMultiUnit(): thread_count must be positive nonzero value");
+
+	const unsigned int num_threads = parameters.thread_count;
+
+	if(num_threads > 1)
+	{
+		num_component_units = num_threads;
+		num_solver_units = num_threads;
+	}
+
+	updateCache(zero_bound);
+
+	SystemSolverGenerator& solver_gen = *cache.solver_gen;
+
+	int rescale_exponent = computeInvConductanceRescaleExponent(*cache.invg_gen, zero_bound);
+	solver_gen.setRescale(rescale_exponent, parameters.fixed_point_enable);
+	solver_gen.setFolding(0);
+
+	unsigned int num_components = source_vector_gen.getNumSources();
+
+	const std::string stem = basename.substr(basename.find_last_of("/\\")+1);
+	const std::string ns = model_name + "_engine";
+	const std::string state_header = stem + "_state.hpp";
+
+	std::vector<std::string> sources;
+
+	//partition component updates by code size, largest first onto the least loaded unit
+
+	num_component_units = std::max(1u, std::min<unsigned int>(num_component_units, comp_update_bodies.size()));
+
+	std::vector< std::vector<unsigned int> > component_units(num_component_units);
+	{
+		std::vector<unsigned int> order(comp_update_bodies.size());
+		for(unsigned int i = 0; i < order.size(); i++) order[i] = i;
+
+		std::stable_sort(order.begin(), order.end(),
+			[this](unsigned int a, unsigned int b) { return comp_update_bodies[a].size() > comp_update_bodies[b].size(); });
+
+		std::vector<std::size_t> load(num_component_units, 0);
+		for(unsigned int i : order)
+		{
+			unsigned int u = std::min_element(load.begin(), load.end()) - load.begin();
+			component_units[u].push_back(i);
+			load[u] += comp_update_bodies[i].size();
+		}
+
+		for(auto& unit : component_units) std::sort(unit.begin(), unit.end());
+	}
+
+	//split solver into contiguous row blocks with about equal number of terms
+
+	std::vector<unsigned int> row_blocks(1, 0);
+	{
+		unsigned long total_terms = solver_gen.getNumberOfTerms();
+		unsigned int r = 0;
+
+		for(unsigned int k = 1; k < num_solver_units; k++)
+		{
+			unsigned long target = total_terms*k/num_solver_units;
+			while(r < num_solutions && solver_gen.getNumberOfTerms(0, r) < target) r++;
+
+			if(r > row_blocks.back() && r < num_solutions) row_blocks.push_back(r);
+		}
+
+		row_blocks.push_back(num_solutions);
+	}
+
+	//split aggregation into blocks of whole statements, one block per thread
+
+	std::vector<std::string> aggregation_blocks;
+	if(num_threads > 1)
+	{
+		std::vector<std::string::size_type> line_ends;
+		for(std::string::size_type pos = cache.aggregation_code.find('\n'); pos != std::string::npos; pos = cache.aggregation_code.find('\n', pos+1))
+		{
+			line_ends.push_back(pos+1);
+		}
+
+		std::string::size_type begin = 0;
+		for(unsigned int k = 0; k < num_threads; k++)
+		{
+			std::string::size_type end = k+1 == num_threads ? cache.aggregation_code.size() : (line_ends.empty() ? 0 : line_ends[line_ends.size()*(k+1)/num_threads - 1]);
+			if(end < begin) end = begin;
+
+			aggregation_blocks.push_back(cache.aggregation_code.substr(begin, end-begin));
+			begin = end;
+		}
+	}
+
+	const std::string parameter_list = generateCFunctionParameterList();
+
+	std::string argument_list;
+	for(const auto& name : parseParameterNames(parameter_list))
+	{
+		if(!argument_list.empty()) argument_list += ", ";
+		argument_list += name;
+	}
+
+	//top-level header
+
+	{
+		codegen::CodeEmitter file(basename + ".hpp");
+
+		emitFileBanner(file);
+
+		file << "#ifndef " << model_name << "_SIMULATIONENGINE_HPP" << "\n";
+		file << "#define " << model_name << "_SIMULATIONENGINE_HPP" << "\n";
+
+		file << "\n\n";
+
+		emitRealTypedef(file);
+
+		file
+		<< "void "<<model_name<<"_simulationEngine\n"
+		<< "(\n"
+		<< parameter_list
+		<< "\n);\n\n";
+
+		if(num_threads > 1 && parameters.thread_pinning_enable)
+		{
+			file << "int " << model_name << "_getThreadPinningError();\n\n";
+		}
+
+		file << "\n#endif";
+
+		file.close();
+	}
+
+	//shared state header
+
+	{
+		codegen::CodeEmitter file(basename + "_state.hpp");
+
+		emitFileBanner(file);
+
+		file << "#ifndef " << model_name << "_SIMULATIONENGINE_STATE_HPP" << "\n";
+		file << "#define " << model_name << "_SIMULATIONENGINE_STATE_HPP" << "\n";
+
+		file << "\n#include \"" << stem << ".hpp\"\n\n";
+
+		file << "namespace " << ns << "\n{\n\n";
+
+		file << "//MODEL PARAMETERS\n\n";
+
+		for(const auto& i : comp_parameters)
+		{
+			file << i << "\n";
+		}
+		file << "\n";
+
+		file << "//COMPONENT FIELDS AND STATES\n\n";
+
+		for(const auto& i : comp_fields)
+		{
+			emitFieldsCode(file, i, false);
+		}
+		file << "\n";
+
+		file << "//MODEL SOLUTIONS\n\n";
+
+		file
+		<< "extern real b["<<num_solutions<<"];\n"
+		<< "extern real x["<<num_solutions+1<<"];\n"
+		<< "extern real b_components["<<num_components<<"];\n\n";
+
+		file << "//INVERTED CONDUCTANCE MATRIX\n\n";
+
+		file << "extern const real inv_g["<<num_solutions<<"]["<<num_solutions<<"];\n\n";
+
+		file << "//ENGINE UNITS\n\n";
+
+		for(unsigned int k = 0; k < component_units.size(); k++)
+		{
+			file << "void updateComponents_" << k << "\n(\n" << parameter_list << "\n);\n\n";
+		}
+
+		if(parameters.io_signal_output_enable)
+		{
+			file << "void updateOutputs\n(\n" << parameter_list << "\n);\n\n";
+		}
+
+		if(num_threads > 1)
+		{
+			for(unsigned int k = 0; k < aggregation_blocks.size(); k++)
+			{
+				file << "void aggregateSources_" << k << "();\n";
+			}
+			file << "\n";
+		}
+		else
+		{
+			file << "void aggregateSources();\n\n";
+		}
+
+		for(unsigned int k = 0; k+1 < row_blocks.size(); k++)
+		{
+			file << "void updateSolutions_" << k << "();\n";
+		}
+
+		file << "\n} //namespace " << ns << "\n";
+
+		file << "\n#endif";
+
+		file.close();
+	}
+
+	//state definitions
+
+	{
+		sources.push_back(basename + "_state.cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		file << "namespace " << ns << "\n{\n\n";
+
+		file << "//COMPONENT FIELDS AND STATES\n\n";
+
+		for(const auto& i : comp_fields)
+		{
+			emitFieldsCode(file, i, true);
+		}
+		file << "\n";
+
+		file << "//MODEL SOLUTIONS\n\n";
+
+		//start each vector on its own cache line; rows of a vector written by different threads
+		//may still share one
+		const char* align = num_threads > 1 ? "alignas(64) " : "";
+
+		file
+		<< align << "real b["<<num_solutions<<"];\n"
+		<< align << "real x["<<num_solutions+1<<"]" << (initial_solutions.empty() ? "" : " = " + initialSolutionsCode()) << ";\n"
+		<< align << "real b_components["<<num_components<<"];\n\n";
+
+		file << "} //namespace " << ns << "\n";
+
+		file.close();
+	}
+
+	//inverted conductance matrix
+
+	{
+		sources.push_back(basename + "_inv_g.cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		file << "namespace " << ns << "\n{\n\n";
+
+		file << "//INVERTED CONDUCTANCE MATRIX\n\n";
+
+		emitInvConductanceLiteral(file, rescale_exponent, "const real");
+		file << "\n";
+
+		file << "} //namespace " << ns << "\n";
+
+		file.close();
+	}
+
+	//component source contribution updates
+
+	for(unsigned int k = 0; k < component_units.size(); k++)
+	{
+		sources.push_back(basename + "_components_" + std::to_string(k) + ".cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		file << "namespace " << ns << "\n{\n\n";
+
+		file << "void updateComponents_" << k << "\n(\n" << parameter_list << "\n)\n{\n";
+
+		file << "//COMPONENT SOURCE CONTRIBUTION UPDATES\n\n";
+
+		for(unsigned int i : component_units[k])
+		{
+			emitUpdateBody(file, comp_update_bodies[i]);
+		}
+
+		file << "\n}\n\n";
+
+		file << "} //namespace " << ns << "\n";
+
+		file.close();
+	}
+
+	//model output signal updates
+
+	if(parameters.io_signal_output_enable)
+	{
+		sources.push_back(basename + "_outputs.cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		file << "namespace " << ns << "\n{\n\n";
+
+		file << "void updateOutputs\n(\n" << parameter_list << "\n)\n{\n";
+
+		file << "//MODEL OUTPUT SIGNAL UPDATES\n\n";
+
+		for(const auto& i : comp_outputs_update_bodies)
+		{
+			emitUpdateBody(file, i);
+		}
+
+		file << "\n}\n\n";
+
+		file << "} //namespace " << ns << "\n";
+
+		file.close();
+	}
+
+	//aggregation of component source contributions
+
+	{
+		sources.push_back(basename + "_aggregate.cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		file << "namespace " << ns << "\n{\n\n";
+
+		if(num_threads > 1)
+		{
+			for(unsigned int k = 0; k < aggregation_blocks.size(); k++)
+			{
+				file << "void aggregateSources_" << k << "()\n{\n";
+
+				file << "//AGGREGRATE COMPONENT SOURCE CONTRIBUTIONS\n\n";
+
+				file << aggregation_blocks[k] << "\n";
+
+				file << "\n}\n\n";
+			}
+		}
+		else
+		{
+			file << "void aggregateSources()\n{\n";
+
+			file << "//AGGREGRATE COMPONENT SOURCE CONTRIBUTIONS\n\n";
+
+			file << cache.aggregation_code << "\n";
+
+			file << "\n}\n\n";
+		}
+
+		file << "} //namespace " << ns << "\n";
+
+		file.close();
+	}
+
+	//solution updates by row block
+
+	for(unsigned int k = 0; k+1 < row_blocks.size(); k++)
+	{
+		sources.push_back(basename + "_solve_" + std::to_string(k) + ".cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		file << "namespace " << ns << "\n{\n\n";
+
+		file << "void updateSolutions_" << k << "()\n{\n";
+
+		file << "//MODEL UPDATE SOLUTIONS " << row_blocks[k]+1 << " TO " << row_blocks[k+1] << "\n\n";
+
+		solver_gen.writeCInlineCode(file.stream(), "inv_g", row_blocks[k], row_blocks[k+1]);
+
+		file << "\n}\n\n";
+
+		file << "} //namespace " << ns << "\n";
+
+		file.close();
+	}
+
+	//top-level step function
+
+	if(num_threads > 1)
+	{
+		sources.push_back(basename + "_engine.cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		emitThreadPool(file, ns);
+
+		file
+		<< "void "<<model_name<<"_simulationEngine\n"
+		<< "(\n"
+		<< parameter_list
+		<< "\n)\n"
+		<< "{\n";
+
+		file
+		<< ns << "::ThreadPool& pool = " << ns << "::getThreadPool();\n\n"
+		<< "auto step = [&](unsigned int thread)\n"
+		<< "{\n";
+
+		file << "\tswitch(thread)\n\t{\n";
+		for(unsigned int k = 0; k < component_units.size(); k++)
+		{
+			file << "\tcase " << k << ": " << ns << "::updateComponents_" << k << "(" << argument_list << "); break;\n";
+		}
+		file << "\t}\n\n";
+
+		file << "\tpool.barrier.wait();\n\n";
+
+		if(parameters.io_signal_output_enable)
+		{
+			file << "\tif(thread == 0) " << ns << "::updateOutputs(" << argument_list << ");\n\n";
+		}
+
+		file << "\tswitch(thread)\n\t{\n";
+		for(unsigned int k = 0; k < aggregation_blocks.size(); k++)
+		{
+			file << "\tcase " << k << ": " << ns << "::aggregateSources_" << k << "(); break;\n";
+		}
+		file << "\t}\n\n";
+
+		file << "\tpool.barrier.wait();\n\n";
+
+		file << "\tswitch(thread)\n\t{\n";
+		for(unsigned int k = 0; k+1 < row_blocks.size(); k++)
+		{
+			file << "\tcase " << k << ": " << ns << "::updateSolutions_" << k << "(); break;\n";
+		}
+		file << "\t}\n\n";
+
+		file << "\tpool.barrier.wait();\n";
+
+		file << "};\n\n";
+
+		file << "pool.run(step);\n\n";
+
+		for(unsigned int i = 0; i < num_solutions; i++)
+		{
+			file << "x_out["<<i<<"] = "<<ns<<"::x["<<i+1<<"];\n";
+		}
+
+		file << "\n}\n";
+
+		if(parameters.thread_pinning_enable)
+		{
+			file
+			<< "\nint " << model_name << "_getThreadPinningError()\n"
+			<< "{\n"
+			<< "return " << ns << "::getThreadPool().getPinningError();\n"
+			<< "}\n";
+		}
+
+		file.close();
+	}
+	else
+	{
+		sources.push_back(basename + "_engine.cpp");
+		codegen::CodeEmitter file(sources.back());
+
+		emitFileBanner(file);
+
+		file << "#include \"" << state_header << "\"\n\n";
+
+		file
+		<< "void "<<model_name<<"_simulationEngine\n"
+		<< "(\n"
+		<< parameter_list
+		<< "\n)\n"
+		<< "{\n";
+
+		for(unsigned int k = 0; k < component_units.size(); k++)
+		{
+			file << ns << "::updateComponents_" << k << "(" << argument_list << ");\n";
+		}
+
+		if(parameters.io_signal_output_enable)
+		{
+			file << ns << "::updateOutputs(" << argument_list << ");\n";
+		}
+
+		file << ns << "::aggregateSources();\n";
+
+		for(unsigned int k = 0; k+1 < row_blocks.size(); k++)
+		{
+			file << ns << "::updateSolutions_" << k << "();\n";
+		}
+
+		file << "\n";
+
+		for(unsigned int i = 0; i < num_solutions; i++)
+		{
+			file << "x_out["<<i<<"] = "<<ns<<"::x["<<i+1<<"];\n";
+		}
+
+		file << "\n}\n";
+
+		file.close();
+	}
 
+	return sources;
 }
 
 } //namespace lblmc
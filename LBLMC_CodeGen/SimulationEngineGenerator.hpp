@@ -24,10 +24,14 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 
 #include <string>
 #include <vector>
+#include <memory>
 
 #include "SystemConductanceGenerator.hpp"
 #include "SystemSourceVectorGenerator.hpp"
 #include "SystemSolverGenerator.hpp"
+#include "EngineLibrary.hpp"
+#include "HLSEstimator.hpp"
+#include "codegen/CodeEmitter.hpp"
 
 namespace lblmc
 {
@@ -45,18 +49,73 @@ struct SimulationEngineGeneratorParameters
 	unsigned int xilinx_hls_latency_min;  ///< set minimum number of clock cycles to execute; default is 0
 	unsigned int xilinx_hls_latency_max;  ///< set maximum number of clock cycles to execute; default is 0
 	bool         xilinx_hls_inline;       ///< enable inlining of the generated code into top-level design; default is true
+	bool         xilinx_hls_directives_enable; ///< enable emission of the array partitioning, pipelining, and resource directives planned by planHLSDirectives(); default is false
+	double       xilinx_hls_step_period;  ///< set target execution period of one time step, from which the clock cycle budget is derived; 0 for no target; default is 0
+	unsigned int xilinx_hls_multiplier_limit; ///< set maximum number of multiplier instances; 0 derives the limit from the clock cycle budget; default is 0
+	unsigned int xilinx_hls_partition_limit;  ///< set largest array size that is completely partitioned into registers; larger arrays are cyclically partitioned; default is 256
+	unsigned int xilinx_hls_solver_lanes;     ///< set number of multiplier lanes the solver is folded onto, each accumulating whole rows from coefficient ROMs; 0 for a fully parallel solver; default is 0
+	std::string  xilinx_hls_stream_interface; ///< set protocol of the <model>_simulationEngineStream() wrapper that packs the engine signals into one input and one output stream word, "axis" (AXI4-Stream) or "ap_fifo"; empty for no stream wrapper; default is empty
 
 	// Fixed Point settings
-	bool         fixed_point_enable;         ///< enable use of fixed point for real numbers; default is false
+	bool         fixed_point_enable;         ///< enable use of fixed point for real numbers, ap_fixed with Xilinx HLS and otherwise the bit accurate portable lblmc_fixed type from getFixedPointTypeCode(); default is false
 	unsigned int fixed_point_word_width;  ///< set word width in bits of the fixed point words; default is 64
 	unsigned int fixed_point_int_width;   ///< set the integral width in bits of the fixed point words; default is 32
+	bool         fixed_point_saturation_enable; ///< enable saturation (AP_SAT) instead of wrapping (AP_WRAP) of fixed point results that overflow; default is false
 
 	// Inverted Conductance Matrix Optimizations
 	bool inv_conduct_matrix_rescale_enable;     ///< enable rescaling of the inverted conductance matrix by a power of 2 scalar; default is false
-	unsigned int inv_conduct_matrix_divider; ///< set power of 2 divider scalar for the inverted conductance matrix; default is 2
+	unsigned int inv_conduct_matrix_divider; ///< set power of 2 divider scalar for the inverted conductance matrix; 0 selects the divider automatically from the matrix range and fixed_point_int_width; default is 0
+
+	// Source Vector Optimizations
+	bool source_slot_reorder_enable; ///< enable renumbering of b_components slots so sources are contiguous by node; default is false
+
+	// Engine Interface settings
+	bool reentrant_engine_enable; ///< enable generation of a reentrant engine that keeps its state in a <model>_State struct passed by pointer; default is false
+
+	// Checkpoint settings
+	bool checkpoint_enable; ///< enable generation of <model>_saveState() and <model>_restoreState() that checkpoint the complete engine state to a versioned binary snapshot; non-reentrant engines keep their state in the global <model>_State of <model>_getState(); default is false
+
+	// Runtime Parameter settings
+	bool runtime_parameters_enable; ///< enable keeping the component parameters and inverted conductance matrix in a <model>_Parameters struct loadable at runtime; default is false
+
+	// Multi-Step Engine settings
+	bool multi_step_enable; ///< enable generation of <model>_simulationEngineSteps() that runs many time steps per call; default is false
+	unsigned int multi_step_output_decimation; ///< set number of time steps per recorded output of <model>_simulationEngineSteps(); default is 1
+
+	// Batched Engine settings
+	unsigned int batch_lanes;    ///< set number of independent model instances (lanes) advanced together by a batched engine with structure-of-arrays state; 1 generates an unbatched engine; default is 1
+	std::string  batch_simd_isa; ///< set instruction set the batched engine function is compiled for as a GCC/Clang target attribute, e.g. "avx2" or "avx512f"; empty for the compiler's default; default is empty
+
+	// Threaded Engine settings
+	unsigned int thread_count;       ///< set number of threads the engine of generateCFunctionAndExportMultiUnit() runs each time step on; 1 runs all units on the calling thread; default is 1
+	bool         thread_pinning_enable; ///< enable pinning of engine worker thread k to CPU thread_cpu_offset+k; default is false
+	unsigned int thread_cpu_offset;  ///< set first CPU that engine threads are pinned to; default is 0
 
 	// Input/Output Signal settings
 	bool io_signal_output_enable;  ///< enable use of output signals; default is true
+	bool io_struct_abi_enable;     ///< enable passing of all input and output signals in one <model>_Inputs and one <model>_Outputs block instead of one argument per signal; default is false
+	unsigned int io_struct_alignment; ///< set alignment in bytes of the input and output blocks; 0 for natural alignment; default is 64
+	bool io_struct_solutions_in_place; ///< enable use of the output block's solution vector as the engine's own solution storage, removing the copy to x_out; default is false
+
+	// Instrumentation settings
+	bool         instrumentation_enable;  ///< enable timing probes around the engine sections that accumulate into the <model>_Timing counters returned by <model>_getTiming(), per thread for reentrant engines; disabled engines contain no probes; default is false
+	std::string  instrumentation_clock;   ///< set time source of the probes, "clock_gettime" (CLOCK_MONOTONIC nanoseconds) or "tsc" (x86 time stamp counter ticks); default is "clock_gettime"
+	bool         instrumentation_per_component; ///< enable separate counters for the update and output update code of each component; default is false
+	unsigned int instrumentation_histogram_buckets; ///< set number of power of 2 histogram buckets of each counter; default is 32
+
+	// Real-Time Runner settings
+	double       realtime_step_period;    ///< set wall-clock period of one time step of the real-time runner; 0 uses the model's time step DT; default is 0
+	bool         realtime_pinning_enable; ///< enable pinning of the real-time runner's thread to CPU realtime_cpu; default is true
+	unsigned int realtime_cpu;            ///< set CPU, ideally isolated from the scheduler, that the real-time runner is pinned to; default is 1
+	unsigned int realtime_fifo_priority;  ///< set SCHED_FIFO priority of the real-time runner; 0 keeps the default scheduling policy; default is 0
+	std::string  realtime_pacing;         ///< set how the real-time runner waits for each step's deadline, "nanosleep" (absolute clock_nanosleep) or "busy_wait"; default is "nanosleep"
+	unsigned int realtime_histogram_bins; ///< set number of bins of the real-time runner's jitter and execution time histograms; default is 100
+	double       realtime_histogram_resolution; ///< set width in seconds of a histogram bin of the real-time runner; default is 100e-9 (100ns)
+
+	// JIT Compilation settings
+	std::string jit_compiler;        ///< set C++ compiler command used by compileAndLoad(); default is "c++"
+	std::string jit_compiler_flags;  ///< set flags passed to the compiler by compileAndLoad(), in addition to -shared -fPIC -fvisibility=hidden; default is "-O2 -std=c++11"
+	std::string jit_cache_directory; ///< set directory where compileAndLoad() keeps built engines; empty for lblmc_jit in $TMPDIR or /tmp; default is empty
 
 	SimulationEngineGeneratorParameters() :
 		xilinx_hls_enable(false),
@@ -65,16 +124,89 @@ struct SimulationEngineGeneratorParameters
 		xilinx_hls_latency_min(0),
 		xilinx_hls_latency_max(0),
 		xilinx_hls_inline(true),
+		xilinx_hls_directives_enable(false),
+		xilinx_hls_step_period(0.0),
+		xilinx_hls_multiplier_limit(0),
+		xilinx_hls_partition_limit(256),
+		xilinx_hls_solver_lanes(0),
+		xilinx_hls_stream_interface(),
 		fixed_point_enable(false),
         fixed_point_word_width(64),
         fixed_point_int_width(32),
+		fixed_point_saturation_enable(false),
 		inv_conduct_matrix_rescale_enable(false),
-        inv_conduct_matrix_divider(2),
-		io_signal_output_enable(true)
+        inv_conduct_matrix_divider(0),
+		source_slot_reorder_enable(false),
+		reentrant_engine_enable(false),
+		checkpoint_enable(false),
+		runtime_parameters_enable(false),
+		multi_step_enable(false),
+		multi_step_output_decimation(1),
+		batch_lanes(1),
+		batch_simd_isa(),
+		thread_count(1),
+		thread_pinning_enable(false),
+		thread_cpu_offset(0),
+		io_signal_output_enable(true),
+		io_struct_abi_enable(false),
+		io_struct_alignment(64),
+		io_struct_solutions_in_place(false),
+		instrumentation_enable(false),
+		instrumentation_clock("clock_gettime"),
+		instrumentation_per_component(false),
+		instrumentation_histogram_buckets(32),
+		realtime_step_period(0.0),
+		realtime_pinning_enable(true),
+		realtime_cpu(1),
+		realtime_fifo_priority(0),
+		realtime_pacing("nanosleep"),
+		realtime_histogram_bins(100),
+		realtime_histogram_resolution(100.0e-9),
+		jit_compiler("c++"),
+		jit_compiler_flags("-O2 -std=c++11"),
+		jit_cache_directory()
 	{}
 
 };
 
+/**
+	\brief Xilinx HLS directives planned for a simulation engine from its size and the clock period
+
+	\see SimulationEngineGenerator::planHLSDirectives()
+**/
+struct HLSDirectivePlan
+{
+	unsigned int solver_terms;       ///< number of multiply-accumulate terms in the pruned solver
+	unsigned int solver_depth;       ///< largest number of terms in one solver row
+	unsigned int cycle_budget;       ///< clock cycles available per time step; 0 if unconstrained
+	unsigned int pipeline_ii;        ///< initiation interval of the engine pipeline; 0 to not pipeline
+	unsigned int multiplier_limit;   ///< maximum number of multiplier instances; 0 if unlimited
+	unsigned int multiplier_latency; ///< pipeline stages of one multiplier at the clock period
+	unsigned int partition_factor;   ///< cyclic partition factor of arrays too large to completely partition
+	unsigned int solver_lanes;       ///< number of multiplier lanes the solver is folded onto; 0 if fully parallel
+	unsigned int solver_interleave;  ///< number of rows each lane of a folded solver accumulates at once
+	unsigned int solver_cycles;      ///< number of cycles the solver issues its terms over
+	unsigned int solver_latency;     ///< estimated latency of the solver in clock cycles
+	std::string  multiplier_op;      ///< multiplication operation bound; "mul" for fixed point, "dmul" for double
+	std::string  multiplier_impl;    ///< implementation the products of the folded solver lanes are bound to; empty if not bound
+
+	HLSDirectivePlan() :
+		solver_terms(0),
+		solver_depth(0),
+		cycle_budget(0),
+		pipeline_ii(0),
+		multiplier_limit(0),
+		multiplier_latency(0),
+		partition_factor(1),
+		solver_lanes(0),
+		solver_interleave(1),
+		solver_cycles(0),
+		solver_latency(0),
+		multiplier_op(),
+		multiplier_impl()
+	{}
+};
+
 /**
 	\brief Generates top-level code for a LB-LMC simulation solver engine
 
@@ -98,11 +230,471 @@ private:
 	std::vector<std::string> comp_outputs;
 	std::vector<std::string> comp_outputs_update_bodies;
 	std::vector<std::string> comp_update_bodies;
+	std::vector<unsigned int> comp_update_rates; ///< update rate of each update body in base time steps
 	SystemConductanceGenerator conductance_matrix_gen;
 	SystemSourceVectorGenerator source_vector_gen;
+	std::vector<double> initial_solutions; ///< solutions the engine starts from; empty for all zero
 
 	SimulationEngineGeneratorParameters parameters;
 
+	/**
+		\brief memoized generation state shared by the generate and emit methods
+
+		The inverted conductance matrix, the pruned solver plan, and the source aggregation code
+		are kept between calls and rebuilt only when the conductance stamps, the sources, the
+		zero bound, or the relevant parameters they were built from change.  Copies of the cache
+		are empty so copied generators never share state.
+	**/
+	struct GenerationCache
+	{
+		unsigned long conductance_revision; ///< revision of the conductance matrix invg_gen was built from; 0 if not built
+		std::unique_ptr<SystemConductanceGenerator> invg_gen; ///< unscaled inverted conductance matrix
+		std::unique_ptr<SystemSolverGenerator> solver_gen; ///< solver with pruned plan over invg_gen
+		double zero_bound; ///< zero bound solver_gen was built with
+		unsigned long source_revision; ///< revision of the source vector the aggregation was built from; 0 if not built
+		bool source_slot_reorder_enable; ///< whether the aggregation was built with reordered source slots
+		std::vector<unsigned int> slot_map; ///< map of old to new source indices; empty if not reordered
+		std::string aggregation_code; ///< inline source aggregation code
+
+		GenerationCache() :
+			conductance_revision(0), invg_gen(), solver_gen(), zero_bound(0.0),
+			source_revision(0), source_slot_reorder_enable(false), slot_map(), aggregation_code()
+		{}
+
+		GenerationCache(const GenerationCache&) : GenerationCache() {}
+
+		inline GenerationCache& operator=(const GenerationCache&) { clear(); return *this; }
+
+		inline void clear()
+		{
+			conductance_revision = 0;
+			invg_gen.reset();
+			solver_gen.reset();
+			source_revision = 0;
+			slot_map.clear();
+			aggregation_code.clear();
+		}
+	};
+
+	mutable GenerationCache cache;
+
+	/**
+		\brief brings the generation cache up to date with the current stamps, sources, and parameters
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+	**/
+	void updateCache(double zero_bound) const;
+
+	/**
+		\brief determines power of 2 exponent s for rescaling the inverted conductance matrix as inv_g/2^s
+
+		If parameter inv_conduct_matrix_divider is nonzero, s = log2(inv_conduct_matrix_divider).
+		Otherwise, s is chosen such that the largest magnitude element of inv_g, after rescaling,
+		lies in [2^(I-2), 2^(I-1)) where I is fixed_point_int_width, so the fixed point
+		coefficients use the full word width.
+
+		\param invg the inverted conductance matrix generator
+		\param zero_bound elements of inv_g within zero_bound of zero are ignored
+		\return the power of 2 exponent s; 0 if rescaling is disabled
+		\throw std::runtime_error if inv_conduct_matrix_divider is not 0 or a power of 2
+	**/
+	int computeInvConductanceRescaleExponent(const SystemConductanceGenerator& invg, double zero_bound) const;
+
+	/**
+		\brief computes how many rows each lane of a folded solver accumulates at once so a lane can
+		issue a term every cycle
+
+		The accumulating adder is estimated at 2 ns for fixed point and 10 ns for doubles, as the
+		default HLSEstimatorParameters, and each row's accumulator is reused only after the adder
+		has finished.
+
+		\return adder latency in cycles at xilinx_hls_clock_period; at least 1
+	**/
+	unsigned int computeSolverInterleave() const;
+
+	/**
+		\brief writes code to a stream with references to b_components[k] rewritten to use renumbered source slots
+
+		\param strm the stream to write the rewritten code to
+		\param code C++ code referring to source contribution slots b_components[k]
+		\param slot_map map of old to new source indices as returned by
+		SystemSourceVectorGenerator::reorderSources(); slot k is source index k+1
+	**/
+	static void writeRemappedSourceSlots(std::ostream& strm, const std::string& code, const std::vector<unsigned int>& slot_map);
+
+	/**
+		\param code C++ code referring to source contribution slots b_components[k]
+		\return the slots k the code refers to, in order of first reference
+	**/
+	static std::vector<unsigned int> parseSourceSlots(const std::string& code);
+
+	/**
+		\return true if any component update body has an update rate slower than the base time step
+	**/
+	bool multiRateEnabled() const;
+
+	/**
+		\return number of base time steps after which the schedule of the multi-rate updates repeats
+		\throw std::runtime_error if the schedule is longer than 65536 steps
+	**/
+	unsigned int multiRateHyperperiod() const;
+
+	/**
+		\return fields code of the multi-rate schedule: the step counter multirate_step and the held
+		source contributions multirate_hold_k of the slow updates; empty if not multi-rate
+	**/
+	std::string multiRateFieldsCode() const;
+
+	/**
+		\return the component fields code followed by the generator's own fields of the engine
+	**/
+	std::vector<std::string> engineFieldsCode() const;
+
+	/**
+		\brief emits the inverted conductance matrix literal inv_g from the generation cache, rescaled by 2^(-rescale_exponent)
+		\param emitter the code emitter that the literal is written to
+		\param rescale_exponent power of 2 exponent s that inv_g is rescaled by as inv_g/2^s
+		\param decl_specifiers declaration specifiers and type of the literal array
+	**/
+	void emitInvConductanceLiteral(codegen::CodeEmitter& emitter, int rescale_exponent, const char* decl_specifiers) const;
+
+	/**
+		\brief emits a component update body, renumbering source slots if the generation cache has a slot map
+	**/
+	void emitUpdateBody(codegen::CodeEmitter& emitter, const std::string& code) const;
+
+	/**
+		\brief emits the typedef of the real number type used by the generated engine
+	**/
+	void emitRealTypedef(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits the comment banner at the top of generated files
+	**/
+	static void emitFileBanner(codegen::CodeEmitter& emitter);
+
+	/**
+		\brief declaration of a component field parsed from component fields code
+	**/
+	struct FieldDeclaration
+	{
+		std::string type;    ///< type of the field, e.g. "real"
+		std::string name;    ///< name of the field
+		std::string extents; ///< array extents of the field, e.g. "[3]"; empty if not an array
+		std::string value;   ///< initial value of the field; empty if not initialized
+	};
+
+	/**
+		\brief declaration of a parameter parsed from a C++ function parameter list
+	**/
+	struct ParameterDeclaration
+	{
+		std::string type;    ///< type of the parameter including any trailing * or &, e.g. "real *"
+		std::string name;    ///< name of the parameter
+		std::string extents; ///< array extents of the parameter, e.g. "[3]"; empty if not an array
+	};
+
+	/**
+		\brief parses a C++ function parameter list into parameter declarations
+		\param parameter_list comma separated parameter list, such as component input or output code
+		\return declarations of the parameters in order
+		\throw std::runtime_error if a parameter has no name
+	**/
+	static std::vector<ParameterDeclaration> parseParameterList(const std::string& parameter_list);
+
+	/**
+		\return true if the generated engine keeps its state in a <model>_State struct
+	**/
+	inline bool stateStructEnabled() const
+	{
+		return parameters.reentrant_engine_enable || parameters.batch_lanes > 1;
+	}
+
+	/**
+		\return true if a non-reentrant engine keeps its state in the global <model>_State returned
+		by <model>_getState(), which checkpointed and multi-step engines share with the engine
+	**/
+	inline bool globalStateEnabled() const
+	{
+		return !stateStructEnabled() && (parameters.checkpoint_enable || parameters.multi_step_enable);
+	}
+
+	/**
+		\return true if the generated code defines a <model>_State struct, either passed to the
+		engine or global for a checkpointed or multi-step non-reentrant engine
+	**/
+	inline bool stateDefinitionsEnabled() const
+	{
+		return stateStructEnabled() || globalStateEnabled();
+	}
+
+	/**
+		\return true if the unbatched engine binds its fields and solutions to the members of the
+		<model>_State pointed to by a variable named state
+	**/
+	inline bool stateBindingEnabled() const
+	{
+		return parameters.reentrant_engine_enable || globalStateEnabled();
+	}
+
+	/**
+		\return declarations of the component input signals of the engine
+	**/
+	std::vector<ParameterDeclaration> parseInputs() const;
+
+	/**
+		\return declarations of the component output signals of the engine; empty if output signals are disabled
+	**/
+	std::vector<ParameterDeclaration> parseOutputs() const;
+
+	/**
+		\return declarations of the component output (if enabled) and input signals of the engine
+	**/
+	std::vector<ParameterDeclaration> parseSignals() const;
+
+	/**
+		\return type of the value a signal refers to; the signal's type without any trailing * or &
+		unless the signal is an array
+	**/
+	static std::string signalValueType(const ParameterDeclaration& signal);
+
+	/**
+		\return number of values held by a signal; the product of its array extents, or 1
+	**/
+	static unsigned int signalSize(const ParameterDeclaration& signal);
+
+	/**
+		\brief emits the spinning barrier and worker thread pool of a threaded multi unit engine
+
+		\param emitter the code emitter that the definitions are written to
+		\param ns namespace of the engine units that the definitions are placed in
+	**/
+	void emitThreadPool(codegen::CodeEmitter& emitter, const std::string& ns) const;
+
+	/**
+		\brief emits the planned Xilinx HLS pipeline and allocation directives of the engine
+		function body
+	**/
+	void emitHLSFunctionDirectives(codegen::CodeEmitter& emitter, const HLSDirectivePlan& plan) const;
+
+	/**
+		\brief emits the planned Xilinx HLS array partition directives; must follow the declarations
+		of the solutions and the inverted conductance matrix
+	**/
+	void emitHLSArrayDirectives(codegen::CodeEmitter& emitter, const HLSDirectivePlan& plan) const;
+
+	/**
+		\brief emits <model>_simulationEngineFlat(), a wrapper of the engine function that takes all
+		signals as flat arrays of doubles, and <model>_signalLayout describing those arrays
+
+		Used by compileAndLoad() so engines of any signature can be driven generically.  Reentrant
+		and runtime parameterized engines are run on a state and parameters owned by the wrapper,
+		and struct I/O ABI engines on I/O blocks owned by the wrapper.  Every lane of a batched
+		engine is given the same inputs, and the solutions and outputs of lane 0 are returned; a
+		solution on which the lanes disagree is returned as NaN.
+
+		\param emitter the code emitter that the wrapper is written to
+	**/
+	void emitFlatEngineFunction(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief signal packed into a stream word of the stream engine wrapper
+	**/
+	struct StreamField
+	{
+		std::string name;       ///< name of the signal
+		std::string value_type; ///< type of the signal's elements; bool or real
+		unsigned int size;      ///< number of elements of the signal
+		unsigned int offset;    ///< byte offset of the signal's first element in the word
+	};
+
+	/**
+		\return number of bytes an element of given type occupies in a stream word
+		\throw std::runtime_error if the type is neither bool nor real
+	**/
+	unsigned int streamElementBytes(const std::string& value_type) const;
+
+	/**
+		\brief lays out the elements of signals back to back, without padding, in a stream word
+		\param signals the signals packed into the word
+		\param solutions if true, the solutions x_out are packed first
+		\param word_bytes set to the size of the word in bytes
+		\return the fields of the word in order
+	**/
+	std::vector<StreamField> layoutStreamWord
+	(
+		const std::vector<ParameterDeclaration>& signals,
+		bool solutions,
+		unsigned int& word_bytes
+	) const;
+
+	/**
+		\brief emits the byte layout of the input and output stream words as constants usable by
+		both the host and the engine
+	**/
+	void emitStreamLayout(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits <model>_simulationEngineStream(), which reads the engine inputs from one input
+		stream word per time step and writes the solutions and outputs as one output stream word
+	**/
+	void emitStreamEngineFunction(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits the parameter list of the batched engine function
+
+		Each component signal becomes an array of batch_lanes elements named <signal>_lanes, and
+		x_out becomes x_out[num_solutions][batch_lanes].
+	**/
+	void emitBatchedCFunctionParameterList(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits the opening of a loop over the lanes of a batched engine, binding the lane's
+		elements of the solution vectors and, optionally, the component fields and signals to the
+		names used by the component code
+	**/
+	void emitLaneLoopBegin(codegen::CodeEmitter& emitter, bool bind_components) const;
+
+	/**
+		\brief emits inline code of the batched engine
+		\see emitCInlineCode()
+	**/
+	void emitBatchedCInlineCode(codegen::CodeEmitter& emitter, double zero_bound) const;
+
+	/**
+		\brief parses component fields code into field declarations
+
+		Lines of the form "static type name = value;" are parsed into declarations.  Other lines,
+		such as comments, are skipped.
+
+		\param code component fields code as given to insertComponentFieldsCode()
+		\param constant true to parse constant declarations "const static type name = value;" as
+		given to insertComponentParametersCode() instead
+		\return declarations of the fields in order
+		\throw std::runtime_error if a static field line has no type or name
+	**/
+	static std::vector<FieldDeclaration> parseFieldsCode(const std::string& code, bool constant = false);
+
+	/**
+		\return declarations of all component parameters in order
+	**/
+	std::vector<FieldDeclaration> parseParameters() const;
+
+	/**
+		\brief emits the component parameters section of the engine; as literals, or as references
+		to the members of the <model>_Parameters pointed to by params when runtime parameters are enabled
+	**/
+	void emitModelParameters(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits the inverted conductance matrix section of the engine; as a literal, or as a
+		reference to the member of <model>_Parameters when runtime parameters are enabled
+	**/
+	void emitInvConductance(codegen::CodeEmitter& emitter, int rescale_exponent) const;
+
+	/**
+		\brief checks that the combination of generator parameters is supported
+		\throw std::runtime_error if the parameters enable features that cannot be combined
+	**/
+	void checkParameters() const;
+
+	/**
+		\brief emits the <model>_Inputs and <model>_Outputs blocks and their layout for the struct I/O ABI
+	**/
+	void emitIODefinitions(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits bindings of the component signal names to the members of the input and output
+		blocks in and out for the struct I/O ABI
+	**/
+	void emitIOBindings(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits the <model>_SectionTiming and <model>_Timing counters, the probe time source,
+		and the functions that record, reset and report the counters of an instrumented engine
+	**/
+	void emitTimingDefinitions(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits the start of a timing probe, storing the current time in variable probe;
+		emits nothing if instrumentation is disabled
+	**/
+	void emitTimingBegin(codegen::CodeEmitter& emitter, const std::string& probe) const;
+
+	/**
+		\brief emits the end of a timing probe, recording the time elapsed since probe started into
+		the <model>_Timing member counter; emits nothing if instrumentation is disabled
+	**/
+	void emitTimingEnd(codegen::CodeEmitter& emitter, const std::string& probe, const std::string& counter) const;
+
+	/**
+		\brief emits component update bodies wrapped by a probe into the <model>_Timing section
+		counter and, with instrumentation_per_component, a probe per body into component_counter[]
+
+		If scheduled is set, the bodies are the component update bodies, and those with a slower
+		update rate run only on their phase of the multi-rate schedule and hold their source
+		contributions otherwise; the schedule's step counter is advanced after the bodies.
+	**/
+	void emitTimedUpdateBodies
+	(
+		codegen::CodeEmitter& emitter,
+		const std::vector<std::string>& bodies,
+		const std::string& section,
+		const std::string& component_counter,
+		bool scheduled = false
+	) const;
+
+	/**
+		\brief emits the <model>_Parameters struct and its initialization and loading functions
+		for engines with runtime parameters
+	**/
+	void emitParameterDefinitions(codegen::CodeEmitter& emitter, double zero_bound) const;
+
+	/**
+		\brief emits the <model>_State struct and its initialization functions for reentrant engines
+	**/
+	void emitStateDefinitions(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\return brace initializer list of the solutions x, ground first, from the initial solutions
+	**/
+	std::string initialSolutionsCode() const;
+
+	/**
+		\brief emits the functions that save and restore a <model>_State as a versioned binary
+		snapshot for checkpointed engines
+	**/
+	void emitCheckpointDefinitions(codegen::CodeEmitter& emitter) const;
+
+	/**
+		\brief emits the multi-step engine function definition <model>_simulationEngineSteps()
+	**/
+	void emitMultiStepFunction(codegen::CodeEmitter& emitter, double zero_bound) const;
+
+	/**
+		\brief emits the engine function definition without any preceding state definitions
+	**/
+	void emitEngineFunction(codegen::CodeEmitter& emitter, double zero_bound) const;
+
+	/**
+		\brief emits component fields code as namespace scope declarations or definitions
+
+		Fields "static type name = value;" are emitted as "extern type name;" when declaring, or as
+		"type name = value;" when defining.
+
+		\param emitter the code emitter that the code is written to
+		\param code component fields code as given to insertComponentFieldsCode()
+		\param definition true to emit definitions; false to emit extern declarations
+	**/
+	static void emitFieldsCode(codegen::CodeEmitter& emitter, const std::string& code, bool definition);
+
+	/**
+		\brief extracts the names of the parameters in a C++ function parameter list
+		\param parameter_list parameter list as generated by generateCFunctionParameterList()
+		\return names of the parameters in order
+		\throw std::runtime_error if a parameter has no name
+	**/
+	static std::vector<std::string> parseParameterNames(const std::string& parameter_list);
+
 public:
 
 	/**
@@ -153,6 +745,15 @@ public:
 
 	const SimulationEngineGeneratorParameters& getParameters() const { return parameters; }
 
+	/**
+		\brief discards the memoized inverted conductance matrix, solver plan, and aggregation code
+
+		The generator tracks changes made through the conductance matrix and source vector
+		generators automatically.  This method is only needed after modifying the conductance
+		matrix through an observer pointer or matrix reference taken before the last generation.
+	**/
+	inline void invalidateCache() { cache.clear(); }
+
 	/**
 		\return reference to generator's internal Conductance Matrix generator
 	**/
@@ -178,6 +779,19 @@ public:
 	**/
 	void insertComponentParametersCode(std::string& code);
 
+	/**
+		\brief moves C++ code string into the generator; same as insertComponentParametersCode(std::string&) without copying the code
+	**/
+	void insertComponentParametersCode(std::string&& code);
+
+	/**
+		\brief removes all component parameters code from the generator
+
+		Used with insertComponentParametersCode() to replace the parameters of the components
+		after their values change, without regenerating the rest of the engine's code.
+	**/
+	inline void clearComponentParametersCode() { comp_parameters.clear(); }
+
 	/**
 		\brief inserts C++ code string for a component's fields (internal variables and states)
 
@@ -193,6 +807,39 @@ public:
 	**/
 	void insertComponentFieldsCode(std::string& code);
 
+	/**
+		\brief moves C++ code string into the generator; same as insertComponentFieldsCode(std::string&) without copying the code
+	**/
+	void insertComponentFieldsCode(std::string&& code);
+
+	/**
+		\brief removes all component fields code from the generator
+
+		Used with insertComponentFieldsCode() to replace the initial values of the components'
+		fields, such as when the model is initialized at its operating point.
+	**/
+	inline void clearComponentFieldsCode() { comp_fields.clear(); }
+
+	/**
+		\brief sets the solutions the generated engine starts from, instead of all zero
+
+		The solutions are the node voltages and branch currents of the previous step that the
+		components read in the first step, so a model whose fields are initialized at an operating
+		point must start from the solutions of the same operating point.  The initial solutions
+		are cleared by reset().
+
+		\param solutions the num_solutions initial solutions, without ground; empty for all zero
+		\throw std::invalid_argument if solutions is not empty and not of num_solutions size
+
+		\see SystemModel::initializeOperatingPoint()
+	**/
+	void setInitialSolutions(const std::vector<double>& solutions);
+
+	/**
+		\return the solutions the generated engine starts from, without ground; empty for all zero
+	**/
+	inline const std::vector<double>& getInitialSolutions() const { return initial_solutions; }
+
 	/**
 		\brief inserts C++ code string for a component's non-system-solution input signals
 
@@ -212,6 +859,11 @@ public:
 	**/
 	void insertComponentInputsCode(std::string& code);
 
+	/**
+		\brief moves C++ code string into the generator; same as insertComponentInputsCode(std::string&) without copying the code
+	**/
+	void insertComponentInputsCode(std::string&& code);
+
 	/**
 		\brief inserts C++ code string for a component's non-source-contribution output signals
 
@@ -231,6 +883,11 @@ public:
 	**/
 	void insertComponentOutputsCode(std::string& code);
 
+	/**
+		\brief moves C++ code string into the generator; same as insertComponentOutputsCode(std::string&) without copying the code
+	**/
+	void insertComponentOutputsCode(std::string&& code);
+
 	/**
 		\brief insertes C++ code string for a component's update method body for its output signals
 
@@ -241,6 +898,11 @@ public:
 	**/
 	void insertComponentOutputsUpdateBody(std::string& code);
 
+	/**
+		\brief moves C++ code string into the generator; same as insertComponentOutputsUpdateBody(std::string&) without copying the code
+	**/
+	void insertComponentOutputsUpdateBody(std::string&& code);
+
 	/**
 		\brief inserts C++ code string for a component's update method body
 
@@ -255,9 +917,43 @@ public:
 		current_component_out = bc[5];
 		</pre>
 
+		A component whose time step DT is a multiple of the model's base time step can be given
+		that multiple as its update rate.  Its update code then runs only every rate steps, and its
+		source contributions are held in between; the network is still solved every step.  The
+		slow updates are spread over the steps by planUpdatePhases() so no step runs all of them.
+		Slow update code must only depend on its own fields, the solutions, and the inputs.
+
 		\param code string containing code for a component's update method body in valid C++
+		\param rate number of base time steps between updates of the component
+		\throw std::invalid_argument if rate is zero
 	**/
-	void insertComponentUpdateBody(std::string& code);
+	void insertComponentUpdateBody(std::string& code, unsigned int rate = 1);
+
+	/**
+		\brief moves C++ code string into the generator; same as insertComponentUpdateBody(std::string&, unsigned int) without copying the code
+	**/
+	void insertComponentUpdateBody(std::string&& code, unsigned int rate = 1);
+
+	/**
+		\return update rate of each component update body in base time steps, in order of insertion
+	**/
+	inline const std::vector<unsigned int>& getComponentUpdateRates() const { return comp_update_rates; }
+
+	/**
+		\brief plans the phases of the multi-rate schedule of the component updates
+
+		A component update body with rate k runs on the steps whose index modulo k equals its
+		phase.  The phases are chosen greedily, largest update first by code size, to keep the
+		most update code run in any one step as small as possible.  The first step of the engine
+		runs every update to initialize the held source contributions and counts as step 0 of the
+		schedule, so an update on phase 0 runs next at step k, while an update on phase p runs
+		next at step p, after a first interval p steps long.
+
+		\return phase of each component update body, in order of insertion; 0 for bodies updated
+		every step
+		\throw std::runtime_error if the schedule repeats only after more than 65536 steps
+	**/
+	std::vector<unsigned int> planUpdatePhases() const;
 
 	/**
 		\brief generates valid parameter (argument) list for the simulation engine top-level function
@@ -270,20 +966,210 @@ public:
 	**/
 	std::string generateCFunctionParameterList() const;
 
+	/**
+		\brief emits valid parameter (argument) list for the simulation engine top-level function
+		\param emitter the code emitter that the parameter list is written to
+		\see generateCFunctionParameterList()
+	**/
+	void emitCFunctionParameterList(codegen::CodeEmitter& emitter) const;
+
 	/**
 		\brief generates valid C++ code string of the simulation engine that can be inlined into existing C++ code
+
+		If parameter inv_conduct_matrix_rescale_enable is set, the emitted inv_g literal is rescaled
+		by a power of 2 divider and the generated solver compensates the solutions with shifts
+		(fixed point) or power of 2 multiplications (floating point).
+
+		If parameter source_slot_reorder_enable is set, the b_components slots are renumbered so that
+		sources are contiguous by node, and the component update bodies are rewritten to match.
+
+		If parameter reentrant_engine_enable is set, the component fields and solutions are not
+		defined by the code but bound by reference to the members of a <model>_State pointed to by
+		a variable named state, which must be in scope where the code is inlined.  A checkpointed or
+		multi-step non-reentrant engine declares state itself, pointing to the global state of
+		<model>_getState().
+
+		If parameter batch_lanes is greater than 1, the code advances all lanes of a batched engine
+		and expects the state pointer and the batched signals of the engine function in scope.
+
 		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
 		\return string containing valid, inlineable C++ code for the simulation engine
 	**/
     std::string generateCInlineCode(double zero_bound = 1.0e-12) const;
 
+	/**
+		\brief emits valid C++ code of the simulation engine that can be inlined into existing C++ code
+
+		Same as generateCInlineCode() but streams the code into the given emitter, which may be
+		backed by a file, without assembling the code in intermediate strings.
+
+		\param emitter the code emitter that the code is written to
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+	**/
+	void emitCInlineCode(codegen::CodeEmitter& emitter, double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief plans the Xilinx HLS directives emitted when parameter xilinx_hls_directives_enable is set
+
+		The clock cycle budget of a time step is xilinx_hls_step_period over xilinx_hls_clock_period,
+		further limited by xilinx_hls_latency_max when latency is enabled.  Within a budget, the
+		multiplier limit is the number of multipliers needed to issue every solver term in the cycles
+		left after the multiplier latency and the adder tree of the longest solver row; without a
+		budget, the multipliers are unlimited.  The multiplier latency is estimated from the clock
+		period and the fixed point word width, one DSP cascade stage per 3 ns and 17 bits, or about
+		12 ns for a double multiplier.  The engine is pipelined at the cycle budget when it is not
+		inlined.  Arrays up to xilinx_hls_partition_limit elements are completely partitioned;
+		larger arrays get one dual port bank per two multipliers.
+
+		If xilinx_hls_solver_lanes is set, the solver is folded onto that many multipliers, which
+		also becomes the multiplier limit unless xilinx_hls_multiplier_limit is set.  Each lane
+		accumulates whole rows, computeSolverInterleave() of them at once, so the solver issues its
+		terms over SystemSolverGenerator::getNumberOfCycles() cycles.  The solver latency is its
+		issue cycles plus the multiplier latency and either the adder tree of the longest row (fully
+		parallel) or the accumulating adder (folded).  The products of the lanes are bound to DSP
+		multipliers of the planned latency; the products of the fully parallel solver are not
+		named, so they are left to the HLS tool.
+
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\return the directive plan
+	**/
+	HLSDirectivePlan planHLSDirectives(double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief estimates the latency and resource usage of the engine synthesized with Xilinx HLS
+
+		The component updates, output updates, and source aggregation of one time step are
+		scheduled by HLSScheduler against xilinx_hls_clock_period with the given operator costs,
+		followed by the solver: fully parallel rows reduce their products with an adder tree
+		(fixed point) or in the order written (doubles, which HLS does not reassociate), while a
+		folded solver issues the terms of each of its accumulation streams every interleave cycles
+		and accumulates them row by row.  Multipliers
+		are limited as planned by planHLSDirectives() when xilinx_hls_directives_enable is set.  The
+		coefficients of a fully parallel solver are folded into its multipliers; the coefficient
+		ROMs of a folded solver are counted as block RAM or LUTs by size.  The latency is checked
+		against xilinx_hls_latency_max when xilinx_hls_latency_enable is set.
+
+		\param costs delays and resources of the operators
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\return the estimate
+		\throw std::runtime_error if the engine is batched or its code cannot be scanned
+	**/
+	HLSEstimate estimateHLS(const HLSEstimatorParameters& costs = HLSEstimatorParameters(), double zero_bound = 1.0e-12) const;
+
     /**
 		\brief generates valid C++ code string of the simulation engine as a C++ function definition
+
+		If parameter reentrant_engine_enable is set, the code also defines struct <model>_State that
+		holds the component fields and solutions of one engine instance, and functions
+		<model>_initState() and <model>_resetState() that set a state to its initial conditions.  The
+		engine function then takes a pointer to the instance's state as its first parameter and has
+		no static variables besides constants, so independent instances can be stepped
+		concurrently:\n
+		<pre>
+		model_State s;
+		model_initState(&s);
+		model_simulationEngine(&s, x_out, ...);
+		</pre>
+
+		If parameter checkpoint_enable is set, the code also defines functions that checkpoint a
+		<model>_State to a byte buffer or file and restore it, so that many runs can be forked from
+		one settled state:\n
+		<pre>
+		std::size_t model_saveState(const model_State* state, unsigned char* buffer, std::size_t size);
+		bool model_restoreState(model_State* state, const unsigned char* buffer, std::size_t size);
+		bool model_saveStateFile(const model_State* state, const char* filename);
+		bool model_loadStateFile(model_State* state, const char* filename);
+		</pre>
+		A snapshot is <model>_checkpoint_size bytes: the magic "LBCK", the 32-bit format version
+		<model>_checkpoint_version, the 64-bit <model>_checkpoint_layout hash of the model's state
+		layout and real type, and the 64-bit size of the payload, all in host byte order, followed
+		by the payload of every component field, b, and x in declaration order without padding.
+		Restoring fails and leaves the state unchanged unless the header matches the engine.  A
+		non-reentrant engine then keeps its fields and solutions, shared with its multi-step
+		engine, in the global <model>_State returned by <model>_getState() instead of function
+		statics.  Checkpointed Xilinx HLS engines must be reentrant, and the snapshot functions are
+		not synthesized.
+
+		If parameter runtime_parameters_enable is set, the component parameters and inv_g are not
+		emitted as literals but kept in struct <model>_Parameters, and the engine takes a const
+		pointer to it (after the state pointer, if any).  <model>_initParameters() sets the values
+		the engine was generated with.  <model>_loadParameters() loads the values from a buffer of
+		doubles as made by generateRuntimeParameters(), and <model>_loadParametersFile() from a file
+		as made by exportRuntimeParameters().  One compiled engine can thus simulate a sweep of
+		parameter values:\n
+		<pre>
+		component.setParameters(...);
+		model.updateSolverParameters();
+		model.getSolverCodeGenerator().exportRuntimeParameters("point.bin");
+		...
+		model_loadParametersFile(&params, "point.bin");
+		model_simulationEngine(&params, x_out, ...);
+		</pre>
+		The solver is pruned for the elements of inv_g that are zero at generation, and inv_g is
+		rescaled by the power of 2 divider chosen at generation, so loaded inverted conductance
+		matrices must have the same zero pattern and should have a similar range.
+
+		If parameter io_struct_abi_enable is set, the engine takes its signals in two blocks,
+		"const <model>_Inputs* in" and "<model>_Outputs* out", instead of one argument per signal.
+		The blocks are structs with a member per component input or output signal, named as the
+		signal, and the solutions x_out in the output block.  The byte offsets and sizes of the
+		members are emitted as constants <model>_Inputs_<signal>_offset, <model>_Inputs_size, and
+		so on, so a caller can fill and read the blocks with single copies.  If parameter
+		io_struct_solutions_in_place is also set, the output block holds the engine's solution
+		vector x (with x[0] as ground) instead of x_out, and the engine solves directly into it.
+		That block then carries the engine's state and must be passed unchanged to every call.
+
+		If parameter multi_step_enable is set, the code also defines a multi-step engine
+		<model>_simulationEngineSteps() that runs num_steps time steps per call, given as its first
+		argument after any state and parameters pointers.  Each input signal becomes an array
+		<signal>_steps[num_steps] of the signal's values for every step.  The solutions and output
+		signals are recorded every multi_step_output_decimation steps into x_out[][num_solutions]
+		and <signal>_steps[] arrays, which must hold num_steps/multi_step_output_decimation records.
+		The component fields and solutions are loaded from the state into local variables, kept
+		there across the steps of a call, and stored back; array fields stay in the state.  A
+		non-reentrant engine then keeps its state in the global <model>_State returned by
+		<model>_getState(), so calls of <model>_simulationEngine() and
+		<model>_simulationEngineSteps() continue from each other, and must be reentrant if
+		generated for Xilinx HLS.
+
+		If parameter batch_lanes is greater than 1, a batched engine is generated instead.  Every
+		component field and solution in <model>_State is an array of batch_lanes elements, one per
+		independent instance (lane), stored as a structure of arrays.  The component signals and
+		x_out of the engine function gain a lane dimension, with signal arguments named
+		<signal>_lanes.  Each section of the engine is a loop over the lanes marked with
+		"#pragma omp simd", so the solver x=(G^-1)*b becomes a product of inv_g with the
+		num_solutions by batch_lanes matrix of source vectors.  Compile with -fopenmp-simd (or
+		equivalent) and set batch_simd_isa to target a specific instruction set.  All lanes share
+		the model's parameters and inverted conductance matrix.  Array fields are not supported in
+		batched engines.
+
+		If parameter instrumentation_enable is set, the engine sections (components, outputs,
+		aggregation and solve) and the whole step are each wrapped by timing probes that
+		read instrumentation_clock and record into a <model>_SectionTiming counter of the
+		<model>_Timing struct returned by <model>_getTiming().  Each counter keeps the number of
+		samples, the minimum, maximum and total time, and a histogram whose bucket k counts samples
+		from 2^k to 2^(k+1)-1 time units.  <model>_timingMean() gives the mean of a counter,
+		<model>_resetTiming() clears the counters, and <model>_writeTiming() prints them.  With
+		instrumentation_per_component, the update and output update code of every component gets
+		its own counter in the component_updates[] and component_output_updates[] arrays, in the
+		order the components were stamped.  The counters are shared by all engine functions.  Those
+		of a reentrant engine are thread_local, so every thread running it records into, reads and
+		clears only its own counters; those of other engines are not thread safe.  Without
+		instrumentation, the engine contains no probes.
+
 		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
 		\return string containing valid C++ function definition for the simulation engine
 	**/
 	std::string generateCFunction(double zero_bound = 1.0e-12) const;
 
+	/**
+		\brief emits valid C++ code of the simulation engine as a C++ function definition
+		\param emitter the code emitter that the function definition is written to
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\see generateCFunction()
+	**/
+	void emitCFunction(codegen::CodeEmitter& emitter, double zero_bound = 1.0e-12) const;
+
 	/**
 		\brief generates valid C++ code string of the simulation engine as a C++ function definition exported to a header file
 		\param filename name of the header file that will contain the engine definition, including directory path and file extension
@@ -291,6 +1177,216 @@ public:
 	**/
 	void generateCFunctionAndExport(std::string filename, double zero_bound = 1.0e-12) const;
 
+	/**
+		\brief emits the complete engine header exported by generateCFunctionAndExport(), including
+		include guard and real typedef
+		\param emitter the code emitter that the header is written to
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\see generateCFunctionAndExport()
+	**/
+	void emitCFunctionHeader(codegen::CodeEmitter& emitter, double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief generates the runtime parameter values of the engine for loading by the
+		<model>_loadParameters() function of an engine generated with runtime_parameters_enable set
+
+		The values are the component parameters, in the order the components were inserted, followed
+		by the unscaled inverted conductance matrix in row-major order.  The conductance matrix is
+		inverted only if it changed since the last generation.
+
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\return the runtime parameter values
+		\throw std::runtime_error if a parameter value is not a number or boolean literal
+	**/
+	std::vector<double> generateRuntimeParameters(double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief exports the runtime parameter values of the engine to a binary file of native
+		doubles for loading by the generated <model>_loadParametersFile() function
+		\param filename name of the binary file, including directory path and file extension
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\see generateRuntimeParameters()
+	**/
+	void exportRuntimeParameters(std::string filename, double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief exports the byte layout of the stream words of the engine to a C++ header shared by the
+		host and the engine
+
+		When parameter xilinx_hls_stream_interface is set, the engine header also defines
+		<model>_simulationEngineStream(), which takes the inputs of a time step from one input word
+		and returns the solutions and outputs in one output word.  The words are little-endian byte
+		arrays holding the signals' elements back to back, inputs in the order of the engine's input
+		signals, and outputs starting with the solutions x_out followed by the output signals.  A
+		bool element takes one byte (0 or 1); a real element takes 8 bytes of IEEE 754 double or,
+		with fixed point, the two's complement fixed point integer sign extended to whole bytes.
+		The header defines the size of each word and the byte offset and size of each signal as
+		<model>_InputWord_<signal>_offset and <model>_InputWord_<signal>_size (likewise for the
+		output word), using the same include guard as the engine header's copy of the layout.
+
+		\param filename name of the layout header, including directory path and file extension
+		\throw std::runtime_error if the engine has pointer inputs or signals other than bool and real
+	**/
+	void generateStreamLayoutAndExport(std::string filename) const;
+
+	/**
+		\brief generates a host-side simulation driver program for the engine and exports it to a C++ source file
+
+		The driver's main() runs the engine exported by generateCFunctionAndExport() offline:\n
+		<pre>
+		driver num_steps decimation output_file input_file...
+		</pre>
+		It memory-maps one binary input file per component input signal, in the order of the
+		engine's input signals, each holding num_steps consecutive values of the signal in the
+		signal's native type.  Every decimation steps, it records the chosen outputs as doubles
+		into blocks that are written to output_file asynchronously while the engine fills the next
+		block.  The names of the recorded columns are written to output_file.columns, and the run
+		time per step is reported on stderr, followed by the section timing counters of an
+		instrumented engine.  A runtime parameterized engine takes an optional parameters file
+		exported by exportRuntimeParameters() as the last argument.
+
+		\param filename name of the driver source file, including directory path and file extension
+		\param engine_header name of the engine header as it is to be included by the driver
+		\param recorded_outputs names of the engine's output signals to record, with "x_out" for the
+		solutions; empty to record the solutions and all output signals
+		\throw std::invalid_argument if a recorded output is not an output of the engine
+		\throw std::runtime_error if the engine is batched or uses the struct I/O ABI
+	**/
+	void generateDriverAndExport
+	(
+		std::string filename,
+		std::string engine_header,
+		std::vector<std::string> recorded_outputs = std::vector<std::string>()
+	) const;
+
+	/**
+		\brief gets the time step of the model from the DT parameters of its components
+
+		For a multi-rate model, the time step is the smallest DT of the components, which the
+		other DT must be integer multiples of.
+
+		\return time step DT shared by the components of the model
+		\throw std::runtime_error if no component has a DT parameter or the components' DT differ
+	**/
+	double getModelTimeStep() const;
+
+	/**
+		\brief generates a header-only real-time runner for the engine and exports it to a C++ header
+
+		The runner executes the engine exported by generateCFunctionAndExport() at a fixed
+		wall-clock rate on Linux, one step every realtime_step_period seconds, or the model's DT
+		from getModelTimeStep() if it is 0.  It defines:\n
+		<pre>
+		int <model>_setupRealTime();
+		<model>_RealTimeStats <model>_runRealTime(<model>_RealTimeSignals& signals, unsigned long num_steps, Exchange exchange);
+		void <model>_writeRealTimeStats(std::FILE* file, const <model>_RealTimeStats& stats);
+		</pre>
+		<model>_setupRealTime() pins the calling thread to realtime_cpu, locks the process memory
+		with mlockall(), prefaults the stack, and switches to SCHED_FIFO at realtime_fifo_priority
+		if it is nonzero; it returns 0 or the errno of the failed call.  <model>_runRealTime() paces
+		the steps against absolute deadlines on CLOCK_MONOTONIC, so late steps do not shift the
+		schedule.  It waits for each deadline with clock_nanosleep() or by busy waiting
+		(realtime_pacing), calls exchange(step, signals) to exchange the engine signals with the
+		hardware, and runs the engine on the signals in <model>_RealTimeSignals.  A step overruns
+		when it finishes after the next deadline; the deadlines it has missed are skipped, so the
+		following steps are paced from the first deadline after the overrun instead of all running
+		late.  <model>_RealTimeStats counts the steps, overruns, and skipped periods, and keeps the
+		largest and total lateness of the step starts after their deadlines (jitter) and the engine
+		execution times, each with a histogram of realtime_histogram_bins bins
+		realtime_histogram_resolution wide whose last bin also counts larger times.
+
+		A reentrant engine's state is kept in the state member of the signals, initialized by
+		<model>_initState(); a runtime parameterized engine uses the parameters the params member
+		points to, which must be set before running.
+
+		\param filename name of the runner header, including directory path and file extension
+		\param engine_header name of the engine header as it is to be included by the runner
+		\throw std::runtime_error if the engine is batched or uses the struct I/O ABI, or the
+		runner parameters are invalid
+	**/
+	void generateRealTimeRunnerAndExport(std::string filename, std::string engine_header) const;
+
+	/**
+		\brief compiles the simulation engine into a shared library and loads it into the running process
+
+		The engine header from generateCFunctionAndExport() is written with C linkage exports of its
+		functions to a source file in jit_cache_directory, compiled with jit_compiler and
+		jit_compiler_flags, and loaded.  Builds are cached by a hash of the generated source, the
+		compiler, and the flags, so compiling an unchanged model again only reloads the existing
+		library.  The engine's own functions have hidden visibility, so engines of the same model
+		loaded side by side, such as the steps of a parameter sweep, do not share their static
+		state.  The exported functions are <model>_simulationEngine and, when enabled,
+		<model>_simulationEngineSteps, <model>_initState, <model>_resetState, <model>_getState,
+		the checkpoint functions, <model>_getTiming, <model>_resetTiming, <model>_writeTiming,
+		<model>_initParameters, <model>_loadParameters, and <model>_loadParametersFile.
+
+		The library also exports
+		<model>_simulationEngineFlat(double* x_out, const double* inputs, double* outputs), which
+		runs one step of the engine with the input and output signals packed into flat arrays of
+		doubles, and the C string <model>_signalLayout, which lists the packed signals in order as
+		lines of "in|out name size".  These let tools such as ReferenceInterpreter drive engines
+		of any signature.
+
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\return handle to the loaded engine library
+		\throw std::runtime_error if the cache directory cannot be created, or the engine fails to
+		compile or load; the compiler output is included in the message of a failed compile
+	**/
+	EngineLibrary compileAndLoad(double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief generates the simulation engine split across multiple C++ translation units and exports them to files
+
+		Large engines compile slowly as one function in one header.  This method splits the engine
+		into source files that can be compiled in parallel and linked together:\n
+		<pre>
+		basename.hpp               real type and declaration of the engine function; include this to use the engine
+		basename_state.hpp         state and unit declarations shared by the engine's source files
+		basename_state.cpp         component fields and solution vector definitions
+		basename_inv_g.cpp         inverted conductance matrix definition
+		basename_components_K.cpp  component source contribution updates of partition K
+		basename_outputs.cpp       model output signal updates
+		basename_aggregate.cpp     aggregation of component source contributions
+		basename_solve_K.cpp       solution updates of row block K
+		basename_engine.cpp        engine function calling the units above in order
+		</pre>
+		Engine state is kept at namespace scope in namespace <model name>_engine instead of in
+		function static variables.  Component partitions are balanced by code size and solver row
+		blocks by number of terms.  Xilinx HLS pragmas are not emitted in this mode, and reentrant,
+		batched, runtime parameterized, or struct I/O ABI engines are not supported.
+
+		When parameter thread_count is greater than 1, the engine runs each time step on that many
+		threads: the calling thread and thread_count-1 persistent worker threads started on the
+		first call.  The component updates, the aggregation, and the solver are each split into
+		thread_count units, overriding num_component_units and num_solver_units, and thread k runs
+		unit k of each phase.  The phases are separated by a spinning barrier, so workers busy-wait
+		for the next time step instead of sleeping, for the shortest time steps on dedicated cores;
+		threads that spin for long yield the CPU so that the engine still progresses, slowly, when
+		threads outnumber the available cores.
+		With thread_pinning_enable, worker k is pinned to CPU thread_cpu_offset+k; the calling
+		thread, as thread 0, is left for the caller to pin.  The workers are started by the first
+		call of the engine function or of int <model>_getThreadPinningError(), which returns 0, or
+		the error number of the first worker that could not be pinned and runs unpinned.  The
+		engine state is not placed per partition, so on NUMA systems it is allocated where the
+		process first touches it.  The engine function must not be called from more than one
+		thread at a time.
+
+		\param basename path and name of the generated files without extension
+		\param num_component_units maximum number of partitions the component updates are split into
+		\param num_solver_units maximum number of row blocks the solver is split into
+		\param zero_bound value indicating how close a system conductance matrix element must be to zero to be discarded for reduced calculations
+		\return names of the generated source (.cpp) files
+		\throw std::runtime_error if parameter reentrant_engine_enable, runtime_parameters_enable, or io_struct_abi_enable is set, or batch_lanes is greater than 1
+		\throw std::invalid_argument if parameter thread_count is 0
+	**/
+	std::vector<std::string> generateCFunctionAndExportMultiUnit
+	(
+		std::string basename,
+		unsigned int num_component_units = 4,
+		unsigned int num_solver_units = 4,
+		double zero_bound = 1.0e-12
+	) const;
+
 };
 
 } //namespace lblmc
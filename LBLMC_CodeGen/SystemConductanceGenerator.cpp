@@ -23,36 +23,78 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 
 #include <vector>
 #include <fstream>
+#include <sstream>
 #include <iomanip>
 #include <stdexcept>
+#include <atomic>
+#include <utility>
 
 #include <Eigen/Dense>
 
 namespace lblmc
 {
 
+static std::atomic<unsigned long> conductance_revision_counter(0);
+
+/// \return a new unique revision for conductance matrix contents
+static inline unsigned long nextConductanceRevision()
+{
+	return ++conductance_revision_counter;
+}
+
 //SystemConductanceGenerator::SystemConductanceGenerator() {}
 
 SystemConductanceGenerator::SystemConductanceGenerator(unsigned int dimension):
-	matrix(MatrixRMXd::Zero(dimension,dimension)), dimension(dimension)
+	matrix(MatrixRMXd::Zero(dimension,dimension)), dimension(dimension),
+	revision(nextConductanceRevision())
 {
 	if(dimension == 0)
 		throw std::invalid_argument("SystemConductanceGenerator constructor(): dimension must be nonzero");
 }
 
 SystemConductanceGenerator::SystemConductanceGenerator(unsigned int dimension, const MatrixRMXd& base):
-		matrix(base), dimension(dimension)
+		matrix(base), dimension(dimension), revision(nextConductanceRevision())
 {
 	if(dimension == 0)
 		throw std::invalid_argument("SystemConductanceGenerator constructor(): dimension must be nonzero");
 }
 
 SystemConductanceGenerator::SystemConductanceGenerator(const SystemConductanceGenerator& base) :
-		matrix(base.matrix), dimension(base.dimension)
+		matrix(base.matrix), dimension(base.dimension), revision(base.revision)
 {
 	//do nothing else
 }
 
+SystemConductanceGenerator::SystemConductanceGenerator(unsigned int dimension, MatrixRMXd&& base):
+		matrix(std::move(base)), dimension(dimension), revision(nextConductanceRevision())
+{
+	if(dimension == 0)
+		throw std::invalid_argument("SystemConductanceGenerator constructor(): dimension must be nonzero");
+}
+
+SystemConductanceGenerator::SystemConductanceGenerator(SystemConductanceGenerator&& base) :
+		matrix(std::move(base.matrix)), dimension(base.dimension), revision(base.revision)
+{
+	base.revision = nextConductanceRevision();
+}
+
+SystemConductanceGenerator& SystemConductanceGenerator::operator=(const SystemConductanceGenerator& rhs)
+{
+	matrix = rhs.matrix;
+	dimension = rhs.dimension;
+	revision = rhs.revision;
+	return *this;
+}
+
+SystemConductanceGenerator& SystemConductanceGenerator::operator=(SystemConductanceGenerator&& rhs)
+{
+	matrix = std::move(rhs.matrix);
+	dimension = rhs.dimension;
+	revision = rhs.revision;
+	rhs.revision = nextConductanceRevision();
+	return *this;
+}
+
 void SystemConductanceGenerator::reset(unsigned int dimension)
 {
 	if(dimension == 0)
@@ -60,6 +102,7 @@ void SystemConductanceGenerator::reset(unsigned int dimension)
 
 	this->dimension = dimension;
 	this->matrix.setZero();
+	this->revision = nextConductanceRevision();
 }
 
 void SystemConductanceGenerator::reset(unsigned int dimension, const MatrixRMXd& base)
@@ -69,21 +112,25 @@ void SystemConductanceGenerator::reset(unsigned int dimension, const MatrixRMXd&
 
 	this->dimension = dimension;
 	this->matrix = base;
+	this->revision = nextConductanceRevision();
 }
 
 void SystemConductanceGenerator::reset(const SystemConductanceGenerator& base)
 {
 	dimension = base.dimension;
 	matrix = base.matrix;
+	revision = base.revision;
 }
 
 double* SystemConductanceGenerator::asPointer()
 {
+	revision = nextConductanceRevision();
 	return matrix.data();
 }
 
 double* SystemConductanceGenerator::asArray()
 {
+	revision = nextConductanceRevision();
 	return matrix.data();
 }
 //std::vector<NumType>& SystemConductanceGenerator::asVector()
@@ -92,6 +139,12 @@ double* SystemConductanceGenerator::asArray()
 //}
 
 MatrixRMXd& SystemConductanceGenerator::asEigen3Matrix()
+{
+	revision = nextConductanceRevision();
+	return matrix;
+}
+
+const MatrixRMXd& SystemConductanceGenerator::asEigen3Matrix() const
 {
 	return matrix;
 }
@@ -110,6 +163,8 @@ void SystemConductanceGenerator::stampConductance(double conductance, unsigned i
 
 	if(p == n) return;
 
+	revision = nextConductanceRevision();
+
 	if( p != 0 && n != 0)
 	{
 		matrix(p-1,p-1) +=  conductance;
@@ -132,6 +187,8 @@ void SystemConductanceGenerator::stampTransconductance(double transconductance,
 
 	if( (m == n) && (m == p) && (m == q) ) return; //component ports are shorted out, so do nothing
 
+	revision = nextConductanceRevision();
+
 	if( (m != 0) && (p != 0) )
 	{
 		//matrix(m-1,p-1) += transconductance;
@@ -167,6 +224,8 @@ void SystemConductanceGenerator::stampTransconductance2(double transconductance1
 
 	if( (m == n) && (m == p) && (m == q) ) return; //component ports are shorted out, so do nothing
 
+	revision = nextConductanceRevision();
+
 	if( (m != 0) && (p != 0) )
 	{
 		matrix(m-1,p-1) += transconductance12;
@@ -199,6 +258,8 @@ void SystemConductanceGenerator::stampPartialConductance(double conductance, uns
 		throw std::invalid_argument("SystemConductanceGenerator::stampPartialConductance(): given matrix index/indices are outside dimension of conductance matrix");
 	}
 
+	revision = nextConductanceRevision();
+
 	if( r != 0 && c != 0)
 		matrix(r-1,c-1) += conductance;
 }
@@ -210,19 +271,29 @@ bool SystemConductanceGenerator::isInvertible() const
 
 void SystemConductanceGenerator::invertSelf()
 {
-	if(!matrix.fullPivLu().isInvertible())
+	// decompose once for both the singularity check and the inverse
+	Eigen::FullPivLU<MatrixRMXd> lu(matrix);
+
+	if(!lu.isInvertible())
 	{
 		throw std::runtime_error("SystemConductanceGenerator::invertSelf(): cannot invert conductance matrix as it is singular");
 	}
 
-	matrix = matrix.fullPivLu().inverse();
+	matrix = lu.inverse();
+	revision = nextConductanceRevision();
 }
 
 SystemConductanceGenerator SystemConductanceGenerator::invert() const
 {
-	SystemConductanceGenerator ret(*this);
-	ret.invertSelf();
-	return ret;
+	Eigen::FullPivLU<MatrixRMXd> lu(matrix);
+
+	if(!lu.isInvertible())
+	{
+		throw std::runtime_error("SystemConductanceGenerator::invert(): cannot invert conductance matrix as it is singular");
+	}
+
+	MatrixRMXd inv = lu.inverse();
+	return SystemConductanceGenerator(dimension, std::move(inv));
 }
 
 std::string SystemConductanceGenerator::spy() const
@@ -420,37 +491,48 @@ void SystemConductanceGenerator::exportAsCHeader(std::string filename, std::stri
 }
 
 std::string SystemConductanceGenerator::asCLiteral(std::string mat_name) const
+{
+	std::stringstream mat;
+
+	writeCLiteral(mat, mat_name);
+
+	std::string buf = mat.str();
+	return buf;
+}
+
+void SystemConductanceGenerator::writeCLiteral(std::ostream& strm, std::string mat_name, const char* decl_specifiers) const
 {
 	if( mat_name.empty() )
-		throw std::invalid_argument("SystemConductanceGenerator::exportAsCCodeLiteral(): mat_name cannot be empty or null");
+		throw std::invalid_argument("SystemConductanceGenerator::writeCLiteral(): mat_name cannot be empty or null");
 
-	std::stringstream mat;
+	std::ios::fmtflags flags = strm.flags();
+	std::streamsize precision = strm.precision();
 
-	mat << std::setprecision(16);
-	mat << std::fixed;
-	mat << std::scientific;
+	strm << std::setprecision(16);
+	strm << std::fixed;
+	strm << std::scientific;
 
-	mat << "const static real " << mat_name << "[" << dimension << "][" << dimension << "] =\n{";
+	strm << decl_specifiers << " " << mat_name << "[" << dimension << "][" << dimension << "] =\n{";
 
 	for(unsigned int r = 0; r < dimension; r++)
 	{
-		mat << "{" << matrix(r,0);
+		strm << "{" << matrix(r,0);
 
 		for(unsigned int c = 1; c < dimension; c++)
 		{
-			mat << "," << matrix(r,c);
+			strm << "," << matrix(r,c);
 		}
-		mat << "}";
+		strm << "}";
 
-		if(r != dimension-1) mat << ",";
+		if(r != dimension-1) strm << ",";
 
-		mat << "\n";
+		strm << "\n";
 	}
 
-	mat << "};\n";
+	strm << "};\n";
 
-	std::string buf = mat.str();
-	return buf;
+	strm.flags(flags);
+	strm.precision(precision);
 }
 
 void SystemConductanceGenerator::importFromASCIIMatlab(std::string filename)
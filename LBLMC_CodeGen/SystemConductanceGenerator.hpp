@@ -24,6 +24,7 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 
 #include <vector>
 #include <string>
+#include <ostream>
 
 #include "CodeGenDataTypes.hpp"
 
@@ -51,6 +52,7 @@ class SystemConductanceGenerator
 private:
 	MatrixRMXd matrix;
 	unsigned int dimension;
+	unsigned long revision; ///< unique id of the matrix contents; renewed whenever the matrix is changed by this object
 
 public:
 
@@ -79,6 +81,23 @@ public:
 	 */
 	SystemConductanceGenerator(const SystemConductanceGenerator& base);
 
+	/**
+	 * initialization constructor that takes ownership of the given matrix without copying it
+	 *
+	 * @param dimension non-zero dimension of square conductance matrix (length or width)
+	 * @param base matrix to move into the conductance matrix
+	 */
+	SystemConductanceGenerator(unsigned int dimension, MatrixRMXd&& base);
+
+	/**
+	 * move constructor
+	 * @param base conductance matrix to move from
+	 */
+	SystemConductanceGenerator(SystemConductanceGenerator&& base);
+
+	SystemConductanceGenerator& operator=(const SystemConductanceGenerator& rhs);
+	SystemConductanceGenerator& operator=(SystemConductanceGenerator&& rhs);
+
 	/**
 	 * resets conductance matrix to given matrix and dimensions
 	 *
@@ -128,12 +147,30 @@ public:
 	 */
 	MatrixRMXd& asEigen3Matrix();
 
+	/**
+	 * returns the conductance matrix as a constant Eigen3 Matrix Type
+	 * @return
+	 */
+	const MatrixRMXd& asEigen3Matrix() const;
+
 	/**
 	 * gets dimension of square conductance matrix
 	 * @return dimension of matrix
 	 */
 	unsigned int getDimension();
 
+	/**
+	 * gets the revision of the conductance matrix
+	 *
+	 * The revision uniquely identifies the contents of the matrix and is renewed whenever the
+	 * matrix is stamped, reset, inverted, imported, or a mutable observer of the matrix is taken
+	 * with asPointer(), asArray(), or asEigen3Matrix().  Copies share the revision of their base.
+	 * Changes made later through a previously taken observer are not tracked.
+	 *
+	 * @return revision of the matrix
+	 */
+	inline unsigned long getRevision() const { return revision; }
+
 	/**
 		\brief stamps a given conductance into conductance matrix for given node indices
 
@@ -310,6 +347,19 @@ public:
 	**/
 	std::string asCLiteral(std::string mat_name) const;
 
+	/**
+		\brief writes the conductance matrix as C/C++ code definition for a literal (const static) array to a stream
+
+		Same as asCLiteral() but streams the code without building it in memory first.  The
+		formatting state of the stream is restored afterwards.
+
+		\param strm the stream to write the code definition of the literal array to
+		\param mat_name C/C++ compatible name for the matrix array; with no spaces
+		\param decl_specifiers declaration specifiers and type preceding the array name; "const real"
+		gives an array with external linkage that can be shared between translation units
+	**/
+	void writeCLiteral(std::ostream& strm, std::string mat_name, const char* decl_specifiers = "const static real") const;
+
 };
 
 } //namespace lblmc
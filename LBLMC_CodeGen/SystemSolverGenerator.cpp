@@ -23,23 +23,36 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
 #include <stdexcept>
 
 namespace lblmc
 {
 
 SystemSolverGenerator::SystemSolverGenerator() :
-	A(nullptr), dimension(0), num_components(0), zero_bound(1.0e-12)
+	A(nullptr), dimension(0), num_components(0), zero_bound(1.0e-12),
+	rescale_exponent(0), rescale_as_shift(false),
+	plan_row_offsets(), plan_columns(), fold_lanes(0), fold_interleave(1), fold_hls_directives(false),
+	fold_mul_op(), fold_mul_impl(), fold_mul_latency(0)
 {}
 
 SystemSolverGenerator::SystemSolverGenerator(const double* A, unsigned int dimension, unsigned int num_components, double zero_bound) :
-	A(A), dimension(dimension), num_components(num_components), zero_bound(zero_bound)
+	A(A), dimension(dimension), num_components(num_components), zero_bound(zero_bound),
+	rescale_exponent(0), rescale_as_shift(false),
+	plan_row_offsets(), plan_columns(), fold_lanes(0), fold_interleave(1), fold_hls_directives(false),
+	fold_mul_op(), fold_mul_impl(), fold_mul_latency(0)
 {
-	//do nothing else
+	buildPlan();
 }
 
 SystemSolverGenerator::SystemSolverGenerator(const SystemSolverGenerator& base) :
-	A(base.A), dimension(base.dimension), num_components(base.num_components), zero_bound(base.zero_bound)
+	A(base.A), dimension(base.dimension), num_components(base.num_components), zero_bound(base.zero_bound),
+	rescale_exponent(base.rescale_exponent), rescale_as_shift(base.rescale_as_shift),
+	plan_row_offsets(base.plan_row_offsets), plan_columns(base.plan_columns),
+	fold_lanes(base.fold_lanes), fold_interleave(base.fold_interleave), fold_hls_directives(base.fold_hls_directives),
+	fold_mul_op(base.fold_mul_op), fold_mul_impl(base.fold_mul_impl), fold_mul_latency(base.fold_mul_latency)
 {
 	//do nothing else
 }
@@ -50,6 +63,7 @@ void SystemSolverGenerator::reset(const double* A, unsigned int dimension, unsig
 	this->dimension = dimension;
 	this->num_components = num_components;
 	this->zero_bound = zero_bound;
+	buildPlan();
 }
 
 void SystemSolverGenerator::reset(const SystemSolverGenerator& base)
@@ -58,38 +72,335 @@ void SystemSolverGenerator::reset(const SystemSolverGenerator& base)
 	dimension = base.dimension;
 	num_components = base.num_components;
 	zero_bound = base.zero_bound;
+	rescale_exponent = base.rescale_exponent;
+	rescale_as_shift = base.rescale_as_shift;
+	plan_row_offsets = base.plan_row_offsets;
+	plan_columns = base.plan_columns;
+	fold_lanes = base.fold_lanes;
+	fold_interleave = base.fold_interleave;
+	fold_hls_directives = base.fold_hls_directives;
+	fold_mul_op = base.fold_mul_op;
+	fold_mul_impl = base.fold_mul_impl;
+	fold_mul_latency = base.fold_mul_latency;
 }
 
-void SystemSolverGenerator::generateCInlineCode(std::string& buffer, const char* A_name)
+void SystemSolverGenerator::buildPlan()
 {
-	if(A == nullptr || dimension == 0)
-		throw std::runtime_error("SystemSolverGenerator::generateCInlineCode(): cannot generate code without conductance matrix and dimension set");
+	plan_row_offsets.clear();
+	plan_columns.clear();
 
-	std::stringstream sstrm;
+	if(A == nullptr || dimension == 0) return;
 
-	sstrm << "x[0] = 0.0;\n";
+	plan_row_offsets.reserve(dimension+1);
+	plan_row_offsets.push_back(0);
 
-	for(int r = 0; r < dimension; r++)
+	for(unsigned int r = 0; r < dimension; r++)
 	{
-		sstrm << "x[" << r+1 << "] = ";
-		if( !(A[dimension*r+0] < zero_bound && A[dimension*r+0] > -zero_bound) )
-			sstrm << A_name << "[" << r << "][" << int(0) <<"]*b[" << int(0) << "] ";
-		else
-			sstrm << "real(0.0) ";
-		for(int c = 1; c < dimension; c++)
+		for(unsigned int c = 0; c < dimension; c++)
 		{
 			if( A[dimension*r+c] < zero_bound && A[dimension*r+c] > -zero_bound )
 				continue; // A[r,c] is close to zero, so ignore the term.
 
-			sstrm << "+ " << A_name << "[" << r << "][" << c <<"]*b[" << c << "] ";
+			plan_columns.push_back(c);
 		}
 
-		sstrm << ";\n";
+		plan_row_offsets.push_back(plan_columns.size());
+	}
+}
+
+void SystemSolverGenerator::setRescale(int exponent, bool as_shift)
+{
+	rescale_exponent = exponent;
+	rescale_as_shift = as_shift;
+}
+
+void SystemSolverGenerator::setFolding(unsigned int lanes, bool hls_directives, unsigned int interleave)
+{
+	if(interleave == 0)
+		throw std::invalid_argument("SystemSolverGenerator::setFolding(): interleave must be positive nonzero value");
+
+	fold_lanes = lanes;
+	fold_hls_directives = hls_directives;
+	fold_interleave = interleave;
+	fold_mul_op.clear();
+	fold_mul_impl.clear();
+	fold_mul_latency = 0;
+}
+
+void SystemSolverGenerator::setFoldingMultiplier(const std::string& op, const std::string& impl, unsigned int latency)
+{
+	fold_mul_op = op;
+	fold_mul_impl = impl;
+	fold_mul_latency = latency;
+}
+
+std::vector<std::vector<unsigned int>> SystemSolverGenerator::getFoldingStreams() const
+{
+	if(fold_lanes == 0) return std::vector<std::vector<unsigned int>>();
+
+	const unsigned int num_streams = fold_lanes*fold_interleave;
+
+	std::vector<std::vector<unsigned int>> streams(num_streams);
+	std::vector<unsigned int> load(num_streams, 0);
+
+	std::vector<unsigned int> rows;
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		if(getNumberOfTerms(r, r+1) != 0) rows.push_back(r);
+	}
+
+	// longest processing time first; ties keep the lower row and stream for a reproducible schedule
+	std::stable_sort(rows.begin(), rows.end(), [this](unsigned int a, unsigned int b)
+	{
+		return getNumberOfTerms(a, a+1) > getNumberOfTerms(b, b+1);
+	});
+
+	for(unsigned int r : rows)
+	{
+		unsigned int q = std::min_element(load.begin(), load.end()) - load.begin();
+		streams[q].push_back(r);
+		load[q] += getNumberOfTerms(r, r+1);
+	}
+
+	for(auto& stream : streams) std::sort(stream.begin(), stream.end());
+
+	return streams;
+}
+
+unsigned int SystemSolverGenerator::getNumberOfCycles() const
+{
+	if(fold_lanes == 0) return 1;
+
+	unsigned int longest = 0;
+	for(const auto& stream : getFoldingStreams())
+	{
+		unsigned int terms = 0;
+		for(unsigned int r : stream) terms += getNumberOfTerms(r, r+1);
+		longest = std::max(longest, terms);
 	}
 
+	return longest*fold_interleave;
+}
+
+void SystemSolverGenerator::generateCInlineCode(std::string& buffer, const char* A_name)
+{
+	std::stringstream sstrm;
+
+	writeCInlineCode(sstrm, A_name);
+
 	buffer = sstrm.str();
 }
 
+void SystemSolverGenerator::writeCInlineCode(std::ostream& strm, const char* A_name) const
+{
+	if(fold_lanes != 0)
+		writeFoldedCInlineCode(strm, A_name);
+	else
+		writeCInlineCode(strm, A_name, 0, dimension);
+}
+
+template<typename T>
+static void writeFoldedROM
+(
+	std::ostream& strm,
+	const char* type,
+	const std::string& name,
+	const std::vector<T>& values,
+	unsigned int lanes,
+	unsigned int cycles
+)
+{
+	strm << "const static " << type << " " << name << "[" << lanes << "][" << cycles << "] =\n{";
+
+	for(unsigned int p = 0; p < lanes; p++)
+	{
+		strm << "{";
+		for(unsigned int t = 0; t < cycles; t++)
+		{
+			if(t != 0) strm << ",";
+			strm << values[p*cycles+t];
+		}
+		strm << "}";
+
+		if(p != lanes-1) strm << ",";
+
+		strm << "\n";
+	}
+
+	strm << "};\n";
+}
+
+void SystemSolverGenerator::writeFoldedCInlineCode(std::ostream& strm, const char* A_name) const
+{
+	if(A == nullptr || dimension == 0)
+		throw std::runtime_error("SystemSolverGenerator::writeFoldedCInlineCode(): cannot generate code without conductance matrix and dimension set");
+
+	const unsigned int lanes = fold_lanes;
+	const unsigned int interleave = fold_interleave;
+	const unsigned int cycles = getNumberOfCycles();
+	const std::string rom = A_name;
+
+	// slot (p,t) holds term t/interleave of stream (t%interleave)*lanes+p; the row ROM names the
+	// solution completed by the term, or 0 if the row continues.  Padding slots add 0*b[0] to an
+	// accumulator that is no longer written out
+	std::vector<unsigned int> rows(lanes*cycles, 0);
+	std::vector<unsigned int> cols(lanes*cycles, 0);
+	std::vector<double> coefs(lanes*cycles, 0.0);
+
+	const std::vector<std::vector<unsigned int>> streams = getFoldingStreams();
+
+	for(unsigned int q = 0; q < streams.size(); q++)
+	{
+		const unsigned int p = q % lanes;
+		unsigned int t = q / lanes;
+
+		for(unsigned int r : streams[q])
+		{
+			for(unsigned int k = plan_row_offsets[r]; k < plan_row_offsets[r+1]; k++, t += interleave)
+			{
+				unsigned int slot = p*cycles + t;
+				rows[slot] = (k+1 == plan_row_offsets[r+1]) ? r+1 : 0;
+				cols[slot] = plan_columns[k];
+				coefs[slot] = std::ldexp(A[dimension*r+plan_columns[k]], -rescale_exponent);
+			}
+		}
+	}
+
+	std::ios::fmtflags flags = strm.flags();
+	std::streamsize precision = strm.precision();
+
+	strm << "//folded solver: " << getNumberOfTerms() << " terms on " << lanes << " lanes over " << cycles << " cycles, " <<
+	        interleave << " rows accumulated per lane\n";
+
+	writeFoldedROM(strm, "unsigned int", rom + "_fold_row", rows, lanes, cycles);
+	writeFoldedROM(strm, "unsigned int", rom + "_fold_col", cols, lanes, cycles);
+
+	strm << std::setprecision(16) << std::scientific;
+	writeFoldedROM(strm, "real", rom + "_fold_coef", coefs, lanes, cycles);
+	strm.flags(flags);
+	strm.precision(precision);
+
+	if(fold_hls_directives)
+	{
+		strm
+		<< "#pragma HLS ARRAY_PARTITION variable=" << rom << "_fold_row complete dim=1\n"
+		<< "#pragma HLS ARRAY_PARTITION variable=" << rom << "_fold_col complete dim=1\n"
+		<< "#pragma HLS ARRAY_PARTITION variable=" << rom << "_fold_coef complete dim=1\n";
+	}
+
+	const std::string acc = rom + "_fold_acc";
+
+	// the accumulators are already quantized, so fixed point products are compensated for A/2^s
+	// rescaling one by one, at full precision, rather than the finished sums
+	std::string term = rom + "_fold_coef[p][t]*b[" + rom + "_fold_col[p][t]]";
+	if(rescale_as_shift && rescale_exponent > 0)
+		term = "((" + term + ") << " + std::to_string(rescale_exponent) + ")";
+	else if(rescale_as_shift && rescale_exponent < 0)
+		term = "((" + term + ") >> " + std::to_string(-rescale_exponent) + ")";
+
+	strm
+	<< "\nreal " << acc << "[" << lanes << "][" << interleave << "];\n";
+	if(fold_hls_directives) strm << "#pragma HLS ARRAY_PARTITION variable=" << acc << " complete dim=0\n";
+	strm
+	<< "for(unsigned int p = 0; p < " << lanes << "; p++)\n"
+	<< "\tfor(unsigned int i = 0; i < " << interleave << "; i++) " << acc << "[p][i] = real(0.0);\n\n"
+	<< "for(unsigned int r = 0; r < " << dimension+1 << "; r++) x[r] = real(0.0);\n\n"
+	<< "for(unsigned int t = 0; t < " << cycles << "; t++)\n"
+	<< "{\n";
+	if(fold_hls_directives)
+	{
+		// each solution is written once, by one lane; a stream's accumulator is reused only
+		// interleave cycles later
+		strm
+		<< "#pragma HLS PIPELINE II=1\n"
+		<< "#pragma HLS DEPENDENCE variable=x inter false\n"
+		<< "#pragma HLS DEPENDENCE variable=" << acc << " inter distance=" << interleave << " true\n";
+	}
+	strm
+	<< "\tfor(unsigned int p = 0; p < " << lanes << "; p++)\n"
+	<< "\t{\n";
+	if(fold_hls_directives) strm << "#pragma HLS UNROLL\n";
+	strm
+	<< "\t\tconst unsigned int row = " << rom << "_fold_row[p][t];\n"
+	<< "\t\treal& acc = " << acc << "[p][" << (interleave > 1 ? "t % " + std::to_string(interleave) : std::string("0")) << "];\n";
+
+	// auto keeps the full precision type of fixed point products until they are accumulated
+	if(fold_hls_directives && !fold_mul_impl.empty())
+	{
+		strm
+		<< "\t\tconst auto product = " << term << ";\n"
+		<< "#pragma HLS BIND_OP variable=product op=" << fold_mul_op << " impl=" << fold_mul_impl << " latency=" << fold_mul_latency << "\n";
+		term = "product";
+	}
+
+	strm
+	<< "\t\tconst real sum = acc + " << term << ";\n"
+	<< "\t\tif(row != 0) x[row] = sum;\n"
+	<< "\t\tacc = (row != 0) ? real(0.0) : sum;\n"
+	<< "\t}\n"
+	<< "}\n";
+
+	if(rescale_exponent != 0 && !rescale_as_shift)
+	{
+		// compensate for A/2^s rescaling as the fully parallel solver does; scaling by 2^s is exact
+		strm << "\nfor(unsigned int r = 1; r < " << dimension+1 << "; r++) x[r] = "
+		     << "x[r]*real(" << std::setprecision(17) << std::scientific
+		     << std::ldexp(1.0, rescale_exponent) << ");\n";
+		strm.flags(flags);
+		strm.precision(precision);
+	}
+}
+
+void SystemSolverGenerator::writeCInlineCode(std::ostream& strm, const char* A_name, unsigned int row_begin, unsigned int row_end) const
+{
+	if(A == nullptr || dimension == 0)
+		throw std::runtime_error("SystemSolverGenerator::writeCInlineCode(): cannot generate code without conductance matrix and dimension set");
+
+	if(row_begin > row_end || row_end > dimension)
+		throw std::invalid_argument("SystemSolverGenerator::writeCInlineCode(): row block is outside dimension of conductance matrix");
+
+	if(row_begin == 0) strm << "x[0] = 0.0;\n";
+
+	for(unsigned int r = row_begin; r < row_end; r++)
+	{
+		const unsigned int* col = plan_columns.data() + plan_row_offsets[r];
+		const unsigned int* end = plan_columns.data() + plan_row_offsets[r+1];
+
+		strm << "x[" << r+1 << "] = ";
+		if(rescale_exponent != 0) strm << "( ";
+		if( col != end && *col == 0 )
+			strm << A_name << "[" << r << "][" << (*col++) <<"]*b[" << int(0) << "] ";
+		else
+			strm << "real(0.0) ";
+		for(; col != end; col++)
+		{
+			strm << "+ " << A_name << "[" << r << "][" << *col <<"]*b[" << *col << "] ";
+		}
+
+		if(rescale_exponent != 0)
+		{
+			strm << ")";
+
+			// compensate for A/2^s rescaling; powers of 2 are exact in 17 significant digits
+			if(rescale_as_shift && rescale_exponent > 0)
+				strm << " << " << rescale_exponent;
+			else if(rescale_as_shift)
+				strm << " >> " << -rescale_exponent;
+			else
+			{
+				std::ios::fmtflags flags = strm.flags();
+				std::streamsize precision = strm.precision();
+				strm << "*real(" << std::setprecision(17) << std::scientific
+				     << std::ldexp(1.0, rescale_exponent) << ")";
+				strm.flags(flags);
+				strm.precision(precision);
+			}
+		}
+
+		strm << ";\n";
+	}
+}
+
 void SystemSolverGenerator::generateCFunction(std::string& buffer, const char* solver_name,const char* A_name, const char* b_func_name) const
 {
 	if(A == nullptr || dimension == 0)
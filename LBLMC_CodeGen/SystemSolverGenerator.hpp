@@ -24,6 +24,7 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 
 #include <vector>
 #include <string>
+#include <ostream>
 
 namespace lblmc
 {
@@ -35,6 +36,27 @@ private:
 	unsigned int dimension; ///< number of solutions in the system Gx=b
 	unsigned int num_components; ///< number of components in system to contribute to vector b of Gx=b
 	double zero_bound; ///< range from zero when determining whether Aij*bi=xi is close to zero to be ignored; defaults to 1e-12.
+	int rescale_exponent; ///< power of 2 exponent s that solutions are compensated by (x = 2^s * (A/2^s)*b) when A is rescaled; defaults to 0 (no rescaling)
+	bool rescale_as_shift; ///< if true, rescale compensation is emitted as bit shifts (fixed point) instead of multiplication; defaults to false
+	std::vector<unsigned int> plan_row_offsets; ///< pruned solver plan; CSR row offsets into plan_columns for each row of A
+	std::vector<unsigned int> plan_columns; ///< pruned solver plan; column indices of the elements of A not within zero_bound of zero
+	unsigned int fold_lanes; ///< number of multiplier lanes the solver is folded onto; 0 for a fully parallel solver; defaults to 0
+	unsigned int fold_interleave; ///< number of rows each lane of the folded solver accumulates at once; defaults to 1
+	bool fold_hls_directives; ///< if true, the folded solver is emitted with Xilinx HLS pipelining and partitioning directives; defaults to false
+	std::string fold_mul_op; ///< Xilinx HLS multiplication operation the lane products are bound by; defaults to empty
+	std::string fold_mul_impl; ///< Xilinx HLS implementation the lane products are bound to; empty to not bind them; defaults to empty
+	unsigned int fold_mul_latency; ///< pipeline stages of the multiplier the lane products are bound to; defaults to 0
+
+	/**
+		\brief builds the pruned solver plan from A and zero_bound
+	**/
+	void buildPlan();
+
+	/**
+		\brief writes the folded solver, its coefficient ROMs, and its schedule loop to a stream
+		\see setFolding()
+	**/
+	void writeFoldedCInlineCode(std::ostream& strm, const char* invg_name) const;
 
 public:
 
@@ -53,6 +75,111 @@ public:
 	void reset(const double* A, unsigned int dimension, unsigned int num_components, double zero_bound = 1.0e-12);
 	void reset(const SystemSolverGenerator& base);
 
+	/**
+		\brief sets the power of 2 rescaling of the inverted conductance matrix that generated code compensates for
+
+		When the inverted conductance matrix literal referred to by the generated code has been
+		rescaled as A/2^s, the generated solver multiplies each solution by 2^s to compensate, so
+		that x = 2^s * (A/2^s) * b.  Pruning of near-zero elements by zero_bound is still done
+		against the unscaled matrix A given to this object.
+
+		\param exponent the power of 2 exponent s; 0 disables rescale compensation
+		\param as_shift if true, compensation is emitted as bit shifts (<< or >>) of the full
+		precision sums, or of the products of a folded solver, which keeps the fraction bits of fixed
+		point types such as ap_fixed and lblmc_fixed; if false, compensation is emitted as multiplication by a
+		power of 2 literal, which a fixed point type with fewer than -s fraction bits quantizes to 0
+	**/
+	void setRescale(int exponent, bool as_shift = false);
+
+	/**
+		\return the power of 2 exponent s that generated code compensates solutions by
+	**/
+	inline int getRescaleExponent() const { return rescale_exponent; }
+
+	/**
+		\brief sets the number of multiplier lanes the solver is folded (time multiplexed) onto
+
+		A folded solver does not refer to the inverted conductance matrix.  Whole rows of the pruned
+		solver are assigned to lanes*interleave accumulation streams, largest row first to the
+		least loaded stream, as returned by getFoldingStreams().  Stream q runs on lane q%lanes and
+		issues its terms, row by row in column order, in the cycles t with t%interleave equal to
+		q/lanes, so the accumulator of a stream is updated only every interleave cycles and the
+		adder latency does not limit the initiation interval.  Each lane gets ROMs of its
+		coefficients (A rescaled by 2^-s), source columns, and the solution row completed by each
+		term, if any.  The generated loop issues one term per lane per iteration over
+		getNumberOfCycles() iterations, and each solution is written once, from its accumulator,
+		after its last term; rows are summed in the same order as the fully parallel solver.  Only
+		writeCInlineCode(std::ostream&, const char*) emits the folded solver; the row block
+		overload always emits the fully parallel solver.
+
+		\param lanes number of multiplier lanes; 0 for a fully parallel solver
+		\param hls_directives if true, the coefficient ROMs and accumulators are partitioned by
+		lane, the schedule loop is pipelined at an initiation interval of 1 with the lanes
+		unrolled, and the accumulator dependence distance is declared with Xilinx HLS pragmas
+		\param interleave number of rows each lane accumulates at once; at least the latency of
+		the accumulating adder in cycles
+		\throw std::invalid_argument if interleave is zero
+		\note clears the multiplier binding of setFoldingMultiplier()
+	**/
+	void setFolding(unsigned int lanes, bool hls_directives = false, unsigned int interleave = 1);
+
+	/**
+		\brief binds the products of the folded solver lanes to a multiplier implementation
+
+		With the HLS directives of setFolding(), each lane computes its product into a variable
+		named product and binds it with "#pragma HLS BIND_OP variable=product op=<op> impl=<impl>
+		latency=<latency>".
+
+		\param op multiplication operation, such as "mul" for fixed point or "dmul" for double
+		\param impl multiplier implementation, such as "dsp" or "fulldsp"; empty to not bind
+		\param latency pipeline stages of the multiplier
+	**/
+	void setFoldingMultiplier(const std::string& op, const std::string& impl, unsigned int latency);
+
+	/**
+		\return number of multiplier lanes the solver is folded onto; 0 for a fully parallel solver
+	**/
+	inline unsigned int getFoldingLanes() const { return fold_lanes; }
+
+	/**
+		\return number of rows each lane of the folded solver accumulates at once
+	**/
+	inline unsigned int getFoldingInterleave() const { return fold_interleave; }
+
+	/**
+		\brief assigns the rows of the pruned solver to the accumulation streams of the folded solver
+
+		\return rows, in increasing order, of each of the lanes*interleave streams; empty if the
+		solver is fully parallel
+		\see setFolding()
+	**/
+	std::vector<std::vector<unsigned int>> getFoldingStreams() const;
+
+	/**
+		\return number of cycles the solver issues its terms over; interleave times the terms of the
+		longest stream if folded, 1 if fully parallel
+	**/
+	unsigned int getNumberOfCycles() const;
+
+	/**
+		\return number of components in system that contribute to vector b of Gx=b
+	**/
+	inline unsigned int getNumberOfComponents() const { return num_components; }
+
+	/**
+		\return number of multiply-accumulate terms in the pruned solver; elements of A not within
+		zero_bound of zero
+	**/
+	inline unsigned int getNumberOfTerms() const { return plan_columns.size(); }
+
+	/**
+		\return number of multiply-accumulate terms in the pruned solver for rows row_begin to row_end-1
+	**/
+	inline unsigned int getNumberOfTerms(unsigned int row_begin, unsigned int row_end) const
+	{
+		return plan_row_offsets.empty() ? 0 : plan_row_offsets[row_end] - plan_row_offsets[row_begin];
+	}
+
 	/**
 		\brief generates C/C++ inline-able code that includes only the solver for x=(G^-1)*b
 
@@ -61,12 +188,39 @@ public:
 
 		Input of the inline code is the source vector NumType b[<num_nodes>] and the output is NumType x[<num_nodes>].
 
+		If a rescale exponent is set via setRescale(), each solution is compensated for the
+		rescaling of the inverted conductance matrix.
+
 		\param buffer the string that will store the generated code
 		\param invg_name name of the inverted conductance matrix G^-1; default is inv_g
 		\deprecated This method is to be replaced by std::string generateCInlineCode(std::string invg_name) const;
 	**/
 	void generateCInlineCode(std::string& buffer, const char* invg_name = "inv_g");
 
+	/**
+		\brief writes C/C++ inline-able code that includes only the solver for x=(G^-1)*b to a stream
+
+		Same as generateCInlineCode() but streams the code without building it in memory first.
+
+		\param strm the stream that the generated code is written to
+		\param invg_name name of the inverted conductance matrix G^-1; default is inv_g
+	**/
+	void writeCInlineCode(std::ostream& strm, const char* invg_name = "inv_g") const;
+
+	/**
+		\brief writes C/C++ inline-able code for a block of rows of the solver for x=(G^-1)*b to a stream
+
+		Same as writeCInlineCode() but only for solutions x[row_begin+1] to x[row_end].  The ground
+		solution x[0] is written with the block starting at row 0.  Used to split the solver across
+		several functions or translation units.
+
+		\param strm the stream that the generated code is written to
+		\param invg_name name of the inverted conductance matrix G^-1
+		\param row_begin first row of the block
+		\param row_end one past the last row of the block
+	**/
+	void writeCInlineCode(std::ostream& strm, const char* invg_name, unsigned int row_begin, unsigned int row_end) const;
+
 	/**
 		\brief generates C/C++ code for system solver function to solve x=(G^-1)*b
 
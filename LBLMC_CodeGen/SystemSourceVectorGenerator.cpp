@@ -23,58 +23,157 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 
 #include <cstdlib>
 #include <vector>
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <stdexcept>
+#include <atomic>
+#include <utility>
 
 namespace lblmc
 {
 
+static std::atomic<unsigned long> source_revision_counter(0);
+
+/// \return a new unique revision for source incidence contents
+static inline unsigned long nextSourceRevision()
+{
+	return ++source_revision_counter;
+}
+
+std::pair<unsigned int, unsigned int> SystemSourceVectorGenerator::SourceNodesView::at(long src_index) const
+{
+	if(src_index <= 0 || src_index > long(num_sources))
+		throw std::invalid_argument("SystemSourceVectorGenerator::SourceNodesView::at(): src_index is out of bounds");
+
+	return (*this)[src_index];
+}
+
 SystemSourceVectorGenerator::SystemSourceVectorGenerator(unsigned int dimension) :
-	vector(dimension, std::vector<long>()), source_nodes(), dimension(dimension), src_index(0)
+	source_terminals(), node_offsets(dimension+1, 0), node_sources(), incidence_dirty(false),
+	dimension(dimension), src_index(0), revision(nextSourceRevision())
 {
 	if(dimension == 0)
 		throw std::invalid_argument("SystemSourceVectorGenerator::constructor(): dimension must be nonzero");
 }
 
 SystemSourceVectorGenerator::SystemSourceVectorGenerator(const SystemSourceVectorGenerator& base) :
-	vector(base.vector), source_nodes(base.source_nodes), dimension(base.dimension),
-	src_index(base.src_index)
+	source_terminals(base.source_terminals), node_offsets(base.node_offsets),
+	node_sources(base.node_sources), incidence_dirty(base.incidence_dirty),
+	dimension(base.dimension), src_index(base.src_index), revision(base.revision)
 {
 	//do nothing else
 }
 
+SystemSourceVectorGenerator::SystemSourceVectorGenerator(SystemSourceVectorGenerator&& base) :
+	source_terminals(std::move(base.source_terminals)), node_offsets(std::move(base.node_offsets)),
+	node_sources(std::move(base.node_sources)), incidence_dirty(base.incidence_dirty),
+	dimension(base.dimension), src_index(base.src_index), revision(base.revision)
+{
+	base.reset(base.dimension);
+}
+
+SystemSourceVectorGenerator& SystemSourceVectorGenerator::operator=(const SystemSourceVectorGenerator& rhs)
+{
+	reset(rhs);
+	return *this;
+}
+
+SystemSourceVectorGenerator& SystemSourceVectorGenerator::operator=(SystemSourceVectorGenerator&& rhs)
+{
+	source_terminals = std::move(rhs.source_terminals);
+	node_offsets = std::move(rhs.node_offsets);
+	node_sources = std::move(rhs.node_sources);
+	incidence_dirty = rhs.incidence_dirty;
+	dimension = rhs.dimension;
+	src_index = rhs.src_index;
+	revision = rhs.revision;
+	rhs.reset(rhs.dimension);
+	return *this;
+}
+
 void SystemSourceVectorGenerator::reset(unsigned int dimension)
 {
 	if(dimension == 0)
 		throw std::invalid_argument("SystemSourceVectorGenerator::reset(): dimension must be nonzero");
 
-	vector = std::vector<std::vector<long> >(dimension, std::vector<long>());
-	source_nodes.clear();
+	source_terminals.clear();
+	node_offsets.assign(dimension+1, 0);
+	node_sources.clear();
+	incidence_dirty = false;
 	this->dimension = dimension;
 	src_index = 0;
+	revision = nextSourceRevision();
 }
 
 void SystemSourceVectorGenerator::reset(const SystemSourceVectorGenerator& base)
 {
-	vector = base.vector;
-	source_nodes = base.source_nodes;
+	source_terminals = base.source_terminals;
+	node_offsets = base.node_offsets;
+	node_sources = base.node_sources;
+	incidence_dirty = base.incidence_dirty;
 	dimension = base.dimension;
 	src_index = base.src_index;
+	revision = base.revision;
+}
+
+void SystemSourceVectorGenerator::reserve(unsigned int num_sources)
+{
+	source_terminals.reserve(2*std::size_t(num_sources));
+	node_sources.reserve(2*std::size_t(num_sources));
 }
 
-std::vector<long>& SystemSourceVectorGenerator::asVector(unsigned int n)
+void SystemSourceVectorGenerator::updateIncidence() const
 {
-	if(n >= vector.size())
+	if(!incidence_dirty) return;
+
+	//counting sort of source terminals by node; sources stay in insertion order within a node
+
+	node_offsets.assign(dimension+1, 0);
+
+	for(unsigned int node : source_terminals)
+	{
+		if(node != 0) node_offsets[node]++;
+	}
+
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		node_offsets[i+1] += node_offsets[i];
+	}
+
+	node_sources.resize(node_offsets[dimension]);
+
+	std::vector<unsigned int> fill(node_offsets.begin(), node_offsets.end()-1);
+
+	for(unsigned int i = 0; i < src_index; i++)
+	{
+		unsigned int npos = source_terminals[2*i];
+		unsigned int nneg = source_terminals[2*i+1];
+
+		// ids are signed longs; a negated unsigned id would wrap to a large positive id and add the
+		// contribution at the negative terminal instead of subtracting it
+		if(npos != 0) node_sources[fill[npos-1]++] = +long(i+1);
+		if(nneg != 0) node_sources[fill[nneg-1]++] = -long(i+1);
+	}
+
+	incidence_dirty = false;
+}
+
+SystemSourceVectorGenerator::IndexView SystemSourceVectorGenerator::asVector(unsigned int n) const
+{
+	if(n == 0 || n > dimension)
 		throw std::invalid_argument("SystemSourceVectorGenerator::asVector(): index n is out of bounds in source vector");
 
-	return vector[n-1];
+	updateIncidence();
+
+	const long* data = node_sources.data();
+	return IndexView(data + node_offsets[n-1], data + node_offsets[n]);
 }
 
-std::map<long, std::vector<long> >& SystemSourceVectorGenerator::asMap()
+SystemSourceVectorGenerator::SourceNodesView SystemSourceVectorGenerator::asMap() const
 {
-	return source_nodes;
+	return SourceNodesView(source_terminals.data(), src_index);
 }
 
 unsigned int SystemSourceVectorGenerator::getDimension() const
@@ -91,19 +190,16 @@ unsigned int SystemSourceVectorGenerator::insertSource(unsigned int npos, unsign
 {
 	if(npos == nneg) return 0;
 
+	if(npos > dimension || nneg > dimension)
+		throw std::invalid_argument("SystemSourceVectorGenerator::insertSource(): given node index/indices are outside dimension of source vector");
+
 	++src_index;
 
-	if(npos != 0)
-	{
-		vector[npos-1].push_back(+src_index);
-	}
-	if(nneg != 0)
-	{
-		vector[nneg-1].push_back(-src_index);
-	}
+	source_terminals.push_back(npos);
+	source_terminals.push_back(nneg);
 
-	source_nodes[src_index].push_back(npos);
-	source_nodes[src_index].push_back(nneg);
+	incidence_dirty = true;
+	revision = nextSourceRevision();
 
 	return src_index;
 }
@@ -119,6 +215,8 @@ std::vector<unsigned int> SystemSourceVectorGenerator::insertComponents(std::vec
     }
 
     std::vector<unsigned int> indices = std::vector<unsigned int>();
+    indices.reserve(nodes.size()/2);
+    source_terminals.reserve(source_terminals.size() + nodes.size());
 
         //insert the sources, via their nodes, into the source vector
     for(unsigned int i = 0; i < nodes.size(); i+=2)
@@ -129,172 +227,155 @@ std::vector<unsigned int> SystemSourceVectorGenerator::insertComponents(std::vec
     return indices;
 }
 
-void SystemSourceVectorGenerator::asString(std::string& buffer) const
+std::vector<unsigned int> SystemSourceVectorGenerator::reorderSources()
 {
-	std::stringstream sstrm;
+	std::vector<unsigned int> order(src_index);
+	for(unsigned int i = 0; i < src_index; i++) order[i] = i;
 
-	for(unsigned int i = 0; i < dimension; i++)
+	//sort key of a source: (lowest nonzero node, other node); ground-referenced sources come first
+
+	const std::vector<unsigned int>& terms = source_terminals;
+	auto key = [&terms](unsigned int i) -> std::pair<unsigned int, unsigned int>
 	{
-		if(vector[i].empty())
-		{
-			sstrm << i+1 << ": 0\n";
-			continue;
-		}
+		unsigned int a = terms[2*i];
+		unsigned int b = terms[2*i+1];
+		if(a == 0 || (b != 0 && b < a)) std::swap(a, b);
+		return std::make_pair(a, b);
+	};
 
-		sstrm << i+1 << ": ";
+	std::stable_sort(order.begin(), order.end(),
+		[&key](unsigned int l, unsigned int r) { return key(l) < key(r); });
 
-		std::vector<long>::const_iterator iter = vector[i].begin();
-		std::vector<long>::const_iterator end  = vector[i].end();
-		for(iter; iter != end; iter++)
-		{
-			sstrm << *iter << " ";
-		}
+	std::vector<unsigned int> slot_map(src_index+1, 0);
+	std::vector<unsigned int> reordered(source_terminals.size());
 
-		sstrm << "\n";
+	for(unsigned int n = 0; n < src_index; n++)
+	{
+		slot_map[order[n]+1] = n+1;
+		reordered[2*n]   = source_terminals[2*order[n]];
+		reordered[2*n+1] = source_terminals[2*order[n]+1];
 	}
 
-	buffer = sstrm.str();
+	source_terminals.swap(reordered);
+	incidence_dirty = true;
+	revision = nextSourceRevision();
+
+	return slot_map;
 }
 
-std::string SystemSourceVectorGenerator::asString() const
+void SystemSourceVectorGenerator::writeTable(std::ostream& strm) const
 {
-	std::stringstream sstrm;
+	updateIncidence();
+
+	const long* data = node_sources.data();
 
 	for(unsigned int i = 0; i < dimension; i++)
 	{
-		if(vector[i].empty())
+		const long* iter = data + node_offsets[i];
+		const long* end  = data + node_offsets[i+1];
+
+		if(iter == end)
 		{
-			sstrm << i+1 << ": 0\n";
+			strm << i+1 << ": 0\n";
 			continue;
 		}
 
-		sstrm << i+1 << ": ";
+		strm << i+1 << ": ";
 
-		std::vector<long>::const_iterator iter = vector[i].begin();
-		std::vector<long>::const_iterator end  = vector[i].end();
-		for(iter; iter != end; iter++)
+		for(; iter != end; iter++)
 		{
-			sstrm << *iter << " ";
+			strm << *iter << " ";
 		}
 
-		sstrm << "\n";
+		strm << "\n";
 	}
-
-	return sstrm.str();
 }
 
-void SystemSourceVectorGenerator::asCFunction(std::string& buffer, const char* func_name) const
+void SystemSourceVectorGenerator::writeAggregation(std::ostream& strm, const char* line_end) const
 {
-	std::stringstream sstrm;
+	updateIncidence();
 
-	sstrm <<
-	//"void " << func_name << "(real* b, real* b_components)\n"
-	"void " << func_name << "(real b["<<dimension<<"], real b_components["<<src_index<<"])\n"
-	"{\n\t";
+	const long* data = node_sources.data();
 
 	for(unsigned int i = 0; i < dimension; i++)
 	{
-		if(vector[i].empty())
+		const long* iter = data + node_offsets[i];
+		const long* end  = data + node_offsets[i+1];
+
+		if(iter == end)
 		{
-			sstrm << "b[" << i << "] = 0.0;\n\t";
+			strm << "b[" << i << "] = 0.0;" << line_end;
 			continue;
 		}
 
-		sstrm << "b[" << i << "] = ";
+		strm << "b[" << i << "] = ";
 
-		std::vector<long>::const_iterator iter = vector[i].begin();
-		std::vector<long>::const_iterator end  = vector[i].end();
-		for(iter; iter != end; iter++)
+		for(; iter != end; iter++)
 		{
 			if( (*iter) >= 0)
 			{
-				sstrm << " b_components[" << long(abs(*iter)-1) << "] ";
+				strm << " b_components[" << long(abs(*iter)-1) << "] ";
 			}
 			else
 			{
-				sstrm << " -b_components[" << long(abs(*iter)-1) << "] ";
+				strm << " -b_components[" << long(abs(*iter)-1) << "] ";
 			}
 
-			if((iter+1) == end) sstrm << ";\n\t";
-			else sstrm << "+";
+			if((iter+1) == end) strm << ";" << line_end;
+			else strm << "+";
 		}
 	}
+}
 
-	sstrm << "\n}";
-
-	buffer = sstrm.str();
+void SystemSourceVectorGenerator::asString(std::string& buffer) const
+{
+	buffer = asString();
 }
 
-void SystemSourceVectorGenerator::asCInlineCode(std::string& buffer) const
+std::string SystemSourceVectorGenerator::asString() const
 {
 	std::stringstream sstrm;
 
-	for(unsigned int i = 0; i < dimension; i++)
-	{
-		if(vector[i].empty())
-		{
-			sstrm << "b[" << i << "] = 0.0;\n";
-			continue;
-		}
+	writeTable(sstrm);
 
-		sstrm << "b[" << i << "] = ";
+	return sstrm.str();
+}
 
-		std::vector<long>::const_iterator iter = vector[i].begin();
-		std::vector<long>::const_iterator end  = vector[i].end();
-		for(iter; iter != end; iter++)
-		{
-			if( (*iter) >= 0)
-			{
-				sstrm << " b_components[" << long(abs(*iter)-1) << "] ";
-			}
-			else
-			{
-				sstrm << " -b_components[" << long(abs(*iter)-1) << "] ";
-			}
+void SystemSourceVectorGenerator::asCFunction(std::string& buffer, const char* func_name) const
+{
+	std::stringstream sstrm;
 
-			if((iter+1) == end) sstrm << ";\n";
-			else sstrm << "+";
-		}
-	}
+	sstrm <<
+	//"void " << func_name << "(real* b, real* b_components)\n"
+	"void " << func_name << "(real b["<<dimension<<"], real b_components["<<src_index<<"])\n"
+	"{\n\t";
+
+	writeAggregation(sstrm, "\n\t");
+
+	sstrm << "\n}";
 
 	buffer = sstrm.str();
 }
 
+void SystemSourceVectorGenerator::asCInlineCode(std::string& buffer) const
+{
+	buffer = asCInlineCode();
+}
+
 std::string SystemSourceVectorGenerator::asCInlineCode() const
 {
 	std::stringstream sstrm;
 
-	for(unsigned int i = 0; i < dimension; i++)
-	{
-		if(vector[i].empty())
-		{
-			sstrm << "b[" << i << "] = 0.0;\n";
-			continue;
-		}
-
-		sstrm << "b[" << i << "] = ";
-
-		std::vector<long>::const_iterator iter = vector[i].begin();
-		std::vector<long>::const_iterator end  = vector[i].end();
-		for(iter; iter != end; iter++)
-		{
-			if( (*iter) >= 0)
-			{
-				sstrm << " b_components[" << long(abs(*iter)-1) << "] ";
-			}
-			else
-			{
-				sstrm << " -b_components[" << long(abs(*iter)-1) << "] ";
-			}
-
-			if((iter+1) == end) sstrm << ";\n";
-			else sstrm << "+";
-		}
-	}
+	writeAggregation(sstrm, "\n");
 
 	return sstrm.str();
 }
 
+void SystemSourceVectorGenerator::writeCInlineCode(std::ostream& strm) const
+{
+	writeAggregation(strm, "\n");
+}
+
 void SystemSourceVectorGenerator::exportAsCFunctionSource(const char* filename, const char* func_name) const
 {
 	std::fstream file;
@@ -23,8 +23,9 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #define SYSTEMSOURCEVECTORGENERATOR_HPP
 
 #include <vector>
-#include <map>
 #include <string>
+#include <utility>
+#include <ostream>
 
 namespace lblmc
 {
@@ -52,17 +53,94 @@ namespace lblmc
  * 	s is the index of last element of the source vector.  If a source vector b element has no
  * 	source contributions, it is assigned zero.
  *
+ * The source incidence is stored flat: the terminal nodes of every source are appended to a single
+ * array as sources are inserted, and a compressed sparse row (CSR) table of the signed source
+ * indices per node is built from it on demand.  This keeps insertion O(1) amortized and
+ * emission cache-friendly for models with very many sources.
+ *
  * @note This class is NOT intended for RTL Synthesis.
  *
  *
  */
 class SystemSourceVectorGenerator
 {
+public:
+
+	/**
+	 * @brief read-only view of the signed indices of sources contributing to a source vector element
+	 *
+	 * A positive index i means b_components[i-1] is added into the element; a negative index -i
+	 * means it is subtracted.  The view is invalidated by insertion of further sources.
+	 */
+	class IndexView
+	{
+	private:
+		const long* first;
+		const long* last;
+
+	public:
+		IndexView(const long* first, const long* last) : first(first), last(last) {}
+
+		inline const long* begin() const { return first; }
+		inline const long* end() const { return last; }
+		inline std::size_t size() const { return last - first; }
+		inline bool empty() const { return first == last; }
+		inline const long& operator[](std::size_t i) const { return first[i]; }
+	};
+
+	/**
+	 * @brief read-only view mapping the index of each source to the nodes it is connected across
+	 *
+	 * map: src_index -> {pos_node_index, neg_node_index}, for src_index in 1..size().  The view is
+	 * invalidated by insertion of further sources.
+	 */
+	class SourceNodesView
+	{
+	private:
+		const unsigned int* terminals;
+		unsigned int num_sources;
+
+	public:
+		SourceNodesView(const unsigned int* terminals, unsigned int num_sources) :
+			terminals(terminals), num_sources(num_sources) {}
+
+		inline unsigned int size() const { return num_sources; }
+		inline bool empty() const { return num_sources == 0; }
+
+		inline std::pair<unsigned int, unsigned int> operator[](long src_index) const
+		{
+			return std::make_pair(terminals[2*(src_index-1)], terminals[2*(src_index-1)+1]);
+		}
+
+		std::pair<unsigned int, unsigned int> at(long src_index) const;
+	};
+
 private:
-	std::vector<std::vector<long> > vector; ///< vector of vectors that contains the indices of sources that contribute to the source vector b
-	std::map<long,std::vector<long> > source_nodes; ///< map of index of source to source's nodes
+	std::vector<unsigned int> source_terminals; ///< flat pairs of {pos_node, neg_node} of each source, indexed by 2*(src_index-1)
+	mutable std::vector<unsigned int> node_offsets; ///< CSR row offsets into node_sources for each source vector element; size dimension+1
+	mutable std::vector<long> node_sources; ///< CSR signed indices of sources that contribute to the source vector b, grouped by element
+	mutable bool incidence_dirty; ///< true if the CSR table is out of date with source_terminals
 	unsigned int dimension; ///< size of the source vector; number of solutions in system Gx=b
 	unsigned int src_index; ///< tracks the current used source index
+	unsigned long revision; ///< unique id of the source incidence; renewed whenever sources are inserted, reordered, or reset
+
+	/**
+	 * rebuilds the CSR table of source indices per node from source_terminals if out of date
+	 */
+	void updateIncidence() const;
+
+	/**
+	 * writes aggregation statements b[i] = ... for each source vector element to given stream
+	 * @param strm stream to write to
+	 * @param line_end string appended after each statement
+	 */
+	void writeAggregation(std::ostream& strm, const char* line_end) const;
+
+	/**
+	 * writes the table of the contributing source indices of each source vector element to given stream
+	 * @param strm stream to write to
+	 */
+	void writeTable(std::ostream& strm) const;
 
 public:
 	/**
@@ -77,6 +155,15 @@ public:
 	 */
 	SystemSourceVectorGenerator(const SystemSourceVectorGenerator& base);
 
+	/**
+	 * move constructor
+	 * @param base object to move from
+	 */
+	SystemSourceVectorGenerator(SystemSourceVectorGenerator&& base);
+
+	SystemSourceVectorGenerator& operator=(const SystemSourceVectorGenerator& rhs);
+	SystemSourceVectorGenerator& operator=(SystemSourceVectorGenerator&& rhs);
+
 	/**
 	 * resets the source vector
 	 * @param dimension size of the source vector; number of solutions in system Gx=b
@@ -90,19 +177,24 @@ public:
 	void reset(const SystemSourceVectorGenerator& base);
 
 	/**
-	 * returns the vector of indices of sources contributing to particular vector-element in source vector indexed by argument n
+	 * preallocates storage for a number of sources to avoid reallocation during insertion
+	 * @param num_sources expected total number of sources to be inserted
+	 */
+	void reserve(unsigned int num_sources);
+
+	/**
+	 * returns a view of the indices of sources contributing to particular vector-element in source vector indexed by argument n
 	 * @param n the nonzero (>0) index of the source vector vector-element whose index vector is returned
-	 * @return the index vector of sources contributing to source vector element n
+	 * @return view of the index vector of sources contributing to source vector element n
 	 */
-	std::vector<long>& asVector(unsigned int n);
+	IndexView asVector(unsigned int n) const;
 
 	/**
-	 * returns an ordered C++ map of the source indices and their node indices
-	 * the key of the map is the system node index while the corresponding vector value is the collection of source indices that contribute to the node.
+	 * returns a view of the source indices and their node indices
 	 * map: src_index -> {pos_node_index, neg_node_index}
-	 * @return reference to the ordered map
+	 * @return view of the source to node mapping
 	 */
-	std::map<long, std::vector<long> >& asMap();
+	SourceNodesView asMap() const;
 
 	/**
 	 * @return the dimension (number of solutions in Gx=b) of the source vector
@@ -114,6 +206,12 @@ public:
 	 */
 	unsigned int getNumSources() const;
 
+	/**
+	 * @return revision that uniquely identifies the source incidence; renewed whenever sources are
+	 * inserted, reordered, or reset.  Copies share the revision of their base.
+	 */
+	inline unsigned long getRevision() const { return revision; }
+
 	/**
 	 * inserts a contributing source's index into the source vector between given nodes
 	 * @param npos positive node of the source
@@ -139,6 +237,23 @@ public:
     **/
 	std::vector<unsigned int> insertComponents(std::vector<unsigned int> nodes);
 
+	/**
+		@brief renumbers the source indices so that sources are ordered by the nodes they contribute to
+
+		Sources are stably sorted by their lowest nonzero node, then by their other node (ground
+		first).  This is a profile (bandwidth) reducing ordering of the node-source incidence that
+		places the sources contributing to each element of b in mostly contiguous slots of
+		b_components, so the aggregation of b becomes segmented sums over contiguous memory rather
+		than a gather.
+
+		Code that already refers to the old source indices, such as component update bodies, must be
+		rewritten with the returned map.
+
+		@return map of old to new source indices; element i holds the new index of old source index
+		i, for i in 1..getNumSources(); element 0 is unused and holds 0
+	**/
+	std::vector<unsigned int> reorderSources();
+
 	/**
 	 * creates a table, as a string, of the contributing source indices corresponding to each source vector element
 	 * @param buffer string that will store the table
@@ -180,6 +295,13 @@ public:
 	**/
 	std::string asCInlineCode() const;
 
+	/**
+		\brief writes compilable inlined C/C++ code to aggregate the source vector b from source contributions to a stream
+		Same as asCInlineCode() but streams the code without building it in memory first.
+		\param strm the stream that the code is written to
+	**/
+	void writeCInlineCode(std::ostream& strm) const;
+
 	/**
 	 * Generates the C/C++ source code for a function that aggregates/computes the source vector b from array of given source contributions
 	 * The generated function is created from the indices stored in this object.
@@ -0,0 +1,173 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CODEGEN_CODEEMITTER_HPP
+#define CODEGEN_CODEEMITTER_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace codegen
+{
+
+/**
+	\brief buffered sink that generated C++ code is streamed into, backed by either a file or memory
+
+	Code generators write their code into a CodeEmitter piece by piece instead of assembling the
+	whole generated program into intermediate strings.  When backed by a file, the code is written
+	through a single large stream buffer straight to the file; when backed by memory, the code is
+	accumulated in one string stream and can be fetched with str().
+
+	Anything that can be written to a std::ostream can be written to a CodeEmitter with operator<<.
+	Generators that write to a std::ostream can be given stream().
+
+	\see SimulationEngineGenerator for the generator that emits engine code through this class
+**/
+class CodeEmitter
+{
+
+private:
+
+	std::vector<char> file_buffer;	///< stream buffer used for file sinks
+	std::ofstream file;				///< file sink
+	std::ostringstream memory;		///< memory sink
+	std::ostream* sink;				///< the active sink; observing pointer to file or memory
+
+public:
+
+	/**
+		\brief default constructor; constructs an emitter with a memory sink
+	**/
+	CodeEmitter() :
+		file_buffer(),
+		file(),
+		memory(),
+		sink(&memory)
+	{}
+
+	/**
+		\brief parameter constructor; constructs an emitter with a file sink
+
+		The file is created, or truncated if it already exists.
+
+		\param filename name of the file to write code to, including directory path and extension
+		\param buffer_size size in bytes of the buffer the file is written through; default is 1 MiB
+		\throw std::runtime_error if the file cannot be opened or created
+	**/
+	explicit CodeEmitter(std::string filename, std::size_t buffer_size = 1 << 20) :
+		file_buffer(buffer_size),
+		file(),
+		memory(),
+		sink(&file)
+	{
+		if(filename.empty())
+			throw std::invalid_argument("codegen::CodeEmitter constructor(): filename cannot be empty or null");
+
+		// buffer must be set before the file is opened to take effect
+		if(buffer_size != 0)
+			file.rdbuf()->pubsetbuf(file_buffer.data(), file_buffer.size());
+
+		file.open(filename.c_str(), std::ofstream::out | std::ofstream::trunc);
+
+		if(!file.is_open())
+			throw std::runtime_error("codegen::CodeEmitter constructor(): failed to open or create file");
+	}
+
+	CodeEmitter(const CodeEmitter& base) = delete;
+	CodeEmitter& operator=(const CodeEmitter& rhs) = delete;
+
+	/**
+		\brief destructor; flushes and closes a file sink
+	**/
+	~CodeEmitter()
+	{
+		if(file.is_open()) file.close();
+	}
+
+	/**
+		\brief writes a value to the sink
+		\param value any value that can be written to a std::ostream
+		\return *this
+	**/
+	template<typename T>
+	inline CodeEmitter& operator<<(const T& value)
+	{
+		*sink << value;
+		return *this;
+	}
+
+	/**
+		\brief applies a stream manipulator, such as std::flush, to the sink
+		\return *this
+	**/
+	inline CodeEmitter& operator<<(std::ostream& (*manip)(std::ostream&))
+	{
+		manip(*sink);
+		return *this;
+	}
+
+	/**
+		\return the stream of the active sink, for generators that write to std::ostream
+	**/
+	inline std::ostream& stream() { return *sink; }
+
+	/**
+		\return true if the sink is a file; false if the sink is memory
+	**/
+	inline bool isFile() const { return sink == &file; }
+
+	/**
+		\return copy of the code written to a memory sink
+		\throw std::runtime_error if the sink is a file
+	**/
+	inline std::string str() const
+	{
+		if(isFile())
+			throw std::runtime_error("codegen::CodeEmitter::str(): code written to a file sink cannot be fetched");
+
+		return memory.str();
+	}
+
+	/**
+		\brief flushes and closes a file sink; does nothing for a memory sink
+		\throw std::runtime_error if writing to the file failed
+	**/
+	inline void close()
+	{
+		if(!file.is_open()) return;
+
+		file.flush();
+		bool failed = file.fail();
+		file.close();
+
+		if(failed)
+			throw std::runtime_error("codegen::CodeEmitter::close(): failed to write to file");
+	}
+
+};
+
+} //namespace codegen
+
+#endif // CODEGEN_CODEEMITTER_HPP
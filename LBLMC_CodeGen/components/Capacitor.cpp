@@ -22,6 +22,8 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "Capacitor.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "ReferenceInterpreter.hpp"
+#include "OperatingPoint.hpp"
 
 #include <stdexcept>
 #include <sstream>
@@ -36,7 +38,9 @@ Capacitor::Capacitor(std::string comp_name) :
     CAP(1.0),
     P(0),
     N(0),
-    source_id(0)
+    source_id(0),
+    epos_initial(0.0),
+    eneg_initial(0.0)
 {
 	if(comp_name == "")
 	{
@@ -50,7 +54,9 @@ Capacitor::Capacitor(std::string comp_name, double dt, double cap) :
 	CAP(cap),
 	P(0),
 	N(0),
-	source_id(0)
+	source_id(0),
+	epos_initial(0.0),
+	eneg_initial(0.0)
 {
 	if(comp_name == "")
 	{
@@ -69,7 +75,9 @@ Capacitor::Capacitor(const Capacitor& base) :
 	CAP(base.CAP),
 	P(base.P),
 	N(base.N),
-	source_id(base.source_id)
+	source_id(base.source_id),
+	epos_initial(base.epos_initial),
+	eneg_initial(base.eneg_initial)
 {}
 
 void Capacitor::getSourceIds(std::vector<unsigned int>& ids) const
@@ -116,13 +124,18 @@ std::string Capacitor::generateFields()
 	std::fixed <<
 	std::scientific;
 
+	//at the operating point no current flows and the equivalent current holds the voltage
+
+	const double delta_v = epos_initial - eneg_initial;
+	const double current_eq = 2.0*CAP/DT*delta_v;
+
 	sstrm <<
-	"static "<<"real "<<"epos_past"      <<"_"<<comp_name<<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<"eneg_past"      <<"_"<<comp_name<<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<"delta_v"        <<"_"<<comp_name<<" = "<<0.0<<";\n" <<
+	"static "<<"real "<<"epos_past"      <<"_"<<comp_name<<" = "<<epos_initial<<";\n" <<
+	"static "<<"real "<<"eneg_past"      <<"_"<<comp_name<<" = "<<eneg_initial<<";\n" <<
+	"static "<<"real "<<"delta_v"        <<"_"<<comp_name<<" = "<<delta_v<<";\n" <<
 	"static "<<"real "<<"current"        <<"_"<<comp_name<<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<"current_eq"     <<"_"<<comp_name<<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<"current_eq_past"<<"_"<<comp_name<<" = "<<0.0<<";\n" ;
+	"static "<<"real "<<"current_eq"     <<"_"<<comp_name<<" = "<<current_eq<<";\n" <<
+	"static "<<"real "<<"current_eq_past"<<"_"<<comp_name<<" = "<<current_eq<<";\n" ;
 
 	return sstrm.str();
 }
@@ -159,4 +172,28 @@ std::string Capacitor::generateUpdateBody()
 	return sstrm.str();
 }
 
+void Capacitor::interpretStep(InterpreterContext& ctx) const
+{
+	double& current_eq = ctx.states[0];
+
+	const double HOC2 = 2.0*CAP/DT;
+	const double delta_v = ctx.x[P] - ctx.x[N];
+	const double current = HOC2*delta_v - current_eq;
+
+	current_eq = current + HOC2*delta_v;
+
+	ctx.source(source_id, current_eq);
+}
+
+void Capacitor::initInterpreterStates(double* states) const
+{
+	states[0] = 2.0*CAP/DT*(epos_initial - eneg_initial);
+}
+
+void Capacitor::setOperatingPoint(const OperatingPoint* op)
+{
+	epos_initial = (op != nullptr) ? op->getVoltage(P) : 0.0;
+	eneg_initial = (op != nullptr) ? op->getVoltage(N) : 0.0;
+}
+
 } //namespace lblmc
@@ -38,6 +38,8 @@ private:
 	double CAP;
 	unsigned int P, N;
 	unsigned int source_id;
+	double epos_initial;  ///< voltage of the positive terminal at the operating point
+	double eneg_initial;  ///< voltage of the negative terminal at the operating point
 
 public:
 
@@ -64,6 +66,15 @@ public:
 	std::string generateInputs() { return std::string(""); }
 	std::string generateOutputs(std::string output = "ALL") { return std::string(""); }
 	std::string generateUpdateBody();
+
+	inline bool isInterpretable() const { return true; }
+	inline unsigned int getNumberOfInterpreterStates() const { return 1; }
+	void interpretStep(InterpreterContext& ctx) const;
+	void initInterpreterStates(double* states) const;
+
+	inline bool hasOperatingPoint() const { return true; }
+	inline void stampOperatingPoint(OperatingPoint& op) {} //open circuit at DC
+	void setOperatingPoint(const OperatingPoint* op);
 };
 
 } //namespace lblmc
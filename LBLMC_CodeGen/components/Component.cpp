@@ -29,32 +29,28 @@ namespace lblmc
 
 void Component::stampSystem(SimulationEngineGenerator& gen, std::vector<std::string> outputs)
 {
-	std::string buf;
 	SystemConductanceGenerator& scg = gen.getConductanceGenerator();
 	SystemSourceVectorGenerator& ssvg = gen.getSourceVectorGenerator();
 
 	stampConductance(scg);
 	stampSources(ssvg);
-	buf = generateParameters();
-	gen.insertComponentParametersCode(buf);
 
-	buf = generateFields();
-	gen.insertComponentFieldsCode(buf);
+	//generated code is moved into the engine generator rather than copied
 
-	buf = generateInputs();
-	gen.insertComponentInputsCode(buf);
+	gen.insertComponentParametersCode(generateParameters());
 
-	for(auto output : outputs)
+	gen.insertComponentFieldsCode(generateFields());
+
+	gen.insertComponentInputsCode(generateInputs());
+
+	for(const auto& output : outputs)
 	{
-		buf = generateOutputs(output);
-		gen.insertComponentOutputsCode(buf);
+		gen.insertComponentOutputsCode(generateOutputs(output));
 
-		buf = generateOutputsUpdateBody(output);
-		gen.insertComponentOutputsUpdateBody(buf);
+		gen.insertComponentOutputsUpdateBody(generateOutputsUpdateBody(output));
 	}
 
-	buf = generateUpdateBody();
-	gen.insertComponentUpdateBody(buf);
+	gen.insertComponentUpdateBody(generateUpdateBody(), update_rate);
 }
 
 } //namespace lblmc
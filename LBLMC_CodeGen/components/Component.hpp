@@ -34,6 +34,8 @@ namespace lblmc
 class SystemConductanceGenerator;
 class SystemSourceVectorGenerator;
 class SimulationEngineGenerator;
+class OperatingPoint;
+struct InterpreterContext;
 
 /**
 	\brief base class for LB-LMC component models for simulation engine code generation
@@ -54,11 +56,12 @@ class Component
 protected:
 
 	std::string comp_name;
+	unsigned int update_rate;
 
 public:
 
-	Component(std::string comp_name = "") : comp_name(comp_name) {}
-	Component(const Component& base) : comp_name(base.comp_name) {}
+	Component(std::string comp_name = "") : comp_name(comp_name), update_rate(1) {}
+	Component(const Component& base) : comp_name(base.comp_name), update_rate(base.update_rate) {}
 
 	inline void setName(std::string name)
 	{
@@ -72,6 +75,28 @@ public:
 
 	inline const std::string& getName() const { return comp_name; }
 
+	/**
+		\brief sets how often the component is updated in multi-rate engines
+
+		A slow component, such as a filter bank or mechanical load next to a switching converter,
+		can be updated only every rate base time steps, holding its source contributions in
+		between.  Its time step DT must then be rate times the model's base time step.
+
+		\param rate number of base time steps between updates of the component; 1 for every step
+		\see SimulationEngineGenerator::insertComponentUpdateBody()
+	**/
+	inline void setUpdateRate(unsigned int rate)
+	{
+		if(rate == 0)
+		{
+			throw std::invalid_argument("Component::setUpdateRate(): rate must be positive nonzero value");
+		}
+
+		update_rate = rate;
+	}
+
+	inline unsigned int getUpdateRate() const { return update_rate; }
+
 	inline virtual unsigned int getNumberOfTerminals() const { return 0; }
 	inline virtual unsigned int getNumberOfSources() const { return 0; }
 	inline virtual void getSourceIds(std::vector<unsigned int>& ids) const {}
@@ -94,16 +119,72 @@ public:
 	virtual std::string generateOutputsUpdateBody(std::string output = "ALL") { return std::string(""); }
 	virtual std::string generateUpdateBody() { return std::string(""); }
 
+	/**
+		\return true if the component can be simulated on the host by ReferenceInterpreter
+	**/
+	inline virtual bool isInterpretable() const { return false; }
+
+	/**
+		\return number of states the component keeps when simulated by ReferenceInterpreter
+	**/
+	inline virtual unsigned int getNumberOfInterpreterStates() const { return 0; }
+
+	/**
+		\brief simulates one time step of the component on the host for ReferenceInterpreter
+
+		Implementations compute the same source contributions and output signals as the code of
+		generateUpdateBody() and generateOutputsUpdateBody(), but directly in double precision.
+
+		\param ctx the component's states, the previous solutions, and the signals of the step
+	**/
+	virtual void interpretStep(InterpreterContext& ctx) const {}
+
+	/**
+		\brief sets the initial states of the component for ReferenceInterpreter
+
+		The states are zero before the call.  Components initialized at an operating point set
+		the states matching their initial fields.
+
+		\param states the states of the component
+	**/
+	virtual void initInterpreterStates(double* states) const {}
+
+	/**
+		\return true if the component supports the DC operating point analysis of
+		SystemModel::initializeOperatingPoint()
+	**/
+	inline virtual bool hasOperatingPoint() const { return false; }
+
+	/**
+		\brief stamps the DC equivalent of the component, with capacitances open and inductances
+		shorted, into the operating point analysis
+
+		Called after stampSystem(), so the terminal connections and source ids are set.
+
+		\param op the operating point analysis to stamp into
+	**/
+	virtual void stampOperatingPoint(OperatingPoint& op) {}
+
+	/**
+		\brief takes the initial values of the component's fields from a solved operating point
+
+		generateFields() and initInterpreterStates() give these values until the next call.
+
+		\param op the solved operating point the component was stamped into; null to return to
+		the de-energized initial state with all fields zero
+	**/
+	virtual void setOperatingPoint(const OperatingPoint* op) {}
+
 protected:
 
-	inline std::string& appendName(std::string& var)
+	inline std::string& appendName(std::string& var) const
 	{
 		var += "_";
 		var += comp_name;
 		return var;
 	}
 
-	inline std::string& appendName(std::string&& var)
+	inline std::string& appendName(std::string&& var) const
 	{
 		var += "_";
 		var += comp_name;
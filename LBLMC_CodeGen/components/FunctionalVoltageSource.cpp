@@ -22,6 +22,8 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "FunctionalVoltageSource.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "ReferenceInterpreter.hpp"
+#include "OperatingPoint.hpp"
 #include "../codegen/Object.hpp"
 
 #include <stdexcept>
@@ -135,4 +137,15 @@ std::string FunctionalVoltageSource::generateUpdateBody()
 	return sstrm.str();
 }
 
+void FunctionalVoltageSource::interpretStep(InterpreterContext& ctx) const
+{
+	ctx.source(source_id, ctx.input(appendName("v_in"))*(1.0/RES));
+}
+
+void FunctionalVoltageSource::stampOperatingPoint(OperatingPoint& op)
+{
+	op.stampConductance(1.0/RES, P, N);
+	op.stampCurrent(op.input(appendName("v_in"))*(1.0/RES), P, N);
+}
+
 } //namespace lblmc
@@ -61,6 +61,12 @@ public:
 	inline std::string generateInputs();
 	inline std::string generateOutputs(std::string output = "ALL") { return std::string(""); }
 	std::string generateUpdateBody();
+
+	inline bool isInterpretable() const { return true; }
+	void interpretStep(InterpreterContext& ctx) const;
+
+	inline bool hasOperatingPoint() const { return true; }
+	void stampOperatingPoint(OperatingPoint& op);
 };
 
 } //namespace lblmc
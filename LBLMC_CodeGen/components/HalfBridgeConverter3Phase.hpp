@@ -108,6 +108,10 @@ public:
 	std::string generateOutputsUpdateBody(std::string output="ALL");
 	std::string generateUpdateBody();
 
+	inline bool isInterpretable() const { return true; }
+	inline unsigned int getNumberOfInterpreterStates() const { return 5; }
+	void interpretStep(InterpreterContext& ctx) const;
+
 private:
 
 	std::string generateCPVoltageOutputUpdateBody();
@@ -22,6 +22,7 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "HalfBridgeConverter3Phase2.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "ReferenceInterpreter.hpp"
 #include "../SimulationEngineGenerator.hpp"
 #include "../codegen/Object.hpp"
 #include "../codegen/ArrayObject.hpp"
@@ -116,8 +117,8 @@ void HalfBridgeConverter3Phase2::stampSources(SystemSourceVectorGenerator& gen)
 
 std::string HalfBridgeConverter3Phase2::generateParameters()
 {
-	const static double HOC = DT/CAP;
-	const static double HOL = DT/IND;
+	const double HOC = DT/CAP;
+	const double HOL = DT/IND;
 
 	std::stringstream sstrm;
 	sstrm <<
@@ -639,4 +640,79 @@ std::string HalfBridgeConverter3Phase2::generateLCCurrentOutputUpdateBody()
 	return sstrm.str();
 }
 
+void HalfBridgeConverter3Phase2::interpretStep(InterpreterContext& ctx) const
+{
+	// states: vc1, vc2, il1, il2, il3
+	double* vc = ctx.states;
+	double* il = ctx.states+2;
+
+	const double HOC = DT/CAP;
+	const double HOL = DT/IND;
+	const double eneu_past = ctx.x[G];
+	const double eout_past[3] = { ctx.x[A], ctx.x[B], ctx.x[C] };
+	const double vc_past[2] = { vc[0], vc[1] };
+	const double il_past[3] = { il[0], il[1], il[2] };
+	const bool sw_en = ctx.input(appendName("sw_en")) != 0.0;
+
+	//a# for upper caps, b# for lower caps, v for inductors
+	double a[3], b[3], v[3];
+
+	for(unsigned int k = 0; k < 3; k++)
+	{
+		if(sw_en) //switches are enabled
+		{
+			if(ctx.input(appendName("sw_ctrl"), k) != 0.0)
+			{
+				a[k] = il_past[k];
+				b[k] = 0.0;
+				v[k] = vc_past[0];
+			}
+			else
+			{
+				a[k] = 0.0;
+				b[k] = il_past[k];
+				v[k] = vc_past[1];
+			}
+		}
+		else if(il_past[k] > 0.0) //both switches off; anti-parallel diodes conduct
+		{
+			v[k] = vc_past[1];
+			a[k] = 0.0;
+			b[k] = -il_past[k];
+		}
+		else
+		{
+			if(il_past[k] < 0.0)
+				v[k] = vc_past[0];
+			else
+				v[k] = eout_past[k];
+			a[k] = il_past[k];
+			b[k] = 0.0;
+		}
+	}
+
+	const double ipos = CAP_CONDUCTANCE*(ctx.x[P] - vc_past[0] - eneu_past);
+	const double ineg = CAP_CONDUCTANCE*(ctx.x[N] - vc_past[1] - eneu_past);
+
+	for(unsigned int k = 0; k < 3; k++)
+	{
+		il[k] = il_past[k] + HOL*( v[k] + eneu_past - eout_past[k] - RES*il_past[k]);
+	}
+
+	vc[0] = HOC*(ipos - a[0] - a[1] - a[2]) + vc_past[0];
+	vc[1] = HOC*(ineg - b[0] - b[1] - b[2]) + vc_past[1];
+
+	ctx.source(source_id_P, vc[0]*CAP_CONDUCTANCE);
+	ctx.source(source_id_N, vc[1]*CAP_CONDUCTANCE);
+	ctx.source(source_id_A, il[0]);
+	ctx.source(source_id_B, il[1]);
+	ctx.source(source_id_C, il[2]);
+
+	ctx.output(appendName("cp_voltage"), vc[0]);
+	ctx.output(appendName("cn_voltage"), vc[1]);
+	ctx.output(appendName("la_current"), il[0]);
+	ctx.output(appendName("lb_current"), il[1]);
+	ctx.output(appendName("lc_current"), il[2]);
+}
+
 } //namespace lblmc
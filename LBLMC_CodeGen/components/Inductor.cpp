@@ -22,6 +22,8 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "Inductor.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "ReferenceInterpreter.hpp"
+#include "OperatingPoint.hpp"
 #include "../codegen/Object.hpp"
 
 #include <stdexcept>
@@ -37,7 +39,11 @@ Inductor::Inductor(std::string comp_name) :
     IND(1.0),
     P(0),
     N(0),
-    source_id(0)
+    source_id(0),
+    short_id(0),
+    epos_initial(0.0),
+    eneg_initial(0.0),
+    current_initial(0.0)
 {
 	if(comp_name == "")
 	{
@@ -51,7 +57,11 @@ Inductor::Inductor(std::string comp_name, double dt, double ind) :
 	IND(ind),
 	P(0),
 	N(0),
-	source_id(0)
+	source_id(0),
+	short_id(0),
+	epos_initial(0.0),
+	eneg_initial(0.0),
+	current_initial(0.0)
 {
 	if(comp_name == "")
 	{
@@ -70,7 +80,11 @@ Inductor::Inductor(const Inductor& base) :
 	IND(base.IND),
 	P(base.P),
 	N(base.N),
-	source_id(base.source_id)
+	source_id(base.source_id),
+	short_id(base.short_id),
+	epos_initial(base.epos_initial),
+	eneg_initial(base.eneg_initial),
+	current_initial(base.current_initial)
 {}
 
 void Inductor::getSourceIds(std::vector<unsigned int>& ids) const
@@ -117,13 +131,17 @@ std::string Inductor::generateFields()
 	std::fixed <<
 	std::scientific;
 
+	//at the operating point the inductor is shorted and its equivalent current carries its current
+
+	const double current_eq = 0.0 - current_initial; //no negative zero when de-energized
+
 	sstrm <<
-	"static "<<"real "<<appendName("epos_past")       <<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<appendName("eneg_past")       <<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<appendName("delta_v")         <<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<appendName("current")         <<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<appendName("current_eq")      <<" = "<<0.0<<";\n" <<
-	"static "<<"real "<<appendName("current_eq_past") <<" = "<<0.0<<";\n" ;
+	"static "<<"real "<<appendName("epos_past")       <<" = "<<epos_initial<<";\n" <<
+	"static "<<"real "<<appendName("eneg_past")       <<" = "<<eneg_initial<<";\n" <<
+	"static "<<"real "<<appendName("delta_v")         <<" = "<<epos_initial - eneg_initial<<";\n" <<
+	"static "<<"real "<<appendName("current")         <<" = "<<current_initial<<";\n" <<
+	"static "<<"real "<<appendName("current_eq")      <<" = "<<current_eq<<";\n" <<
+	"static "<<"real "<<appendName("current_eq_past") <<" = "<<current_eq<<";\n" ;
 
 	return sstrm.str();
 }
@@ -191,4 +209,36 @@ std::string Inductor::generateUpdateBody()
 	return sstrm.str();
 }
 
+void Inductor::interpretStep(InterpreterContext& ctx) const
+{
+	double& current_eq = ctx.states[0];
+
+	const double HOL2 = DT/2.0/IND;
+	const double delta_v = ctx.x[P] - ctx.x[N];
+	const double current = HOL2*delta_v - current_eq;
+
+	current_eq = -current - HOL2*delta_v;
+
+	ctx.source(source_id, current_eq);
+
+	ctx.output(appendName("l_current"), current);
+}
+
+void Inductor::initInterpreterStates(double* states) const
+{
+	states[0] = -current_initial;
+}
+
+void Inductor::stampOperatingPoint(OperatingPoint& op)
+{
+	short_id = op.insertShort(P, N);
+}
+
+void Inductor::setOperatingPoint(const OperatingPoint* op)
+{
+	epos_initial = (op != nullptr) ? op->getVoltage(P) : 0.0;
+	eneg_initial = (op != nullptr) ? op->getVoltage(N) : 0.0;
+	current_initial = (op != nullptr) ? op->getShortCurrent(short_id) : 0.0;
+}
+
 } //namespace lblmc
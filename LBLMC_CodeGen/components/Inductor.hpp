@@ -38,6 +38,10 @@ private:
 	double IND;
 	unsigned int P, N;
 	unsigned int source_id;
+	unsigned int short_id;    ///< id of the short of the inductor in the operating point analysis
+	double epos_initial;      ///< voltage of the positive terminal at the operating point
+	double eneg_initial;      ///< voltage of the negative terminal at the operating point
+	double current_initial;   ///< current from the positive to the negative terminal at the operating point
 
 public:
 
@@ -75,6 +79,15 @@ public:
 	std::string generateOutputs(std::string output = "ALL");
 	std::string generateOutputsUpdateBody(std::string output = "ALL");
 	std::string generateUpdateBody();
+
+	inline bool isInterpretable() const { return true; }
+	inline unsigned int getNumberOfInterpreterStates() const { return 1; }
+	void interpretStep(InterpreterContext& ctx) const;
+	void initInterpreterStates(double* states) const;
+
+	inline bool hasOperatingPoint() const { return true; }
+	void stampOperatingPoint(OperatingPoint& op);
+	void setOperatingPoint(const OperatingPoint* op);
 };
 
 } //namespace lblmc
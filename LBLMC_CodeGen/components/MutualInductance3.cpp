@@ -22,6 +22,8 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "MutualInductance3.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "ReferenceInterpreter.hpp"
+#include "OperatingPoint.hpp"
 #include "../SimulationEngineGenerator.hpp"
 #include "../codegen/Object.hpp"
 #include "../codegen/ArrayObject.hpp"
@@ -39,7 +41,8 @@ MutualInductance3::MutualInductance3(std::string comp_name) :
 	DT(0), L1(0), L2(0), L3(0), M12(0), M23(0), M31(0), D(0),
 	K1(0), K2(0), K3(0), K4(0), K5(0), K6(0), K7(0), K8(0), K9(0),
 	PA(0), NA(0), PB(0), NB(0), PC(0), NC(0),
-	source_id_A(0), source_id_B(0), source_id_C(0)
+	source_id_A(0), source_id_B(0), source_id_C(0),
+	short_ids{0, 0, 0}, voltages_initial{0.0, 0.0, 0.0}, currents_initial{0.0, 0.0, 0.0}
 {}
 
 MutualInductance3::MutualInductance3
@@ -57,7 +60,8 @@ MutualInductance3::MutualInductance3
 	DT(dt), L1(l1), L2(l2), L3(l3), M12(m12), M23(m23), M31(m31), D(0),
 	K1(0), K2(0), K3(0), K4(0), K5(0), K6(0), K7(0), K8(0), K9(0),
 	PA(0), NA(0), PB(0), NB(0), PC(0), NC(0),
-	source_id_A(0), source_id_B(0), source_id_C(0)
+	source_id_A(0), source_id_B(0), source_id_C(0),
+	short_ids{0, 0, 0}, voltages_initial{0.0, 0.0, 0.0}, currents_initial{0.0, 0.0, 0.0}
 {
 	D = ( DT / (L3*M12*M12 - (2.0)*M12*M23*M31 + L1*M23*M23 + L2*M31*M31 - L1*L2*L3 ) );
     K1 = (M23*M23 - L2*L3  );
@@ -79,7 +83,10 @@ MutualInductance3::MutualInductance3(const MutualInductance3& base) :
 	K1(base.K1), K2(base.K2), K3(base.K3), K4(base.K4), K5(base.K5), K6(base.K6), K7(base.K7),
 	K8(base.K8), K9(base.K9),
 	PA(base.PA), NA(base.NA), PB(base.PB), NB(base.NB), PC(base.PC), NC(base.NC),
-	source_id_A(base.source_id_A), source_id_B(base.source_id_B), source_id_C(base.source_id_C)
+	source_id_A(base.source_id_A), source_id_B(base.source_id_B), source_id_C(base.source_id_C),
+	short_ids{base.short_ids[0], base.short_ids[1], base.short_ids[2]},
+	voltages_initial{base.voltages_initial[0], base.voltages_initial[1], base.voltages_initial[2]},
+	currents_initial{base.currents_initial[0], base.currents_initial[1], base.currents_initial[2]}
 {}
 
 void MutualInductance3::getSourceIds(std::vector<unsigned int>& ids) const
@@ -166,15 +173,17 @@ std::string MutualInductance3::generateFields()
 	std::fixed <<
 	std::scientific;
 
-	generateField(sstrm, "voltage1", 0);
-	generateField(sstrm, "voltage2", 0);
-	generateField(sstrm, "voltage3", 0);
-	generateField(sstrm, "current1", 0);
-	generateField(sstrm, "current2", 0);
-	generateField(sstrm, "current3", 0);
-	generateField(sstrm, "current_comp1", 0);
-	generateField(sstrm, "current_comp2", 0);
-	generateField(sstrm, "current_comp3", 0);
+	//at the operating point the windings are shorted and the compensation currents carry their currents
+
+	generateField(sstrm, "voltage1", voltages_initial[0]);
+	generateField(sstrm, "voltage2", voltages_initial[1]);
+	generateField(sstrm, "voltage3", voltages_initial[2]);
+	generateField(sstrm, "current1", currents_initial[0]);
+	generateField(sstrm, "current2", currents_initial[1]);
+	generateField(sstrm, "current3", currents_initial[2]);
+	generateField(sstrm, "current_comp1", 0.0 - currents_initial[0]);
+	generateField(sstrm, "current_comp2", 0.0 - currents_initial[1]);
+	generateField(sstrm, "current_comp3", 0.0 - currents_initial[2]);
 
 	return sstrm.str();
 }
@@ -271,4 +280,44 @@ std::string MutualInductance3::generateUpdateBody()
 	return body;
 }
 
+void MutualInductance3::interpretStep(InterpreterContext& ctx) const
+{
+	double* current_comp = ctx.states;
+
+	const double voltage1 = ctx.x[PA] - ctx.x[NA];
+	const double voltage2 = ctx.x[PB] - ctx.x[NB];
+	const double voltage3 = ctx.x[PC] - ctx.x[NC];
+
+	current_comp[0] = current_comp[0] - D*( K1*voltage1 + K2*voltage2 + K3*voltage3 );
+	current_comp[1] = current_comp[1] - D*( K4*voltage1 + K5*voltage2 + K6*voltage3 );
+	current_comp[2] = current_comp[2] - D*( K7*voltage1 + K8*voltage2 + K9*voltage3 );
+
+	ctx.source(source_id_A, current_comp[0]);
+	ctx.source(source_id_B, current_comp[1]);
+	ctx.source(source_id_C, current_comp[2]);
+}
+
+void MutualInductance3::initInterpreterStates(double* states) const
+{
+	for(unsigned int i = 0; i < 3; i++) states[i] = -currents_initial[i];
+}
+
+void MutualInductance3::stampOperatingPoint(OperatingPoint& op)
+{
+	short_ids[0] = op.insertShort(PA, NA);
+	short_ids[1] = op.insertShort(PB, NB);
+	short_ids[2] = op.insertShort(PC, NC);
+}
+
+void MutualInductance3::setOperatingPoint(const OperatingPoint* op)
+{
+	const unsigned int terminals[6] = {PA, NA, PB, NB, PC, NC};
+
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		voltages_initial[i] = (op != nullptr) ? op->getVoltage(terminals[2*i]) - op->getVoltage(terminals[2*i+1]) : 0.0;
+		currents_initial[i] = (op != nullptr) ? op->getShortCurrent(short_ids[i]) : 0.0;
+	}
+}
+
 } //namespace lblmc
@@ -56,6 +56,10 @@ private:
 	unsigned int PA, NA, PB, NB, PC, NC;
 	unsigned int source_id_A, source_id_B, source_id_C;
 
+	unsigned int short_ids[3];         ///< ids of the shorts of the windings in the operating point analysis
+	double voltages_initial[3];        ///< voltages of the windings at the operating point
+	double currents_initial[3];        ///< currents of the windings from positive to negative terminal at the operating point
+
 public:
 
 	MutualInductance3(std::string comp_name);
@@ -127,6 +131,15 @@ public:
 	std::string generateParameters();
 	std::string generateFields();
 	std::string generateUpdateBody();
+
+	inline bool isInterpretable() const { return true; }
+	inline unsigned int getNumberOfInterpreterStates() const { return 3; }
+	void interpretStep(InterpreterContext& ctx) const;
+	void initInterpreterStates(double* states) const;
+
+	inline bool hasOperatingPoint() const { return true; }
+	void stampOperatingPoint(OperatingPoint& op);
+	void setOperatingPoint(const OperatingPoint* op);
 };
 
 } //namespace lblmc
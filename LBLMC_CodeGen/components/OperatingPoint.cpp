@@ -0,0 +1,158 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "OperatingPoint.hpp"
+
+#include <stdexcept>
+
+namespace lblmc
+{
+
+OperatingPoint::OperatingPoint(unsigned int num_solutions, const InterpreterSignals& inputs) :
+	num_solutions(num_solutions),
+	inputs(inputs),
+	g(MatrixRMXd::Zero(num_solutions, num_solutions)),
+	j(num_solutions, 0.0),
+	short_terminals(),
+	x(num_solutions+1, 0.0),
+	short_currents(),
+	solved(false)
+{
+	if(num_solutions == 0)
+		throw std::invalid_argument("OperatingPoint::constructor(): num_solutions must be positive nonzero value");
+}
+
+void OperatingPoint::stampConductance(double conductance, unsigned int p, unsigned int n)
+{
+	if(p > num_solutions || n > num_solutions)
+		throw std::invalid_argument("OperatingPoint::stampConductance(): given node index/indices are outside the model");
+
+	if(p != 0) g(p-1, p-1) += conductance;
+	if(n != 0) g(n-1, n-1) += conductance;
+
+	if(p != 0 && n != 0)
+	{
+		g(p-1, n-1) -= conductance;
+		g(n-1, p-1) -= conductance;
+	}
+
+	solved = false;
+}
+
+void OperatingPoint::stampCurrent(double current, unsigned int p, unsigned int n)
+{
+	if(p > num_solutions || n > num_solutions)
+		throw std::invalid_argument("OperatingPoint::stampCurrent(): given node index/indices are outside the model");
+
+	if(p != 0) j[p-1] += current;
+	if(n != 0) j[n-1] -= current;
+
+	solved = false;
+}
+
+unsigned int OperatingPoint::insertShort(unsigned int p, unsigned int n)
+{
+	if(p > num_solutions || n > num_solutions)
+		throw std::invalid_argument("OperatingPoint::insertShort(): given node index/indices are outside the model");
+
+	short_terminals.push_back(p);
+	short_terminals.push_back(n);
+
+	solved = false;
+
+	return short_terminals.size()/2 - 1;
+}
+
+double OperatingPoint::input(const std::string& name, unsigned int index) const
+{
+	auto signal = inputs.find(name);
+
+	if(signal == inputs.end() || index >= signal->second.size()) return 0.0;
+
+	return signal->second[index];
+}
+
+void OperatingPoint::solve(double gmin)
+{
+	const unsigned int num_shorts = short_terminals.size()/2;
+	const unsigned int dimension = num_solutions + num_shorts;
+
+	// node equations G*v + A*i = J and short equations A'*v = 0 of the modified nodal analysis
+	MatrixRMXd a = MatrixRMXd::Zero(dimension, dimension);
+	Eigen::VectorXd rhs = Eigen::VectorXd::Zero(dimension);
+
+	a.topLeftCorner(num_solutions, num_solutions) = g;
+
+	for(unsigned int n = 0; n < num_solutions; n++)
+	{
+		a(n, n) += gmin;
+		rhs(n) = j[n];
+	}
+
+	for(unsigned int s = 0; s < num_shorts; s++)
+	{
+		const unsigned int p = short_terminals[2*s];
+		const unsigned int n = short_terminals[2*s+1];
+		const unsigned int row = num_solutions + s;
+
+		if(p != 0) { a(p-1, row) += 1.0; a(row, p-1) += 1.0; }
+		if(n != 0) { a(n-1, row) -= 1.0; a(row, n-1) -= 1.0; }
+	}
+
+	Eigen::FullPivLU<MatrixRMXd> lu(a);
+
+	if(!lu.isInvertible())
+		throw std::runtime_error("OperatingPoint::solve(): DC network is singular; check for loops of inductances or shorted terminals");
+
+	Eigen::VectorXd solution = lu.solve(rhs);
+
+	x[0] = 0.0;
+	for(unsigned int n = 0; n < num_solutions; n++) x[n+1] = solution(n);
+
+	short_currents.resize(num_shorts);
+	for(unsigned int s = 0; s < num_shorts; s++) short_currents[s] = solution(num_solutions + s);
+
+	solved = true;
+}
+
+double OperatingPoint::getVoltage(unsigned int node) const
+{
+	if(!solved)
+		throw std::runtime_error("OperatingPoint::getVoltage(): operating point has not been solved");
+
+	if(node > num_solutions)
+		throw std::invalid_argument("OperatingPoint::getVoltage(): given node index is outside the model");
+
+	return x[node];
+}
+
+double OperatingPoint::getShortCurrent(unsigned int id) const
+{
+	if(!solved)
+		throw std::runtime_error("OperatingPoint::getShortCurrent(): operating point has not been solved");
+
+	if(id >= short_currents.size())
+		throw std::invalid_argument("OperatingPoint::getShortCurrent(): no short of given id");
+
+	return short_currents[id];
+}
+
+} //namespace lblmc
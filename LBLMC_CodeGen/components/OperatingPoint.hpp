@@ -0,0 +1,144 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LBLMC_OPERATINGPOINT_HPP
+#define LBLMC_OPERATINGPOINT_HPP
+
+#include <vector>
+#include <string>
+
+#include "ReferenceInterpreter.hpp"
+#include "../CodeGenDataTypes.hpp"
+
+namespace lblmc
+{
+
+/**
+	\brief DC operating point analysis of a system model
+
+	Components stamp their DC equivalents, with capacitances open and inductances shorted, into
+	a modified nodal analysis of the model's nodes.  Each short adds the current through it as an
+	unknown besides the node voltages.  Once solved, the components read their node voltages and
+	short currents to set their initial fields.
+
+	A small conductance gmin from every node to ground keeps nodes connected only through
+	capacitances solvable; such nodes settle at zero.
+
+	\see Component::stampOperatingPoint()
+	\see SystemModel::initializeOperatingPoint()
+
+	\note This class is NOT intended for RTL Synthesis.
+**/
+class OperatingPoint
+{
+
+private:
+
+	unsigned int num_solutions;
+	InterpreterSignals inputs;
+	MatrixRMXd g;
+	std::vector<double> j;
+	std::vector<unsigned int> short_terminals;  ///< positive and negative node of each short
+	std::vector<double> x;                      ///< node voltages, ground first
+	std::vector<double> short_currents;
+	bool solved;
+
+public:
+
+	OperatingPoint() = delete;
+
+	/**
+		\brief parameter constructor
+		\param num_solutions number of nodes of the model, excluding ground
+		\param inputs values of the input signals at the operating point; inputs not given are zero
+	**/
+	explicit OperatingPoint(unsigned int num_solutions, const InterpreterSignals& inputs = InterpreterSignals());
+
+	/**
+		\brief stamps a conductance between two nodes
+		\param conductance conductance in siemens
+		\param p first node; 0 for ground
+		\param n second node; 0 for ground
+	**/
+	void stampConductance(double conductance, unsigned int p, unsigned int n);
+
+	/**
+		\brief stamps a current source
+		\param current current injected into node p and drawn from node n
+		\param p positive node; 0 for ground
+		\param n negative node; 0 for ground
+	**/
+	void stampCurrent(double current, unsigned int p, unsigned int n);
+
+	/**
+		\brief inserts a short circuit between two nodes whose current becomes an unknown
+		\param p positive node; 0 for ground
+		\param n negative node; 0 for ground
+		\return id of the short to get its current with getShortCurrent()
+	**/
+	unsigned int insertShort(unsigned int p, unsigned int n);
+
+	/**
+		\param name full name of the input signal, e.g. "v_in_fv"
+		\param index index of the value in the flattened signal
+		\return value of the input signal at the operating point; zero if not given
+	**/
+	double input(const std::string& name, unsigned int index = 0) const;
+
+	/**
+		\brief solves the node voltages and short currents
+		\param gmin conductance from every node to ground
+		\throw std::runtime_error if the DC network is singular, such as with a loop of shorts
+	**/
+	void solve(double gmin = 1.0e-12);
+
+	/**
+		\return true if solve() has been called since the last stamp
+	**/
+	inline bool isSolved() const { return solved; }
+
+	/**
+		\param node node index; 0 for ground
+		\return voltage of the node at the operating point
+	**/
+	double getVoltage(unsigned int node) const;
+
+	/**
+		\param id id of the short given by insertShort()
+		\return current through the short from its positive to its negative node
+	**/
+	double getShortCurrent(unsigned int id) const;
+
+	/**
+		\return voltages of the nodes at the operating point, ground first; same as the solutions x
+		of the engine
+	**/
+	inline const std::vector<double>& getSolutions() const { return x; }
+
+	/**
+		\return number of nodes of the model, excluding ground
+	**/
+	inline unsigned int getNumberOfSolutions() const { return num_solutions; }
+};
+
+} //namespace lblmc
+
+#endif // LBLMC_OPERATINGPOINT_HPP
@@ -0,0 +1,348 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "ReferenceInterpreter.hpp"
+#include "Component.hpp"
+#include "SystemModel.hpp"
+#include "../SimulationEngineGenerator.hpp"
+#include "../EngineLibrary.hpp"
+
+#include <stdexcept>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+namespace lblmc
+{
+
+double InterpreterContext::input(const std::string& name, unsigned int index) const
+{
+	auto signal = inputs->find(name);
+
+	if(signal == inputs->end() || index >= signal->second.size())
+		throw std::runtime_error("InterpreterContext::input(): input " + name + " has not been set");
+
+	return signal->second[index];
+}
+
+void InterpreterContext::output(const std::string& name, double value, unsigned int index)
+{
+	std::vector<double>& signal = (*outputs)[name];
+
+	if(index >= signal.size()) signal.resize(index+1, 0.0);
+
+	signal[index] = value;
+}
+
+ReferenceInterpreter::ReferenceInterpreter(SystemModel& model) :
+	model_name(model.getModelName()),
+	num_solutions(model.getNumberOfSolutions()),
+	components(), state_offsets(), update_rates(), update_phases(), inv_g(), node_offsets(), node_sources(), initial_x(),
+	states(), x(), b(), b_components(), inputs(), outputs(), step_count(0)
+{
+	SimulationEngineGenerator& gen = model.getSolverCodeGenerator();
+	const SystemSourceVectorGenerator& ssvg = gen.getSourceVectorGenerator();
+
+	unsigned int num_sources = 0;
+	unsigned int num_states = 0;
+
+	for(unsigned int i = 0; i < model.getNumberOfComponents(); i++)
+	{
+		const Component* component = model.getComponentAt(i);
+
+		if(!component->isInterpretable())
+			throw std::runtime_error("ReferenceInterpreter::constructor(): component " + component->getName() + " cannot be interpreted");
+
+		components.push_back(component);
+		state_offsets.push_back(num_states);
+		update_rates.push_back(component->getUpdateRate());
+
+		num_sources += component->getNumberOfSources();
+		num_states += component->getNumberOfInterpreterStates();
+	}
+
+	if(components.empty() || ssvg.getDimension() != num_solutions || ssvg.getNumSources() != num_sources)
+		throw std::runtime_error("ReferenceInterpreter::constructor(): model must be set up with SystemModel::setupSolverCodeGenerator()");
+
+	// slow components take the phases of the generator's slow update bodies in order; components
+	// without update code have no body and are never scheduled in the engine
+	const std::vector<unsigned int>& body_rates = gen.getComponentUpdateRates();
+	const std::vector<unsigned int> body_phases = gen.planUpdatePhases();
+	unsigned int body = 0;
+
+	update_phases.assign(components.size(), 0);
+
+	for(unsigned int i = 0; i < components.size(); i++)
+	{
+		if(update_rates[i] == 1) continue;
+
+		if(model.getComponent(components[i]->getName())->generateUpdateBody().empty())
+		{
+			update_rates[i] = 1;
+			continue;
+		}
+
+		while(body < body_rates.size() && body_rates[body] == 1) body++;
+
+		if(body == body_rates.size() || body_rates[body] != update_rates[i])
+			throw std::runtime_error("ReferenceInterpreter::constructor(): update rate of component " + components[i]->getName() + " changed since SystemModel::setupSolverCodeGenerator()");
+
+		update_phases[i] = body_phases[body++];
+	}
+
+	while(body < body_rates.size() && body_rates[body] == 1) body++;
+
+	if(body != body_rates.size())
+		throw std::runtime_error("ReferenceInterpreter::constructor(): component update rates changed since SystemModel::setupSolverCodeGenerator()");
+
+	inv_g = gen.getConductanceGenerator().invert().asEigen3Matrix();
+
+	node_offsets.push_back(0);
+	for(unsigned int n = 1; n <= num_solutions; n++)
+	{
+		auto sources = ssvg.asVector(n);
+		node_sources.insert(node_sources.end(), sources.begin(), sources.end());
+		node_offsets.push_back(node_sources.size());
+	}
+
+	initial_x.assign(num_solutions+1, 0.0);
+	const std::vector<double>& initial_solutions = gen.getInitialSolutions();
+	std::copy(initial_solutions.begin(), initial_solutions.end(), initial_x.begin()+1);
+
+	states.resize(num_states);
+	x.resize(num_solutions+1);
+	b.resize(num_solutions);
+	b_components.resize(num_sources);
+
+	reset();
+}
+
+void ReferenceInterpreter::reset()
+{
+	std::fill(states.begin(), states.end(), 0.0);
+
+	for(unsigned int i = 0; i < components.size(); i++)
+	{
+		components[i]->initInterpreterStates(states.data() + state_offsets[i]);
+	}
+
+	x = initial_x;
+	std::fill(b.begin(), b.end(), 0.0);
+	std::fill(b_components.begin(), b_components.end(), 0.0);
+	outputs.clear();
+	step_count = 0;
+}
+
+void ReferenceInterpreter::setInput(const std::string& name, double value, unsigned int index)
+{
+	std::vector<double>& signal = inputs[name];
+
+	if(index >= signal.size()) signal.resize(index+1, 0.0);
+
+	signal[index] = value;
+}
+
+void ReferenceInterpreter::step()
+{
+	InterpreterContext ctx;
+	ctx.x = x.data();
+	ctx.b_components = b_components.data();
+	ctx.inputs = &inputs;
+	ctx.outputs = &outputs;
+
+	for(unsigned int i = 0; i < components.size(); i++)
+	{
+		// slow components keep their source contributions from their last update
+		if(step_count > 0 && step_count % update_rates[i] != update_phases[i])
+			continue;
+
+		ctx.states = states.data() + state_offsets[i];
+
+		try
+		{
+			components[i]->interpretStep(ctx);
+		}
+		catch(const std::runtime_error& error)
+		{
+			throw std::runtime_error("ReferenceInterpreter::step(): " + components[i]->getName() + ": " + error.what());
+		}
+	}
+
+	for(unsigned int n = 0; n < num_solutions; n++)
+	{
+		double sum = 0.0;
+
+		for(unsigned int k = node_offsets[n]; k < node_offsets[n+1]; k++)
+		{
+			const long source = node_sources[k];
+
+			if(source >= 0) sum += b_components[source-1];
+			else sum -= b_components[-source-1];
+		}
+
+		b[n] = sum;
+	}
+
+	for(unsigned int r = 0; r < num_solutions; r++)
+	{
+		double sum = 0.0;
+
+		for(unsigned int c = 0; c < num_solutions; c++)
+		{
+			sum += inv_g(r,c) * b[c];
+		}
+
+		x[r+1] = sum;
+	}
+
+	step_count++;
+}
+
+double ReferenceInterpreter::getOutput(const std::string& name, unsigned int index) const
+{
+	auto signal = outputs.find(name);
+
+	if(signal == outputs.end() || index >= signal->second.size())
+		throw std::invalid_argument("ReferenceInterpreter::getOutput(): model has no output " + name);
+
+	return signal->second[index];
+}
+
+/// \return the error of an engine value against a reference value
+static inline double comparisonError(double value, double reference)
+{
+	return std::abs(value - reference) / std::max(1.0, std::abs(reference));
+}
+
+InterpreterComparison ReferenceInterpreter::compareWithEngine
+(
+	const EngineLibrary& engine,
+	unsigned long num_steps,
+	const std::function<void(unsigned long step, InterpreterSignals& inputs)>& stimulus,
+	double tolerance
+)
+{
+	struct Signal
+	{
+		std::string name;
+		unsigned int size;
+		unsigned int offset;
+	};
+
+	if(!engine.hasFunction(model_name + "_simulationEngineFlat"))
+		throw std::runtime_error("ReferenceInterpreter::compareWithEngine(): engine library has no flat export of model " + model_name);
+
+	auto engine_step = engine.getFunction<void(double*, const double*, double*)>(model_name + "_simulationEngineFlat");
+
+	std::vector<Signal> engine_inputs;
+	std::vector<Signal> engine_outputs;
+	unsigned int num_inputs = 0;
+	unsigned int num_outputs = 0;
+
+	std::istringstream layout(static_cast<const char*>(engine.getSymbol(model_name + "_signalLayout")));
+	std::string direction;
+	Signal signal;
+
+	while(layout >> direction >> signal.name >> signal.size)
+	{
+		if(direction == "in")
+		{
+			signal.offset = num_inputs;
+			num_inputs += signal.size;
+			engine_inputs.push_back(signal);
+		}
+		else
+		{
+			signal.offset = num_outputs;
+			num_outputs += signal.size;
+			engine_outputs.push_back(signal);
+		}
+	}
+
+	std::vector<double> engine_x(num_solutions);
+	std::vector<double> engine_in(num_inputs);
+	std::vector<double> engine_out(num_outputs);
+
+	InterpreterComparison result;
+	result.steps = num_steps;
+	result.max_error = 0.0;
+	result.passed = true;
+	result.first_failed_step = num_steps;
+	result.first_failed_signal = "";
+
+	auto check = [&](unsigned long step, const std::string& name, double value, double reference)
+	{
+		const double error = comparisonError(value, reference);
+
+		// NaN errors fail the comparison as well
+		if(!(error <= result.max_error)) result.max_error = error;
+
+		if(!(error <= tolerance) && result.passed)
+		{
+			result.passed = false;
+			result.first_failed_step = step;
+			result.first_failed_signal = name;
+		}
+	};
+
+	reset();
+
+	for(unsigned long k = 0; k < num_steps; k++)
+	{
+		stimulus(k, inputs);
+
+		for(const auto& in : engine_inputs)
+		{
+			auto values = inputs.find(in.name);
+
+			if(values == inputs.end() || values->second.size() < in.size)
+				throw std::runtime_error("ReferenceInterpreter::compareWithEngine(): input " + in.name + " has not been set by the stimulus");
+
+			std::copy(values->second.begin(), values->second.begin()+in.size, engine_in.begin()+in.offset);
+		}
+
+		engine_step(engine_x.data(), engine_in.data(), engine_out.data());
+		step();
+
+		for(unsigned int i = 0; i < num_solutions; i++)
+		{
+			check(k, "x_out[" + std::to_string(i) + "]", engine_x[i], x[i+1]);
+		}
+
+		for(const auto& out : engine_outputs)
+		{
+			auto values = outputs.find(out.name);
+
+			if(values == outputs.end() || values->second.size() != out.size)
+				throw std::runtime_error("ReferenceInterpreter::compareWithEngine(): engine output " + out.name + " is not an output of the interpreter");
+
+			for(unsigned int i = 0; i < out.size; i++)
+			{
+				check(k, out.size == 1 ? out.name : out.name + "[" + std::to_string(i) + "]", engine_out[out.offset+i], values->second[i]);
+			}
+		}
+	}
+
+	return result;
+}
+
+} //namespace lblmc
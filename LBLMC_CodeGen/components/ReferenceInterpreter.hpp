@@ -0,0 +1,239 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef LBLMC_REFERENCEINTERPRETER_HPP
+#define LBLMC_REFERENCEINTERPRETER_HPP
+
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+
+#include "../CodeGenDataTypes.hpp"
+
+namespace lblmc
+{
+
+class Component;
+class SystemModel;
+class EngineLibrary;
+
+/// signals of a model by name; each holds the flattened values of the signal, with bools as 0 or 1
+typedef std::map<std::string, std::vector<double>> InterpreterSignals;
+
+/**
+	\brief view of the data a component works on in one interpreted time step
+
+	\see Component::interpretStep()
+**/
+struct InterpreterContext
+{
+	double* states;                    ///< states of the component; as set by Component::initInterpreterStates() after reset
+	const double* x;                   ///< solutions of the previous step; x[0] is ground and always 0
+	double* b_components;              ///< source contributions of the step, indexed by source id - 1
+	const InterpreterSignals* inputs;  ///< input signals of the step
+	InterpreterSignals* outputs;       ///< output signals of the step
+
+	/**
+		\param name full name of the input signal, e.g. "sw_en_hb"
+		\param index index of the value in the flattened signal
+		\return value of the input signal
+		\throw std::runtime_error if the input has not been set
+	**/
+	double input(const std::string& name, unsigned int index = 0) const;
+
+	/**
+		\brief sets a value of an output signal
+		\param name full name of the output signal, e.g. "l_current_l1"
+		\param value value of the output
+		\param index index of the value in the flattened signal
+	**/
+	void output(const std::string& name, double value, unsigned int index = 0);
+
+	/**
+		\brief sets the contribution of a source of the component
+		\param source_id nonzero id of the source given by SystemSourceVectorGenerator::insertSource()
+		\param value the source current
+	**/
+	inline void source(unsigned int source_id, double value) { b_components[source_id-1] = value; }
+};
+
+/**
+	\brief result of ReferenceInterpreter::compareWithEngine()
+**/
+struct InterpreterComparison
+{
+	unsigned long steps;               ///< number of steps compared
+	double max_error;                  ///< largest error found over all steps and signals
+	bool passed;                       ///< true if no error exceeded the tolerance
+	unsigned long first_failed_step;   ///< first step whose error exceeded the tolerance; steps if none
+	std::string first_failed_signal;   ///< signal that first exceeded the tolerance; empty if none
+};
+
+/**
+	\brief simulates a system model directly on the host without generating and compiling its engine
+
+	The interpreter solves the same discretized network as the generated engine: each step, the
+	components' interpretStep() compute their source contributions from the previous solutions,
+	the contributions are aggregated into the source vector by the model's source incidence, and
+	the solutions are found by multiplying with the inverted conductance matrix.  All arithmetic
+	is in double precision with the full inverted matrix.
+
+	Components with an update rate above one are interpreted on the same schedule as the
+	engine: every component on the first step, then each on the phase planned by
+	SimulationEngineGenerator::planUpdatePhases(), holding its source contributions in between.
+
+	Start-up is immediate, so the interpreter suits short what-if runs, and, being independent of
+	the generated code, it serves as a reference to check generated engines against with
+	compareWithEngine().
+
+	The interpreter captures the model when constructed; the model must have been set up with
+	SystemModel::setupSolverCodeGenerator() and must outlive the interpreter.  Changes to the
+	model afterwards require a new interpreter.
+
+	\note This class is NOT intended for RTL Synthesis.
+**/
+class ReferenceInterpreter
+{
+
+private:
+
+	std::string model_name;
+	unsigned int num_solutions;
+	std::vector<const Component*> components;
+	std::vector<unsigned int> state_offsets;  ///< offset of each component's states in states
+	std::vector<unsigned int> update_rates;   ///< steps between updates of each component
+	std::vector<unsigned int> update_phases;  ///< phase of each component's updates in the schedule
+	MatrixRMXd inv_g;
+	std::vector<unsigned int> node_offsets;   ///< CSR offsets into node_sources for each solution
+	std::vector<long> node_sources;           ///< CSR signed source ids aggregated into each solution
+	std::vector<double> initial_x;            ///< solutions after reset, ground first
+
+	std::vector<double> states;
+	std::vector<double> x;
+	std::vector<double> b;
+	std::vector<double> b_components;
+	InterpreterSignals inputs;
+	InterpreterSignals outputs;
+	unsigned long step_count;
+
+public:
+
+	ReferenceInterpreter() = delete;
+
+	/**
+		\brief parameter constructor; captures the given model for simulation
+		\param model system model that has been set up for code generation
+		\throw std::runtime_error if the model has not been set up, a component cannot be
+		interpreted, or the conductance matrix is singular
+	**/
+	explicit ReferenceInterpreter(SystemModel& model);
+
+	/**
+		\brief resets the solutions and component states to the initial state of the engine, and the
+		output signals to zero; inputs are kept
+
+		The initial state is zero unless the model was initialized at its operating point with
+		SystemModel::initializeOperatingPoint() before the interpreter was constructed.
+	**/
+	void reset();
+
+	/**
+		\brief sets a value of an input signal
+		\param name full name of the input signal as in the engine, e.g. "sw_en_hb"
+		\param value value of the input; bools are given as 0 or 1
+		\param index index of the value in the flattened signal
+	**/
+	void setInput(const std::string& name, double value, unsigned int index = 0);
+
+	/**
+		\return the input signals, for setting many at once
+	**/
+	inline InterpreterSignals& getInputs() { return inputs; }
+
+	/**
+		\brief simulates one time step of the model
+		\throw std::runtime_error if an input needed by a component has not been set
+	**/
+	void step();
+
+	/**
+		\return the solutions of the last step; same as x_out of the engine
+	**/
+	inline const double* getSolutions() const { return x.data()+1; }
+
+	/**
+		\return number of solutions of the model
+	**/
+	inline unsigned int getNumberOfSolutions() const { return num_solutions; }
+
+	/**
+		\param name full name of the output signal as in the engine, e.g. "l_current_l1"
+		\param index index of the value in the flattened signal
+		\return value of the output signal after the last step
+		\throw std::invalid_argument if the model has no such output
+	**/
+	double getOutput(const std::string& name, unsigned int index = 0) const;
+
+	/**
+		\return the output signals after the last step
+	**/
+	inline const InterpreterSignals& getOutputs() const { return outputs; }
+
+	/**
+		\return number of steps simulated since construction or the last reset
+	**/
+	inline unsigned long getStepCount() const { return step_count; }
+
+	/**
+		\brief runs the interpreter and a compiled engine of the same model side by side and
+		compares their solutions and output signals after every step
+
+		The interpreter is reset first, and both are given the same inputs each step from the
+		stimulus.  The engine is driven through the <model>_simulationEngineFlat() export of
+		SimulationEngineGenerator::compileAndLoad(); since engines keep their state in static or
+		library-owned storage, it must be freshly loaded and not stepped before.
+
+		The error of a value is |engine - reference| / max(1, |reference|), so the tolerance is
+		absolute for values of magnitude below one and relative above.
+
+		\param engine engine library of the model from compileAndLoad()
+		\param num_steps number of steps to compare
+		\param stimulus called before each step with the step index to set the interpreter's inputs
+		\param tolerance largest error accepted
+		\return summary of the comparison
+		\throw std::runtime_error if the engine has no flat export or its signals do not match the
+		interpreter's
+	**/
+	InterpreterComparison compareWithEngine
+	(
+		const EngineLibrary& engine,
+		unsigned long num_steps,
+		const std::function<void(unsigned long step, InterpreterSignals& inputs)>& stimulus,
+		double tolerance = 1.0e-9
+	);
+
+};
+
+} //namespace lblmc
+
+#endif // LBLMC_REFERENCEINTERPRETER_HPP
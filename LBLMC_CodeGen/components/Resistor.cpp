@@ -22,6 +22,7 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "Resistor.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "OperatingPoint.hpp"
 
 namespace lblmc
 {
@@ -69,4 +70,9 @@ void Resistor::stampConductance(SystemConductanceGenerator& gen)
 	gen.stampConductance(1.0/RES, P, N);
 }
 
+void Resistor::stampOperatingPoint(OperatingPoint& op)
+{
+	op.stampConductance(1.0/RES, P, N);
+}
+
 } //namespace lblmc
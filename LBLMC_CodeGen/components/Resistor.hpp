@@ -58,6 +58,12 @@ public:
 	inline std::string generateInputs() { return std::string(""); }
 	inline std::string generateOutputs(std::string output = "ALL") { return std::string(""); }
 	inline std::string generateUpdateBody() { return std::string(""); }
+
+	inline bool isInterpretable() const { return true; }
+	inline void interpretStep(InterpreterContext& ctx) const {}
+
+	inline bool hasOperatingPoint() const { return true; }
+	void stampOperatingPoint(OperatingPoint& op);
 };
 
 } //namespace lblmc
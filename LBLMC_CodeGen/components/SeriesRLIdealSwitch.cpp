@@ -22,6 +22,8 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "SeriesRLIdealSwitch.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "ReferenceInterpreter.hpp"
+#include "OperatingPoint.hpp"
 #include "../SimulationEngineGenerator.hpp"
 #include "../codegen/Object.hpp"
 #include "../codegen/ArrayObject.hpp"
@@ -40,7 +42,9 @@ SeriesRLIdealSwitch::SeriesRLIdealSwitch(std::string comp_name) :
 	L(1.0),
 	R(1.0),
 	P(0), N(0),
-	source_id(0)
+	source_id(0),
+	current_initial(0.0),
+	sw_initial(false)
 {}
 
 SeriesRLIdealSwitch::SeriesRLIdealSwitch(std::string comp_name, double dt, double l, double r) :
@@ -49,7 +53,9 @@ SeriesRLIdealSwitch::SeriesRLIdealSwitch(std::string comp_name, double dt, doubl
 	L(l),
 	R(r),
 	P(0), N(0),
-	source_id(0)
+	source_id(0),
+	current_initial(0.0),
+	sw_initial(false)
 {}
 
 SeriesRLIdealSwitch::SeriesRLIdealSwitch(const SeriesRLIdealSwitch& base) :
@@ -58,7 +64,9 @@ SeriesRLIdealSwitch::SeriesRLIdealSwitch(const SeriesRLIdealSwitch& base) :
 	L(base.L),
 	R(base.R),
 	P(base.P), N(base.N),
-	source_id(base.source_id)
+	source_id(base.source_id),
+	current_initial(base.current_initial),
+	sw_initial(base.sw_initial)
 {}
 
 void SeriesRLIdealSwitch::stampConductance(SystemConductanceGenerator& gen)
@@ -79,7 +87,7 @@ std::string SeriesRLIdealSwitch::generateParameters()
 	std::fixed <<
 	std::scientific;
 
-	const static double HOL = DT/L;
+	const double HOL = DT/L;
 
 	generateParameter(sstrm, "DT", DT);
 	generateParameter(sstrm, "L", L);
@@ -97,8 +105,8 @@ std::string SeriesRLIdealSwitch::generateFields()
 	std::fixed <<
 	std::scientific;
 
-	generateField(sstrm, "current_past", 0.0);
-	generateBoolField(sstrm, "sw_past", false);
+	generateField(sstrm, "current_past", current_initial);
+	generateBoolField(sstrm, "sw_past", sw_initial);
 
 	return sstrm.str();
 }
@@ -183,4 +191,40 @@ std::string SeriesRLIdealSwitch::generateUpdateBody()
 	return body;
 }
 
+void SeriesRLIdealSwitch::interpretStep(InterpreterContext& ctx) const
+{
+	double& current_past = ctx.states[0];
+	double& sw_past = ctx.states[1];
+
+	double current = 0.0; //force de-energizing of inductor to zero when switch open
+
+	if(sw_past != 0.0)
+	{
+		current = current_past + DT/L*(ctx.x[P] - R*current_past - ctx.x[N]);
+	}
+
+	current_past = current;
+	sw_past = (ctx.input(appendName("sw")) != 0.0) ? 1.0 : 0.0;
+
+	ctx.source(source_id, -current);
+}
+
+void SeriesRLIdealSwitch::initInterpreterStates(double* states) const
+{
+	states[0] = current_initial;
+	states[1] = sw_initial ? 1.0 : 0.0;
+}
+
+void SeriesRLIdealSwitch::stampOperatingPoint(OperatingPoint& op)
+{
+	//with the inductance shorted, a closed switch leaves the resistance and an open switch nothing
+	if(op.input(appendName("sw")) != 0.0) op.stampConductance(1.0/R, P, N);
+}
+
+void SeriesRLIdealSwitch::setOperatingPoint(const OperatingPoint* op)
+{
+	sw_initial = (op != nullptr) && (op->input(appendName("sw")) != 0.0);
+	current_initial = sw_initial ? (op->getVoltage(P) - op->getVoltage(N))/R : 0.0;
+}
+
 } //namespace lblmc
@@ -40,6 +40,8 @@ private:
 
 	unsigned int P, N;
 	unsigned int source_id;
+	double current_initial;  ///< current from the positive to the negative terminal at the operating point
+	bool sw_initial;         ///< state of the switch at the operating point
 
 public:
 
@@ -81,6 +83,15 @@ public:
 	std::string generateFields();
 	std::string generateInputs();
 	std::string generateUpdateBody();
+
+	inline bool isInterpretable() const { return true; }
+	inline unsigned int getNumberOfInterpreterStates() const { return 2; }
+	void interpretStep(InterpreterContext& ctx) const;
+	void initInterpreterStates(double* states) const;
+
+	inline bool hasOperatingPoint() const { return true; }
+	void stampOperatingPoint(OperatingPoint& op);
+	void setOperatingPoint(const OperatingPoint* op);
 };
 
 } //namespace lblmc
@@ -21,6 +21,7 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 
 #include "SystemModel.hpp"
 #include "Component.hpp"
+#include "OperatingPoint.hpp"
 #include "../SimulationEngineGenerator.hpp"
 
 #include <stdexcept>
@@ -110,6 +111,13 @@ const Component* SystemModel::getComponent(std::string name) const
 	return nullptr;
 }
 
+const Component* SystemModel::getComponentAt(unsigned int index) const
+{
+	if(index >= components.size()) return nullptr;
+
+	return components[index].get();
+}
+
 bool SystemModel::componentNamesUnique() const
 {
 	for(auto i = components.begin(); i != components.end(); i++)
@@ -138,10 +146,58 @@ void SystemModel::setupSolverCodeGenerator()
 
 	for(auto& component : components)
 	{
+		component->setOperatingPoint(nullptr);
 		component->stampSystem(sim_eng_gen);
 	}
 }
 
+std::vector<double> SystemModel::initializeOperatingPoint(const InterpreterSignals& inputs, double gmin)
+{
+	const unsigned int num_solutions = sim_eng_gen.getNumberOfSolutions();
+
+	if(components.size() == 0 || sim_eng_gen.getSourceVectorGenerator().getDimension() != num_solutions)
+		throw std::runtime_error("SystemModel::initializeOperatingPoint(): model must be set up with setupSolverCodeGenerator()");
+
+	OperatingPoint op(num_solutions, inputs);
+
+	for(auto& component : components)
+	{
+		if(!component->hasOperatingPoint())
+			throw std::runtime_error("SystemModel::initializeOperatingPoint(): component " + component->getName() + " does not support operating point analysis");
+
+		component->stampOperatingPoint(op);
+	}
+
+	op.solve(gmin);
+
+	sim_eng_gen.clearComponentFieldsCode();
+
+	for(auto& component : components)
+	{
+		component->setOperatingPoint(&op);
+		sim_eng_gen.insertComponentFieldsCode(component->generateFields());
+	}
+
+	const std::vector<double>& x = op.getSolutions();
+	sim_eng_gen.setInitialSolutions(std::vector<double>(x.begin()+1, x.end()));
+
+	return x;
+}
+
+void SystemModel::updateSolverParameters()
+{
+	SystemConductanceGenerator& scg = sim_eng_gen.getConductanceGenerator();
+
+	scg.reset(sim_eng_gen.getNumberOfSolutions());
+	sim_eng_gen.clearComponentParametersCode();
+
+	for(auto& component : components)
+	{
+		component->stampConductance(scg);
+		sim_eng_gen.insertComponentParametersCode(component->generateParameters());
+	}
+}
+
 std::string SystemModel::generateSolverCode(double zero_bound) const
 {
 	return sim_eng_gen.generateCFunction(zero_bound);
@@ -152,4 +208,45 @@ void SystemModel::generateSolverCodeAndExport(std::string filename, double zero_
 	sim_eng_gen.generateCFunctionAndExport(filename, zero_bound);
 }
 
+void SystemModel::generateDriverAndExport
+(
+	std::string filename,
+	std::string solver_header,
+	std::vector<std::string> recorded_outputs
+) const
+{
+	sim_eng_gen.generateDriverAndExport(filename, solver_header, recorded_outputs);
+}
+
+void SystemModel::generateStreamLayoutAndExport(std::string filename) const
+{
+	sim_eng_gen.generateStreamLayoutAndExport(filename);
+}
+
+void SystemModel::generateRealTimeRunnerAndExport(std::string filename, std::string solver_header) const
+{
+	sim_eng_gen.generateRealTimeRunnerAndExport(filename, solver_header);
+}
+
+HLSEstimate SystemModel::estimateHLS(const HLSEstimatorParameters& costs, double zero_bound) const
+{
+	return sim_eng_gen.estimateHLS(costs, zero_bound);
+}
+
+EngineLibrary SystemModel::compileAndLoad(double zero_bound) const
+{
+	return sim_eng_gen.compileAndLoad(zero_bound);
+}
+
+std::vector<std::string> SystemModel::generateSolverCodeAndExportMultiUnit
+(
+	std::string basename,
+	unsigned int num_component_units,
+	unsigned int num_solver_units,
+	double zero_bound
+) const
+{
+	return sim_eng_gen.generateCFunctionAndExportMultiUnit(basename, num_component_units, num_solver_units, zero_bound);
+}
+
 } //namespace lblmc
@@ -26,6 +26,7 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include <memory>
 #include <string>
 #include "Component.hpp"
+#include "ReferenceInterpreter.hpp"
 #include "../SimulationEngineGenerator.hpp"
 
 namespace lblmc
@@ -153,6 +154,14 @@ public:
 	**/
 	const Component* getComponent(std::string name) const;
 
+	/**
+		\brief gets a component in system model by its index in order of insertion
+
+		\param index index of the component; less than getNumberOfComponents()
+		\return constant raw observing pointer to component; nullptr if index is out of range
+	**/
+	const Component* getComponentAt(unsigned int index) const;
+
 	/**
 		\brief checks if components of system model all have unique names
 
@@ -172,11 +181,56 @@ public:
 		method should also be called again at least once if components are added or removed since
 		last call to this method.
 
+		The components start de-energized, with all fields and solutions zero, until
+		initializeOperatingPoint() is called.
+
 		\throw std::runtime_error if component names are not unique or no components exist in model
 
 	**/
 	void setupSolverCodeGenerator();
 
+	/**
+		\brief solves the DC operating point of the model and makes it the initial state of the
+		generated solver, so simulations start at steady state instead of de-energized
+
+		The operating point is found with capacitances open and inductances shorted, from the
+		sources' values and the given inputs.  The components' fields are regenerated with their
+		values at the operating point, and the node voltages become the solver's initial solutions
+		through SimulationEngineGenerator::setInitialSolutions().  ReferenceInterpreter objects
+		constructed afterwards start from the same state.
+
+		This method must be called after setupSolverCodeGenerator(), which returns the model to
+		the de-energized initial state, and again after the components' parameters change.
+
+		\param inputs values of the input signals at the operating point, e.g. "v_in_fv" or
+		"sw_rl"; inputs not given are zero
+		\param gmin conductance from every node to ground that keeps nodes connected only through
+		capacitances solvable; such nodes start at zero
+		\return solutions at the operating point, ground first
+
+		\throw std::runtime_error if the model has not been set up, a component does not support
+		the operating point analysis, or the DC network is singular
+	**/
+	std::vector<double> initializeOperatingPoint
+	(
+		const InterpreterSignals& inputs = InterpreterSignals(),
+		double gmin = 1.0e-12
+	);
+
+	/**
+		\brief re-stamps the conductance matrix and regenerates the component parameters code
+		after parameters of the model's components change
+
+		This is a faster alternative to setupSolverCodeGenerator() for parameter sweeps with an
+		engine generated with runtime parameters, where only the parameter values and inverted
+		conductance matrix change between sweep points.  The conductance matrix is re-inverted on
+		the next generation.  The components must not be added, removed, or reconnected since the
+		last call to setupSolverCodeGenerator().
+
+		\see SimulationEngineGenerator::generateRuntimeParameters()
+	**/
+	void updateSolverParameters();
+
 	/**
 		\return the solver code generator used by system model to generate code
 	**/
@@ -189,7 +243,8 @@ public:
 		\brief generates C++ definition of a function that solves the system model
 
 		\note the generated function contains static variables and therefore not usable for
-		multiple instances of the solver, nor is thread safe.
+		multiple instances of the solver, nor is thread safe, unless the solver code generator's
+		parameter reentrant_engine_enable is set.
 
 		\param zero_bound range from zero where elements in system inverted conductance matrix and
 		operations on said elements are discarded during code generation
@@ -204,7 +259,8 @@ public:
 		code to file
 
 		\note the generated function contains static variables and therefore not usable for
-		multiple instances of the solver, nor is thread safe.
+		multiple instances of the solver, nor is thread safe, unless the solver code generator's
+		parameter reentrant_engine_enable is set.
 
 		\param filename name of the file (header) that will store the solver function definition
 		\param zero_bound range from zero where elements in system inverted conductance matrix and
@@ -214,6 +270,95 @@ public:
 
 	**/
 	void generateSolverCodeAndExport(std::string filename, double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief generates a host-side driver program that runs the solver exported by
+		generateSolverCodeAndExport() offline with input waveforms read from files
+
+		\param filename name of the driver source file
+		\param solver_header name of the solver header as it is to be included by the driver
+		\param recorded_outputs names of the output signals to record, with "x_out" for the
+		solutions; empty to record the solutions and all output signals
+
+		\see SimulationEngineGenerator::generateDriverAndExport()
+	**/
+	void generateDriverAndExport
+	(
+		std::string filename,
+		std::string solver_header,
+		std::vector<std::string> recorded_outputs = std::vector<std::string>()
+	) const;
+
+	/**
+		\brief exports the byte layout of the input and output stream words of the solver to a C++
+		header shared by the host and the solver's stream interface
+
+		\param filename name of the layout header
+		\see SimulationEngineGenerator::generateStreamLayoutAndExport()
+	**/
+	void generateStreamLayoutAndExport(std::string filename) const;
+
+	/**
+		\brief generates a header-only real-time runner for the solver of the system model and
+		exports it to a C++ header
+
+		\param filename name of the runner header
+		\param solver_header name of the solver header as it is to be included by the runner
+		\see SimulationEngineGenerator::generateRealTimeRunnerAndExport()
+	**/
+	void generateRealTimeRunnerAndExport(std::string filename, std::string solver_header) const;
+
+	/**
+		\brief estimates the latency and resource usage of the solver of the system model when
+		synthesized by Xilinx HLS at the configured clock period
+
+		\param costs delay and resource costs of the HLS operators
+		\param zero_bound range from zero where elements in system inverted conductance matrix and
+		source vector are treated as zero and discarded from generated solver code
+		\return estimated latency and resources of the solver
+		\see SimulationEngineGenerator::estimateHLS()
+	**/
+	HLSEstimate estimateHLS
+	(
+		const HLSEstimatorParameters& costs = HLSEstimatorParameters(),
+		double zero_bound = 1.0e-12
+	) const;
+
+	/**
+		\brief compiles the solver of the system model into a shared library and loads it into the
+		running process; unchanged models are reloaded from the build cache without compiling
+
+		\param zero_bound range from zero where elements in system inverted conductance matrix and
+		source vector are treated as zero and discarded from generated solver code
+		\return handle to the loaded solver library
+		\see SimulationEngineGenerator::compileAndLoad()
+	**/
+	EngineLibrary compileAndLoad(double zero_bound = 1.0e-12) const;
+
+	/**
+		\brief generates the solver of the system model split across multiple C++ source files that
+		can be compiled in parallel
+
+		\note the generated solver keeps its state in namespace scope variables and therefore is not
+		usable for multiple instances of the solver, nor is thread safe.
+
+		\param basename path and name of the generated files without extension
+		\param num_component_units maximum number of partitions the component updates are split into
+		\param num_solver_units maximum number of row blocks the solver is split into
+		\param zero_bound range from zero where elements in system inverted conductance matrix and
+		operations on said elements are discarded during code generation
+
+		\return names of the generated source files
+
+		\see SimulationEngineGenerator::generateCFunctionAndExportMultiUnit()
+	**/
+	std::vector<std::string> generateSolverCodeAndExportMultiUnit
+	(
+		std::string basename,
+		unsigned int num_component_units = 4,
+		unsigned int num_solver_units = 4,
+		double zero_bound = 1.0e-12
+	) const;
 };
 
 } //namespace lblmc
@@ -22,6 +22,8 @@ along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.
 #include "VoltageSource.hpp"
 #include "../SystemConductanceGenerator.hpp"
 #include "../SystemSourceVectorGenerator.hpp"
+#include "ReferenceInterpreter.hpp"
+#include "OperatingPoint.hpp"
 
 #include <stdexcept>
 #include <sstream>
@@ -118,4 +120,15 @@ std::string VoltageSource::generateUpdateBody()
 	return sstrm.str();
 }
 
+void VoltageSource::interpretStep(InterpreterContext& ctx) const
+{
+	ctx.source(source_id, VOLTAGE/RES);
+}
+
+void VoltageSource::stampOperatingPoint(OperatingPoint& op)
+{
+	op.stampConductance(1.0/RES, P, N);
+	op.stampCurrent(VOLTAGE/RES, P, N);
+}
+
 } //namespace lblmc
@@ -63,6 +63,12 @@ public:
 	inline std::string generateInputs() { return std::string(""); }
 	inline std::string generateOutputs(std::string output = "ALL") { return std::string(""); }
 	std::string generateUpdateBody();
+
+	inline bool isInterpretable() const { return true; }
+	void interpretStep(InterpreterContext& ctx) const;
+
+	inline bool hasOperatingPoint() const { return true; }
+	void stampOperatingPoint(OperatingPoint& op);
 };
 
 } //namespace lblmc
@@ -0,0 +1,888 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Code Generation Library.
+
+LB-LMC Solver C++ Code Generation Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Code Generation Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Code Generation Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+	Engine mode check program
+
+	Generates the simulation engine of a reference RLC model in each code generation mode,
+	compiles it with SimulationEngineGenerator::compileAndLoad(), and checks it step by step
+	against the ReferenceInterpreter.  Also checks that cached regeneration and regeneration
+	after a parameter change match a fresh generator, an engine with two instances of a
+	component type, the checkpoint round trip, the DC operating point, the multi-unit threaded
+	engine (built with the generated host driver), and the multi-rate update schedule.
+
+	Build from the LBLMC_CodeGen directory (Eigen 3 is required):
+
+	c++ -std=c++11 -O1 -I. -I/usr/include/eigen3 -o engine_mode_check examples/EngineModeCheck.cpp \
+		$(find . components -maxdepth 1 -name '*.cpp') -ldl -pthread
+
+	Run as "engine_mode_check [work_directory]"; engines are built in work_directory, by default
+	lblmc_check in $TMPDIR or /tmp.  The program prints one line per check and exits with
+	status 1 if any check fails.
+*/
+
+#include "../components/SystemModel.hpp"
+#include "../components/ReferenceInterpreter.hpp"
+#include "../components/VoltageSource.hpp"
+#include "../components/Resistor.hpp"
+#include "../components/Inductor.hpp"
+#include "../components/Capacitor.hpp"
+#include "../components/SeriesRLIdealSwitch.hpp"
+#include "../components/FunctionalVoltageSource.hpp"
+#include "../components/HalfBridgeConverter3Phase.hpp"
+#include "../SimulationEngineGenerator.hpp"
+#include "../EngineLibrary.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lblmc;
+
+namespace
+{
+
+const double DT = 50e-9;              ///< base time step of the reference model
+const unsigned int NUM_SOLUTIONS = 5; ///< number of solutions of the reference model
+const unsigned long NUM_STEPS = 5000; ///< number of steps each engine is compared over
+
+std::string work_directory;
+unsigned int num_failed = 0;
+
+/**
+	\brief builds the reference model into an empty system model
+
+	<pre>
+	vs: 400 V, 10 mOhm      1 - 0
+	sw: 1 mH, 2 Ohm switch  1 - 2   input sw_sw
+	c1: 100 uF              2 - 0
+	r1: 10 Ohm              2 - 3
+	l1: 1 mH                3 - 4   output l_current_l1
+	r2: 5 Ohm               4 - 0
+	fv: 100 mOhm            5 - 0   input v_in_fv
+	r3: 3 Ohm               5 - 4
+	</pre>
+
+	The switch is a latency element, explicit in the solutions, so c1 keeps its node stiff.
+
+	\param model empty model named by the caller
+	\param rate update rate of l1 and c1, which then integrate with a time step of rate*DT
+**/
+void buildReferenceModel(SystemModel& model, unsigned int rate = 1)
+{
+	auto* vs = new VoltageSource("vs", 400.0, 0.01);
+	vs->setTerminalConnections(1, 0);
+	model.addComponent(vs);
+
+	auto* sw = new SeriesRLIdealSwitch("sw", DT, 1e-3, 2.0);
+	sw->setTerminalConnections(1, 2);
+	model.addComponent(sw);
+
+	auto* c1 = new Capacitor("c1", rate*DT, 1e-4);
+	c1->setTerminalConnections(2, 0);
+	c1->setUpdateRate(rate);
+	model.addComponent(c1);
+
+	auto* r1 = new Resistor("r1", 10.0);
+	r1->setTerminalConnections(2, 3);
+	model.addComponent(r1);
+
+	auto* l1 = new Inductor("l1", rate*DT, 1e-3);
+	l1->setTerminalConnections(3, 4);
+	l1->setUpdateRate(rate);
+	model.addComponent(l1);
+
+	auto* r2 = new Resistor("r2", 5.0);
+	r2->setTerminalConnections(4, 0);
+	model.addComponent(r2);
+
+	auto* fv = new FunctionalVoltageSource("fv", 0.1);
+	fv->setTerminalConnections(5, 0);
+	model.addComponent(fv);
+
+	auto* r3 = new Resistor("r3", 3.0);
+	r3->setTerminalConnections(5, 4);
+	model.addComponent(r3);
+
+	model.setupSolverCodeGenerator();
+}
+
+/// \brief toggles the switch and steps the functional source, so every engine path is exercised
+void stimulus(unsigned long step, InterpreterSignals& inputs)
+{
+	inputs["sw_sw"] = { double((step/700) % 4 != 3) };
+	inputs["v_in_fv"] = { (step/300) % 2 ? 10.0 : -5.0 };
+}
+
+/// \brief holds the inputs of the DC operating point
+void constantStimulus(unsigned long, InterpreterSignals& inputs)
+{
+	inputs["sw_sw"] = { 1.0 };
+	inputs["v_in_fv"] = { 10.0 };
+}
+
+/// \brief raises max_error to the relative error of value against reference; a NaN error sticks
+void accumulateError(double& max_error, double value, double reference)
+{
+	const double error = std::abs(value - reference) / std::max(1.0, std::abs(reference));
+
+	if(!(error <= max_error)) max_error = error;
+}
+
+void report(const std::string& check, bool passed, const std::string& detail)
+{
+	std::printf("%-4s %-36s %s\n", passed ? "ok" : "FAIL", check.c_str(), detail.c_str());
+
+	if(!passed) num_failed++;
+}
+
+void reportComparison(const std::string& check, const InterpreterComparison& result)
+{
+	char detail[160];
+
+	if(result.passed)
+		std::snprintf(detail, sizeof(detail), "max error %.3e over %lu steps", result.max_error, result.steps);
+	else
+		std::snprintf(detail, sizeof(detail), "max error %.3e, first failed at step %lu on %s", result.max_error, result.first_failed_step, result.first_failed_signal.c_str());
+
+	report(check, result.passed, detail);
+}
+
+/**
+	\brief steps an engine through its flat export, packing the inputs by the engine's signal layout
+**/
+class FlatEngine
+{
+	public:
+
+	FlatEngine(const EngineLibrary& engine, const std::string& model_name) :
+		step_function(engine.getFunction<void(double*, const double*, double*)>(model_name + "_simulationEngineFlat")),
+		x(NUM_SOLUTIONS)
+	{
+		std::istringstream layout(static_cast<const char*>(engine.getSymbol(model_name + "_signalLayout")));
+		std::string direction, name;
+		unsigned int size;
+
+		while(layout >> direction >> name >> size)
+		{
+			if(direction == "in")
+			{
+				input_names.push_back(name);
+				in.resize(in.size() + size);
+			}
+			else
+			{
+				out.resize(out.size() + size);
+			}
+		}
+	}
+
+	/// \return the solutions after the step
+	const std::vector<double>& step(unsigned long k, const std::function<void(unsigned long, InterpreterSignals&)>& stimulus)
+	{
+		InterpreterSignals signals;
+		stimulus(k, signals);
+
+		unsigned int offset = 0;
+		for(const auto& name : input_names)
+		{
+			for(double value : signals[name]) in[offset++] = value;
+		}
+
+		step_function(x.data(), in.data(), out.data());
+
+		return x;
+	}
+
+	/// \return the output signals after the step, packed in the order of the signal layout
+	inline const std::vector<double>& getOutputs() const { return out; }
+
+	private:
+
+	void (*step_function)(double*, const double*, double*);
+	std::vector<std::string> input_names;
+	std::vector<double> x;
+	std::vector<double> in;
+	std::vector<double> out;
+};
+
+/**
+	\brief compares the engine generated with the given parameters against the interpreter
+
+	\param check name of the check
+	\param configure sets the generator parameters of the mode on top of the defaults
+	\param tolerance maximum relative error
+**/
+void checkMode
+(
+	const std::string& check,
+	const std::function<void(SimulationEngineGeneratorParameters&)>& configure,
+	double tolerance = 1.0e-9
+)
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	configure(parameters);
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	ReferenceInterpreter interpreter(model);
+	EngineLibrary engine = model.compileAndLoad();
+
+	reportComparison(check, interpreter.compareWithEngine(engine, NUM_STEPS, stimulus, tolerance));
+}
+
+/**
+	\brief compares the recorded steps of the multi-step engine, continuing from the single step
+	engine, against the interpreter
+**/
+void checkMultiStep()
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	parameters.multi_step_enable = true;
+	parameters.multi_step_output_decimation = 1;
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	EngineLibrary engine = model.compileAndLoad();
+	auto steps = engine.getFunction<void(unsigned int, double(*)[NUM_SOLUTIONS], double*, const bool*, const double*)>("rlc_simulationEngineSteps");
+
+	std::vector<double> x_out(NUM_STEPS*NUM_SOLUTIONS);
+	std::vector<double> l_current(NUM_STEPS);
+	std::unique_ptr<bool[]> sw(new bool[NUM_STEPS]);
+	std::vector<double> v_in(NUM_STEPS);
+
+	for(unsigned long k = 0; k < NUM_STEPS; k++)
+	{
+		InterpreterSignals signals;
+		stimulus(k, signals);
+		sw[k] = signals["sw_sw"][0] != 0.0;
+		v_in[k] = signals["v_in_fv"][0];
+	}
+
+	// the single step engine starts, so the state shared with it is checked too
+	FlatEngine flat(engine, "rlc");
+	const unsigned int quarter = NUM_STEPS/4;
+	for(unsigned long k = 0; k < quarter; k++)
+	{
+		const std::vector<double>& x = flat.step(k, stimulus);
+		std::copy(x.begin(), x.end(), x_out.begin() + k*NUM_SOLUTIONS);
+		l_current[k] = flat.getOutputs()[0];
+	}
+
+	// two calls, so the state carried between calls is checked too
+	const unsigned int half = NUM_STEPS/2;
+	steps(half-quarter, reinterpret_cast<double(*)[NUM_SOLUTIONS]>(x_out.data() + quarter*NUM_SOLUTIONS), l_current.data() + quarter, sw.get() + quarter, v_in.data() + quarter);
+	steps(NUM_STEPS-half, reinterpret_cast<double(*)[NUM_SOLUTIONS]>(x_out.data() + half*NUM_SOLUTIONS), l_current.data() + half, sw.get() + half, v_in.data() + half);
+
+	ReferenceInterpreter interpreter(model);
+	double max_error = 0.0;
+
+	for(unsigned long k = 0; k < NUM_STEPS; k++)
+	{
+		stimulus(k, interpreter.getInputs());
+		interpreter.step();
+
+		for(unsigned int i = 0; i < NUM_SOLUTIONS; i++)
+			accumulateError(max_error, x_out[k*NUM_SOLUTIONS+i], interpreter.getSolutions()[i]);
+		accumulateError(max_error, l_current[k], interpreter.getOutput("l_current_l1"));
+	}
+
+	char detail[80];
+	std::snprintf(detail, sizeof(detail), "max error %.3e over %lu steps", max_error, NUM_STEPS);
+	report("multi-step", max_error <= 1.0e-9, detail);
+}
+
+/**
+	\brief runs the multi-unit threaded engine with the generated host driver and compares its
+	recorded solutions and outputs against the interpreter
+**/
+void checkMultiUnit()
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.thread_count = 2;
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	const std::string directory = work_directory + "/multi_unit";
+	if(std::system(("mkdir -p " + directory).c_str()) != 0)
+		throw std::runtime_error("cannot create " + directory);
+
+	std::vector<std::string> sources = model.generateSolverCodeAndExportMultiUnit(directory + "/rlc");
+	model.generateDriverAndExport(directory + "/driver.cpp", "rlc.hpp");
+
+	std::ofstream sw_file(directory + "/sw_sw.bin", std::ios::binary);
+	std::ofstream v_in_file(directory + "/v_in_fv.bin", std::ios::binary);
+	for(unsigned long k = 0; k < NUM_STEPS; k++)
+	{
+		InterpreterSignals signals;
+		stimulus(k, signals);
+
+		const bool sw = signals["sw_sw"][0] != 0.0;
+		sw_file.write(reinterpret_cast<const char*>(&sw), sizeof(sw));
+		v_in_file.write(reinterpret_cast<const char*>(&signals["v_in_fv"][0]), sizeof(double));
+	}
+	sw_file.close();
+	v_in_file.close();
+
+	std::string build = parameters.jit_compiler + " " + parameters.jit_compiler_flags + " -pthread -o " + directory + "/driver " + directory + "/driver.cpp";
+	for(const auto& source : sources) build += " " + source;
+
+	const std::string run = directory + "/driver " + std::to_string(NUM_STEPS) + " 1 " + directory + "/out.bin " + directory + "/sw_sw.bin " + directory + "/v_in_fv.bin 2> " + directory + "/driver.log";
+
+	if(std::system(build.c_str()) != 0 || std::system(run.c_str()) != 0)
+	{
+		report("multi-unit threaded", false, "driver failed to build or run in " + directory);
+		return;
+	}
+
+	// records hold x_out followed by l_current_l1
+	std::vector<double> records(NUM_STEPS*(NUM_SOLUTIONS+1));
+	std::ifstream out_file(directory + "/out.bin", std::ios::binary);
+	out_file.read(reinterpret_cast<char*>(records.data()), records.size()*sizeof(double));
+
+	if(out_file.gcount() != std::streamsize(records.size()*sizeof(double)))
+	{
+		report("multi-unit threaded", false, "driver recorded too few steps");
+		return;
+	}
+
+	ReferenceInterpreter interpreter(model);
+	double max_error = 0.0;
+
+	for(unsigned long k = 0; k < NUM_STEPS; k++)
+	{
+		stimulus(k, interpreter.getInputs());
+		interpreter.step();
+
+		const double* record = &records[k*(NUM_SOLUTIONS+1)];
+		for(unsigned int i = 0; i < NUM_SOLUTIONS; i++)
+			accumulateError(max_error, record[i], interpreter.getSolutions()[i]);
+		accumulateError(max_error, record[NUM_SOLUTIONS], interpreter.getOutput("l_current_l1"));
+	}
+
+	char detail[80];
+	std::snprintf(detail, sizeof(detail), "max error %.3e over %lu steps", max_error, NUM_STEPS);
+	report("multi-unit threaded", max_error <= 1.0e-9, detail);
+}
+
+/**
+	\brief pins the worker of a multi-unit threaded engine to a CPU past CPU_SETSIZE and checks that
+	the engine reports the error
+**/
+void checkThreadPinning()
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.thread_count = 2;
+	parameters.thread_pinning_enable = true;
+	parameters.thread_cpu_offset = 1023;
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	const std::string directory = work_directory + "/thread_pinning";
+	if(std::system(("mkdir -p " + directory).c_str()) != 0)
+		throw std::runtime_error("cannot create " + directory);
+
+	std::vector<std::string> sources = model.generateSolverCodeAndExportMultiUnit(directory + "/rlc");
+
+	std::ofstream probe_file(directory + "/probe.cpp");
+	probe_file
+	<< "#include \"rlc.hpp\"\n"
+	<< "#include <cstdio>\n\n"
+	<< "int main() { std::printf(\"%d\\n\", rlc_getThreadPinningError()); return 0; }\n";
+	probe_file.close();
+
+	std::string build = parameters.jit_compiler + " " + parameters.jit_compiler_flags + " -pthread -o " + directory + "/probe " + directory + "/probe.cpp";
+	for(const auto& source : sources) build += " " + source;
+
+	const std::string run = directory + "/probe > " + directory + "/probe.txt";
+
+	int error = 0;
+	if(std::system(build.c_str()) != 0 || std::system(run.c_str()) != 0 || !(std::ifstream(directory + "/probe.txt") >> error))
+	{
+		report("thread pinning", false, "probe failed to build or run in " + directory);
+		return;
+	}
+
+	report("thread pinning", error != 0, "unpinnable worker reported error " + std::to_string(error));
+}
+
+/**
+	\brief runs a reentrant instrumented engine on two threads at once, each with its own state, and
+	checks that the counters of each thread hold only its own steps
+**/
+void checkReentrantTiming()
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	parameters.reentrant_engine_enable = true;
+	parameters.instrumentation_enable = true;
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	EngineLibrary engine = model.compileAndLoad();
+
+	// the <model>_State type is not known here, so each thread keeps its state in a buffer
+	auto init_state = engine.getFunction<void(void*)>("rlc_initState");
+	auto step = engine.getFunction<void(void*, double*, double*, bool, double)>("rlc_simulationEngine");
+	auto write_timing = engine.getFunction<void(std::FILE*)>("rlc_writeTiming");
+
+	const unsigned long num_steps[2] = { NUM_STEPS, NUM_STEPS/2 };
+	unsigned long long samples[2] = { 0, 0 };
+
+	auto run = [&](unsigned int thread)
+	{
+		alignas(64) unsigned char state[1 << 14];
+		init_state(state);
+
+		double x_out[NUM_SOLUTIONS];
+		double l_current;
+		for(unsigned long k = 0; k < num_steps[thread]; k++)
+		{
+			InterpreterSignals signals;
+			stimulus(k, signals);
+			step(state, x_out, &l_current, signals["sw_sw"][0] != 0.0, signals["v_in_fv"][0]);
+		}
+
+		// the line after the header holds the step counter
+		std::FILE* file = std::tmpfile();
+		if(!file) return;
+
+		write_timing(file);
+		std::rewind(file);
+
+		char header[256];
+		if(std::fgets(header, sizeof(header), file) && std::fscanf(file, " step %llu", &samples[thread]) != 1)
+			samples[thread] = 0;
+		std::fclose(file);
+	};
+
+	std::thread other(run, 1);
+	run(0);
+	other.join();
+
+	char detail[120];
+	std::snprintf(detail, sizeof(detail), "%llu and %llu step samples of threads running %lu and %lu steps", samples[0], samples[1], num_steps[0], num_steps[1]);
+	report("reentrant timing per thread", samples[0] == num_steps[0] && samples[1] == num_steps[1], detail);
+}
+
+/**
+	\brief checks that code regenerated from the generator's cache after mode changes is identical
+	to the code of a fresh generator
+**/
+void checkCachedRegeneration()
+{
+	SystemModel cached("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(cached);
+
+	SystemModel fresh("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(fresh);
+
+	SimulationEngineGenerator& generator = cached.getSolverCodeGenerator();
+	const SimulationEngineGeneratorParameters defaults = generator.getParameters();
+
+	const std::string first = cached.generateSolverCode();
+
+	SimulationEngineGeneratorParameters parameters = defaults;
+	parameters.source_slot_reorder_enable = true;
+	parameters.inv_conduct_matrix_rescale_enable = true;
+	generator.setParameters(parameters);
+	cached.generateSolverCode();
+
+	generator.setParameters(defaults);
+	const std::string again = cached.generateSolverCode();
+
+	const std::string reference = fresh.generateSolverCode();
+	const bool identical = first == reference && again == reference;
+
+	report("cached regeneration", identical, identical ? "identical to a fresh generator" : "differs from a fresh generator");
+}
+
+/**
+	\brief checks that the Xilinx HLS directives bind the products of a folded solver to a
+	multiplier implementation, and leave the unnamed products of the fully parallel solver unbound
+**/
+void checkHLSBinding()
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGenerator& generator = model.getSolverCodeGenerator();
+	SimulationEngineGeneratorParameters parameters = generator.getParameters();
+	parameters.xilinx_hls_enable = true;
+	parameters.xilinx_hls_directives_enable = true;
+	parameters.reentrant_engine_enable = true;
+	generator.setParameters(parameters);
+
+	const std::string parallel = model.generateSolverCode();
+
+	parameters.xilinx_hls_solver_lanes = 2;
+	generator.setParameters(parameters);
+	const std::string folded = model.generateSolverCode();
+
+	const bool parallel_unbound = parallel.find("BIND_OP") == std::string::npos;
+	const bool folded_bound = folded.find("const auto product = ") != std::string::npos &&
+	                          folded.find("#pragma HLS BIND_OP variable=product op=dmul impl=fulldsp") != std::string::npos;
+
+	report("HLS multiplier binding", parallel_unbound && folded_bound,
+	       std::string("parallel products ") + (parallel_unbound ? "unbound" : "bound") + ", folded products " + (folded_bound ? "bound" : "unbound"));
+}
+
+/**
+	\brief changes the switch inductance of a generated model with updateSolverParameters() and
+	checks the regenerated code and runtime parameters against a fresh generation, and the
+	regenerated engine against the interpreter
+**/
+void checkParameterSweep()
+{
+	const double swept_inductance = 3e-3;
+
+	SystemModel swept("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(swept);
+
+	SimulationEngineGeneratorParameters parameters = swept.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	parameters.runtime_parameters_enable = true;
+	swept.getSolverCodeGenerator().setParameters(parameters);
+
+	const std::vector<double> before = swept.getSolverCodeGenerator().generateRuntimeParameters();
+
+	static_cast<SeriesRLIdealSwitch*>(swept.getComponent("sw"))->setParameters(DT, swept_inductance, 2.0);
+	swept.updateSolverParameters();
+
+	SystemModel fresh("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(fresh);
+	static_cast<SeriesRLIdealSwitch*>(fresh.getComponent("sw"))->setParameters(DT, swept_inductance, 2.0);
+	fresh.setupSolverCodeGenerator();
+	fresh.getSolverCodeGenerator().setParameters(parameters);
+
+	const std::vector<double> after = swept.getSolverCodeGenerator().generateRuntimeParameters();
+	const bool identical =
+		after == fresh.getSolverCodeGenerator().generateRuntimeParameters() &&
+		swept.generateSolverCode() == fresh.generateSolverCode();
+
+	// the fresh generation runs in the same process, so the switch's derived DT/L is checked on its own too
+	const bool rederived = std::find_if(after.begin(), after.end(), [&](double value) { return std::abs(value - DT/swept_inductance) <= 1.0e-12*DT/swept_inductance; }) != after.end();
+
+	report
+	(
+		"parameter sweep",
+		identical && rederived && after != before,
+		std::string(identical ? "matches" : "differs from") + " a fresh generation, DT/L " + (rederived ? "re-derived" : "stale")
+	);
+
+	ReferenceInterpreter interpreter(swept);
+	reportComparison("parameter sweep engine", interpreter.compareWithEngine(swept.compileAndLoad(), NUM_STEPS, stimulus, 1.0e-9));
+}
+
+/**
+	\brief compares an engine with two instances each of the half bridge converter and the RL
+	switch, with different parameters, against the interpreter
+
+	Instances of a component type must not share the constants they derive from their
+	parameters.
+**/
+void checkInstances()
+{
+	SystemModel model("pair", 11);
+
+	auto* vs = new VoltageSource("vs", 400.0, 0.01);
+	vs->setTerminalConnections(1, 0);
+	model.addComponent(vs);
+
+	auto* hba = new HalfBridgeConverter3Phase("hba", DT, 1e-3, 1e-3, 0.01);
+	hba->setTerminalConnections(1, 2, 3, 4, 5);
+	model.addComponent(hba);
+
+	auto* hbb = new HalfBridgeConverter3Phase("hbb", DT, 2e-3, 3e-3, 0.01);
+	hbb->setTerminalConnections(1, 6, 7, 8, 9);
+	model.addComponent(hbb);
+
+	auto* swa = new SeriesRLIdealSwitch("swa", DT, 1e-3, 2.0);
+	swa->setTerminalConnections(1, 10);
+	model.addComponent(swa);
+
+	auto* swb = new SeriesRLIdealSwitch("swb", DT, 3e-3, 1.0);
+	swb->setTerminalConnections(1, 11);
+	model.addComponent(swb);
+
+	// resistive loads keep the nodes of the converter and switch latency elements stiff
+	const double loads[11] = { 5.0, 10.0, 10.0, 5.0, 5.0, 10.0, 10.0, 5.0, 1.0, 1.0 };
+	for(unsigned int node = 2; node <= 11; node++)
+	{
+		auto* load = new Resistor("r" + std::to_string(node), loads[node-2]);
+		load->setTerminalConnections(node, 0);
+		model.addComponent(load);
+	}
+
+	model.setupSolverCodeGenerator();
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	auto pair_stimulus = [](unsigned long step, InterpreterSignals& inputs)
+	{
+		inputs["sw_ctrl_hba"] = { double((step/100) % 2), double((step/170) % 2), double((step/230) % 2) };
+		inputs["sw_en_hba"] = { 1.0 };
+		inputs["sw_ctrl_hbb"] = { double((step/130) % 2), double((step/90) % 2), double((step/310) % 2) };
+		inputs["sw_en_hbb"] = { double((step/1000) % 4 != 3) };
+		inputs["sw_swa"] = { double((step/700) % 4 != 3) };
+		inputs["sw_swb"] = { double((step/500) % 3 != 2) };
+	};
+
+	ReferenceInterpreter interpreter(model);
+	reportComparison("two instances per type", interpreter.compareWithEngine(model.compileAndLoad(), NUM_STEPS, pair_stimulus, 1.0e-9));
+}
+
+/**
+	\brief saves the state of a checkpointed engine, runs on, restores the state, and checks that
+	the engine repeats the same steps; a snapshot with a corrupted header must be rejected
+**/
+void checkCheckpoint()
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	parameters.checkpoint_enable = true;
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	ReferenceInterpreter interpreter(model);
+	EngineLibrary engine = model.compileAndLoad();
+
+	// the <model>_State type is not known here, so the state is handled through void pointers
+	auto get_state = engine.getFunction<void*()>("rlc_getState");
+	auto save_state = engine.getFunction<std::size_t(const void*, unsigned char*, std::size_t)>("rlc_saveState");
+	auto restore_state = engine.getFunction<bool(void*, const unsigned char*, std::size_t)>("rlc_restoreState");
+
+	FlatEngine flat(engine, "rlc");
+
+	const unsigned long warmup = NUM_STEPS/2;
+	const unsigned long replay = NUM_STEPS - warmup;
+
+	for(unsigned long k = 0; k < warmup; k++) flat.step(k, stimulus);
+
+	std::vector<unsigned char> snapshot(1 << 16);
+	const std::size_t size = save_state(get_state(), snapshot.data(), snapshot.size());
+
+	std::vector<double> first;
+	for(unsigned long k = warmup; k < NUM_STEPS; k++)
+	{
+		const std::vector<double>& x = flat.step(k, stimulus);
+		first.insert(first.end(), x.begin(), x.end());
+	}
+
+	const bool restored = size != 0 && restore_state(get_state(), snapshot.data(), size);
+
+	std::vector<double> second;
+	for(unsigned long k = warmup; k < NUM_STEPS; k++)
+	{
+		const std::vector<double>& x = flat.step(k, stimulus);
+		second.insert(second.end(), x.begin(), x.end());
+	}
+
+	std::vector<unsigned char> corrupted(snapshot.begin(), snapshot.begin()+size);
+	if(!corrupted.empty()) corrupted[8] ^= 1;
+	const bool rejected = !restore_state(get_state(), corrupted.data(), corrupted.size());
+
+	const bool passed = restored && first == second && rejected;
+
+	char detail[120];
+	std::snprintf(detail, sizeof(detail), "%zu byte snapshot, %lu steps %s, corrupted snapshot %s", size, replay, first == second ? "repeated" : "differ", rejected ? "rejected" : "accepted");
+	report("checkpoint round trip", passed, detail);
+
+	// the round trip must not have disturbed what the engine computes from a fresh load
+	parameters.instrumentation_enable = true;
+	model.getSolverCodeGenerator().setParameters(parameters);
+	EngineLibrary fresh = model.compileAndLoad();
+	reportComparison("checkpointed, instrumented", interpreter.compareWithEngine(fresh, NUM_STEPS, stimulus, 1.0e-9));
+}
+
+/**
+	\brief checks that an engine initialized at the DC operating point stays there under the
+	operating point's inputs, in the interpreter and in the engine
+**/
+void checkOperatingPoint()
+{
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	InterpreterSignals inputs;
+	constantStimulus(0, inputs);
+	const std::vector<double> x0 = model.initializeOperatingPoint(inputs);
+
+	ReferenceInterpreter interpreter(model);
+	double max_deviation = 0.0;
+
+	for(unsigned long k = 0; k < NUM_STEPS; k++)
+	{
+		constantStimulus(k, interpreter.getInputs());
+		interpreter.step();
+
+		for(unsigned int i = 0; i < NUM_SOLUTIONS; i++)
+			accumulateError(max_deviation, interpreter.getSolutions()[i], x0[i+1]);
+	}
+
+	char detail[80];
+	std::snprintf(detail, sizeof(detail), "max deviation %.3e over %lu steps", max_deviation, NUM_STEPS);
+	report("DC operating point", max_deviation <= 1.0e-9, detail);
+
+	EngineLibrary engine = model.compileAndLoad();
+	reportComparison("DC operating point engine", interpreter.compareWithEngine(engine, NUM_STEPS, constantStimulus, 1.0e-9));
+}
+
+/**
+	\brief compares a multi-rate engine against the interpreter, and checks independently of both
+	that the slow inductor is updated on its phase and every rate steps after
+**/
+void checkMultiRate()
+{
+	const unsigned int rate = 4;
+
+	SystemModel model("rlc", NUM_SOLUTIONS);
+	buildReferenceModel(model, rate);
+
+	SimulationEngineGeneratorParameters parameters = model.getSolverCodeGenerator().getParameters();
+	parameters.jit_cache_directory = work_directory + "/jit";
+	model.getSolverCodeGenerator().setParameters(parameters);
+
+	ReferenceInterpreter interpreter(model);
+	reportComparison("multi-rate", interpreter.compareWithEngine(model.compileAndLoad(), NUM_STEPS, stimulus, 1.0e-9));
+
+	// the phases are listed per update body, and components without one have none
+	const std::vector<unsigned int> phases = model.getSolverCodeGenerator().planUpdatePhases();
+	unsigned int body = 0;
+	unsigned int phase = 0;
+
+	for(unsigned int i = 0; i < model.getNumberOfComponents(); i++)
+	{
+		Component* component = model.getComponent(model.getComponentAt(i)->getName());
+
+		if(component->generateUpdateBody().empty()) continue;
+		if(component->getName() == "l1") phase = phases.at(body);
+		body++;
+	}
+
+	// the inductor current, the only output, changes only when the inductor is updated; the
+	// update of step 0 sees the zero initial solutions, so it leaves the current unchanged
+	EngineLibrary engine = model.compileAndLoad();
+	FlatEngine flat(engine, "rlc");
+	double previous = 0.0;
+
+	std::string expected;
+	std::string updated;
+
+	for(unsigned long k = 0; k < 6*rate; k++)
+	{
+		flat.step(k, constantStimulus);
+		const double l_current = flat.getOutputs().at(0);
+
+		if(l_current != previous) updated += " " + std::to_string(k);
+		if(k > 0 && k >= phase && (k - phase) % rate == 0) expected += " " + std::to_string(k);
+
+		previous = l_current;
+	}
+
+	report("multi-rate schedule", updated == expected, "l1 (rate " + std::to_string(rate) + ", phase " + std::to_string(phase) + ") updated on steps" + updated + (updated == expected ? "" : ", expected" + expected));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	if(argc > 1)
+	{
+		work_directory = argv[1];
+	}
+	else
+	{
+		const char* tmpdir = std::getenv("TMPDIR");
+		work_directory = std::string(tmpdir && *tmpdir ? tmpdir : "/tmp") + "/lblmc_check";
+	}
+
+	try
+	{
+		checkMode("default", [](SimulationEngineGeneratorParameters&) {});
+		checkMode("source slot reorder", [](SimulationEngineGeneratorParameters& p) { p.source_slot_reorder_enable = true; });
+		checkMode("conductance rescale", [](SimulationEngineGeneratorParameters& p) { p.inv_conduct_matrix_rescale_enable = true; });
+		checkMode("reentrant", [](SimulationEngineGeneratorParameters& p) { p.reentrant_engine_enable = true; });
+		checkMode("batched", [](SimulationEngineGeneratorParameters& p) { p.batch_lanes = 4; });
+		checkMode("batched, reentrant", [](SimulationEngineGeneratorParameters& p) { p.batch_lanes = 4; p.reentrant_engine_enable = true; });
+		checkMode("runtime parameters", [](SimulationEngineGeneratorParameters& p) { p.runtime_parameters_enable = true; });
+		checkMode("struct I/O ABI", [](SimulationEngineGeneratorParameters& p) { p.io_struct_abi_enable = true; });
+		checkMode("struct I/O ABI, in place", [](SimulationEngineGeneratorParameters& p) { p.io_struct_abi_enable = true; p.io_struct_solutions_in_place = true; });
+		checkMode("folded solver", [](SimulationEngineGeneratorParameters& p) { p.xilinx_hls_solver_lanes = 2; });
+		checkMode("folded solver, HLS directives", [](SimulationEngineGeneratorParameters& p) { p.xilinx_hls_solver_lanes = 2; p.xilinx_hls_enable = true; p.xilinx_hls_directives_enable = true; p.reentrant_engine_enable = true; });
+		checkMode("checkpointed, reentrant", [](SimulationEngineGeneratorParameters& p) { p.checkpoint_enable = true; p.reentrant_engine_enable = true; });
+		checkMode("fixed point", [](SimulationEngineGeneratorParameters& p) { p.fixed_point_enable = true; }, 1.0e-2);
+		checkMode("fixed point 48/24, rescaled", [](SimulationEngineGeneratorParameters& p) { p.fixed_point_enable = true; p.fixed_point_word_width = 48; p.fixed_point_int_width = 24; p.inv_conduct_matrix_rescale_enable = true; }, 1.0e-2);
+		checkMode("fixed point 56/32, rescaled", [](SimulationEngineGeneratorParameters& p) { p.fixed_point_enable = true; p.fixed_point_word_width = 56; p.fixed_point_int_width = 32; p.inv_conduct_matrix_rescale_enable = true; }, 1.0e-2);
+		checkMode("folded, fixed point 56/32, rescaled", [](SimulationEngineGeneratorParameters& p) { p.xilinx_hls_solver_lanes = 2; p.fixed_point_enable = true; p.fixed_point_word_width = 56; p.fixed_point_int_width = 32; p.inv_conduct_matrix_rescale_enable = true; }, 1.0e-2);
+		checkMode("batched, fixed point 56/32, rescaled", [](SimulationEngineGeneratorParameters& p) { p.batch_lanes = 2; p.fixed_point_enable = true; p.fixed_point_word_width = 56; p.fixed_point_int_width = 32; p.inv_conduct_matrix_rescale_enable = true; }, 1.0e-2);
+		checkMultiStep();
+		checkMultiUnit();
+		checkThreadPinning();
+		checkReentrantTiming();
+		checkCachedRegeneration();
+		checkHLSBinding();
+		checkParameterSweep();
+		checkInstances();
+		checkCheckpoint();
+		checkOperatingPoint();
+		checkMultiRate();
+	}
+	catch(const std::exception& e)
+	{
+		std::printf("FAIL %s\n", e.what());
+		return 1;
+	}
+
+	std::printf("%u check%s failed\n", num_failed, num_failed == 1 ? "" : "s");
+
+	return num_failed == 0 ? 0 : 1;
+}